@@ -45,7 +45,7 @@ TEMPLATE = app
 TARGET = eqonomize
 INCLUDEPATH += src
 CONFIG += qt
-QT += widgets network printsupport
+QT += widgets network printsupport concurrent
 !equals(DISABLE_QTCHARTS,"yes"):!equals(ENABLE_QTCHARTS,"no") {
 	qtHaveModule(charts) {
 		QT += charts
@@ -70,6 +70,8 @@ HEADERS += src/account.h \
            src/budget.h \
            src/categoriescomparisonchart.h \
            src/categoriescomparisonreport.h \
+           src/completionindex.h \
+           src/completionmodel.h \
            #src/currencies.xml.h \
            src/currency.h \
            src/currencyconversiondialog.h \
@@ -85,19 +87,24 @@ HEADERS += src/account.h \
            src/ledgerdialog.h \
            src/overtimechart.h \
            src/overtimereport.h \
+           src/portfolio.h \
            src/qifimportexport.h \
            src/recurrence.h \
            src/recurrenceeditwidget.h \
            src/security.h \
            src/transaction.h \
            src/transactioneditwidget.h \
+           src/transactionfilter.h \
            src/transactionfilterwidget.h \
-           src/transactionlistwidget.h
+           src/transactionlistwidget.h \
+           src/transactiontextindex.h
 SOURCES += src/account.cpp \
            src/accountcombobox.cpp \
            src/budget.cpp \
            src/categoriescomparisonchart.cpp \
            src/categoriescomparisonreport.cpp \
+           src/completionindex.cpp \
+           src/completionmodel.cpp \
            src/currency.cpp \
            src/currencyconversiondialog.cpp \
            src/editaccountdialogs.cpp \
@@ -112,14 +119,17 @@ SOURCES += src/account.cpp \
            src/main.cpp \
            src/overtimechart.cpp \
            src/overtimereport.cpp \
+           src/portfolio.cpp \
            src/qifimportexport.cpp \
            src/recurrence.cpp \
            src/recurrenceeditwidget.cpp \
            src/security.cpp \
            src/transaction.cpp \
            src/transactioneditwidget.cpp \
+           src/transactionfilter.cpp \
            src/transactionfilterwidget.cpp \
-           src/transactionlistwidget.cpp
+           src/transactionlistwidget.cpp \
+           src/transactiontextindex.cpp
 
 unix:!equals(COMPILE_RESOURCES,"yes"):!android:!macx {
 	TRANSLATIONS = 	translations/eqonomize_bg.ts \
@@ -29,15 +29,17 @@
 #include "account.h"
 #include "budget.h"
 
-Account::Account(Budget *parent_budget, QString initial_name, QString initial_description) : o_budget(parent_budget), i_id(parent_budget->getNewId()), i_first_revision(parent_budget->revision()), i_last_revision(parent_budget->revision()), s_name(initial_name.trimmed()), s_description(initial_description.trimmed()) {}
-Account::Account(Budget *parent_budget, QXmlStreamReader *xml, bool *valid) : o_budget(parent_budget) {
+#include <algorithm>
+
+Account::Account(Budget *parent_budget, QString initial_name, QString initial_description) : o_budget(parent_budget), i_id(parent_budget->getNewId()), i_ordinal(parent_budget->newAccountOrdinal()), i_first_revision(parent_budget->revision()), i_last_revision(parent_budget->revision()), s_name(initial_name.trimmed()), s_description(initial_description.trimmed()) {}
+Account::Account(Budget *parent_budget, QXmlStreamReader *xml, bool *valid) : o_budget(parent_budget), i_ordinal(parent_budget->newAccountOrdinal()) {
 	QXmlStreamAttributes attr = xml->attributes();
 	readAttributes(&attr, valid);
 	readElements(xml, valid);
 }
-Account::Account(Budget *parent_budget) : o_budget(parent_budget), i_first_revision(parent_budget->revision()), i_last_revision(parent_budget->revision()) {}
-Account::Account() : o_budget(NULL), i_id(0), i_first_revision(1), i_last_revision(1) {}
-Account::Account(const Account *account) : o_budget(account->budget()), i_id(account->id()), i_first_revision(account->firstRevision()), i_last_revision(account->lastRevision()), s_name(account->name()), s_description(account->description()) {}
+Account::Account(Budget *parent_budget) : o_budget(parent_budget), i_ordinal(parent_budget->newAccountOrdinal()), i_first_revision(parent_budget->revision()), i_last_revision(parent_budget->revision()) {}
+Account::Account() : o_budget(NULL), i_id(0), i_ordinal(-1), i_first_revision(1), i_last_revision(1) {}
+Account::Account(const Account *account) : o_budget(account->budget()), i_id(account->id()), i_ordinal(account->ordinal()), i_first_revision(account->firstRevision()), i_last_revision(account->lastRevision()), s_name(account->name()), s_description(account->description()) {}
 Account::~Account() {}
 
 void Account::set(const Account *account) {
@@ -81,6 +83,7 @@ bool Account::isClosed() const {return false;}
 Budget *Account::budget() const {return o_budget;}
 qlonglong Account::id() const {return i_id;}
 void Account::setId(qlonglong new_id) {i_id = new_id;}
+int Account::ordinal() const {return i_ordinal;}
 int Account::firstRevision() const {return i_first_revision;}
 void Account::setFirstRevision(int new_rev) {i_first_revision = new_rev; if(i_first_revision > i_last_revision) i_last_revision = i_first_revision;}
 int Account::lastRevision() const {return i_last_revision;}
@@ -254,15 +257,15 @@ bool account_list_less_than(Account *t1, Account *t2) {
 	return QString::localeAwareCompare(t1->name(), t2->name()) < 0;
 }
 
-CategoryAccount::CategoryAccount(Budget *parent_budget, QString initial_name, QString initial_description) : Account(parent_budget, initial_name, initial_description), o_parent(NULL) {}
-CategoryAccount::CategoryAccount(Budget *parent_budget, QXmlStreamReader *xml, bool *valid) : Account(parent_budget), o_parent(NULL) {
+CategoryAccount::CategoryAccount(Budget *parent_budget, QString initial_name, QString initial_description) : Account(parent_budget, initial_name, initial_description), o_parent(NULL), b_budget_series_valid(false) {}
+CategoryAccount::CategoryAccount(Budget *parent_budget, QXmlStreamReader *xml, bool *valid) : Account(parent_budget), o_parent(NULL), b_budget_series_valid(false) {
 	QXmlStreamAttributes attr = xml->attributes();
 	readAttributes(&attr, valid);
 	readElements(xml, valid);
 }
-CategoryAccount::CategoryAccount(Budget *parent_budget) : Account(parent_budget), o_parent(NULL) {}
-CategoryAccount::CategoryAccount() : Account(), o_parent(NULL) {}
-CategoryAccount::CategoryAccount(const CategoryAccount *account) : Account(account), o_parent(NULL) {}
+CategoryAccount::CategoryAccount(Budget *parent_budget) : Account(parent_budget), o_parent(NULL), b_budget_series_valid(false) {}
+CategoryAccount::CategoryAccount() : Account(), o_parent(NULL), b_budget_series_valid(false) {}
+CategoryAccount::CategoryAccount(const CategoryAccount *account) : Account(account), o_parent(NULL), b_budget_series_valid(false) {}
 CategoryAccount::~CategoryAccount() {
 	if(o_parent) o_parent->removeSubCategory(this, false);
 	for(AccountList<CategoryAccount*>::const_iterator it = subCategories.constBegin(); it != subCategories.constEnd(); ++it) {
@@ -278,17 +281,20 @@ void CategoryAccount::set(const CategoryAccount *account) {
 	setParentCategory(account->parentCategory());
 	mbudgets = account->mbudgets;
 	subCategories = account->subCategories;
+	budgetsModified();
 }
 void CategoryAccount::setMergeBudgets(const CategoryAccount *account) {
 	Account::set(account);
 	setParentCategory(account->parentCategory());
 	mergeBudgets(account, false);
 	subCategories = account->subCategories;
+	budgetsModified();
 }
 void CategoryAccount::mergeBudgets(const CategoryAccount *account, bool keep) {
 	for(QMap<QDate, double>::const_iterator it = account->mbudgets.begin(); it != account->mbudgets.end(); ++it) {
 		if(!keep || !mbudgets.contains(it.key())) mbudgets[it.key()] = it.value();
 	}
+	budgetsModified();
 }
 void CategoryAccount::readAttributes(QXmlStreamAttributes *attr, bool *valid) {
 	Account::readAttributes(attr, valid);
@@ -298,6 +304,7 @@ void CategoryAccount::readAttributes(QXmlStreamAttributes *attr, bool *valid) {
 			QDate date = QDate::currentDate();
 			date.setDate(date.year(), date.month(), 1);
 			mbudgets[date] = d_mbudget;
+			budgetsModified();
 		}
 	}
 }
@@ -306,6 +313,7 @@ bool CategoryAccount::readElement(QXmlStreamReader *xml, bool *valid) {
 		QXmlStreamAttributes attr = xml->attributes();
 		QDate date = QDate::fromString(attr.value("date").toString(), Qt::ISODate);
 		mbudgets[date] = attr.value("value").toDouble();
+		budgetsModified();
 		return false;
 	} else if(xml->name() == "category") {
 		QStringRef ctype = xml->attributes().value("type");
@@ -370,20 +378,100 @@ void CategoryAccount::setMonthlyBudget(int year, int month, double new_monthly_b
 }
 double CategoryAccount::monthlyBudget(const QDate &date, bool no_default) const {
 	if(mbudgets.isEmpty()) return -1.0;
-	QMap<QDate, double>::const_iterator it = mbudgets.find(date);
-	if(it != mbudgets.end()) {
-		return it.value();
+	if(no_default) return mbudgets.value(date, -1.0);
+	int index = budgetSeriesIndex(date);
+	if(index < 0) return -1.0;
+	return v_budgets[index];
+}
+QDate CategoryAccount::firstMonthlyBudget() const {
+	if(!b_budget_series_valid) updateBudgetSeries();
+	return d_first_budget;
+}
+double CategoryAccount::subCategoriesMonthlyBudget(const QDate &date) const {
+	int index = budgetSeriesIndex(date);
+	if(index < 0) return -1.0;
+	return v_subs_budgets[index];
+}
+double CategoryAccount::totalMonthlyBudget(const QDate &date) const {
+	int index = budgetSeriesIndex(date);
+	if(index < 0) return -1.0;
+	if(v_budgets[index] >= 0.0) return v_budgets[index];
+	return v_subs_budgets[index];
+}
+double CategoryAccount::totalMonthlyBudget(const QDate &first_month, const QDate &last_month) const {
+	if(last_month < first_month) return 0.0;
+	int index1 = budgetSeriesIndex(first_month);
+	int index2 = budgetSeriesIndex(last_month);
+	if(index2 < 0) return 0.0;
+	double d = v_budget_sums[index2];
+	double m = v_budgets[index2] >= 0.0 ? v_budgets[index2] : v_subs_budgets[index2];
+	if(m > 0.0) d += m * (1 + (last_month.year() - v_budget_months[index2].year()) * 12 + last_month.month() - v_budget_months[index2].month());
+	if(index1 >= 0) {
+		d -= v_budget_sums[index1];
+		m = v_budgets[index1] >= 0.0 ? v_budgets[index1] : v_subs_budgets[index1];
+		if(m > 0.0) d -= m * ((first_month.year() - v_budget_months[index1].year()) * 12 + first_month.month() - v_budget_months[index1].month());
+	}
+	return d;
+}
+void CategoryAccount::budgetsModified() {
+	b_budget_series_valid = false;
+	if(o_parent) o_parent->b_budget_series_valid = false;
+}
+int CategoryAccount::budgetSeriesIndex(const QDate &date) const {
+	if(!b_budget_series_valid) updateBudgetSeries();
+	return (std::upper_bound(v_budget_months.constBegin(), v_budget_months.constEnd(), date) - v_budget_months.constBegin()) - 1;
+}
+void CategoryAccount::updateBudgetSeries() const {
+	v_budget_months.clear();
+	v_budgets.clear();
+	v_subs_budgets.clear();
+	v_budget_sums.clear();
+	d_first_budget = QDate();
+	for(QMap<QDate, double>::const_iterator it = mbudgets.constBegin(); it != mbudgets.constEnd(); ++it) {
+		v_budget_months << it.key();
+		if(d_first_budget.isNull() && it.value() >= 0.0) d_first_budget = it.key();
+	}
+	for(AccountList<CategoryAccount*>::const_iterator it = subCategories.constBegin(); it != subCategories.constEnd(); ++it) {
+		for(QMap<QDate, double>::const_iterator it2 = (*it)->mbudgets.constBegin(); it2 != (*it)->mbudgets.constEnd(); ++it2) {
+			v_budget_months << it2.key();
+		}
+	}
+	std::sort(v_budget_months.begin(), v_budget_months.end());
+	v_budget_months.erase(std::unique(v_budget_months.begin(), v_budget_months.end()), v_budget_months.end());
+	int n = v_budget_months.count();
+	v_budgets.fill(-1.0, n);
+	v_subs_budgets.fill(-1.0, n);
+	v_budget_sums.fill(0.0, n);
+	QMap<QDate, double>::const_iterator it = mbudgets.constBegin();
+	double m = -1.0;
+	for(int i = 0; i < n; i++) {
+		if(it != mbudgets.constEnd() && it.key() == v_budget_months[i]) {
+			m = it.value();
+			++it;
+		}
+		v_budgets[i] = m;
+	}
+	for(AccountList<CategoryAccount*>::const_iterator it = subCategories.constBegin(); it != subCategories.constEnd(); ++it) {
+		const QMap<QDate, double> &sub_budgets = (*it)->mbudgets;
+		QMap<QDate, double>::const_iterator it2 = sub_budgets.constBegin();
+		m = -1.0;
+		for(int i = 0; i < n; i++) {
+			if(it2 != sub_budgets.constEnd() && it2.key() == v_budget_months[i]) {
+				m = it2.value();
+				++it2;
+			}
+			if(m >= 0.0) {
+				if(v_subs_budgets[i] < 0.0) v_subs_budgets[i] = m;
+				else v_subs_budgets[i] += m;
+			}
+		}
 	}
-	if(no_default) return -1.0;	
-	it = mbudgets.begin();
-	if(it.key() > date) return -1.0;
-	QMap<QDate, double>::const_iterator it_e = mbudgets.end();
-	--it_e;
-	while(it_e != it) {
-		if(date > it_e.key()) return it_e.value();
-		--it_e;
+	for(int i = 1; i < n; i++) {
+		m = v_budgets[i - 1] >= 0.0 ? v_budgets[i - 1] : v_subs_budgets[i - 1];
+		v_budget_sums[i] = v_budget_sums[i - 1];
+		if(m > 0.0) v_budget_sums[i] += m * ((v_budget_months[i].year() - v_budget_months[i - 1].year()) * 12 + v_budget_months[i].month() - v_budget_months[i - 1].month());
 	}
-	return it.value();
+	b_budget_series_valid = true;
 }
 QString CategoryAccount::nameWithParent(bool formatted) const{
 	if(o_parent) {
@@ -398,15 +486,20 @@ Account *CategoryAccount::topAccount() {
 }
 void CategoryAccount::setMonthlyBudget(const QDate &date, double new_monthly_budget) {
 	mbudgets[date] = new_monthly_budget;
+	budgetsModified();
 }
 bool CategoryAccount::removeSubCategory(CategoryAccount *sub_account, bool set_parent) {
 	if(set_parent) return sub_account->setParentCategory(NULL);
+	b_budget_series_valid = false;
+	if(budget()) budget()->categoriesModified();
 	return subCategories.removeAll(sub_account) > 0;
 }
 bool CategoryAccount::addSubCategory(CategoryAccount *sub_account, bool set_parent) {
 	if(o_parent) return false;
 	if(set_parent) return sub_account->setParentCategory(this);
 	subCategories.inSort(sub_account);
+	b_budget_series_valid = false;
+	if(budget()) budget()->categoriesModified();
 	return true;
 }
 CategoryAccount *CategoryAccount::parentCategory() const {
@@ -457,3 +550,82 @@ ExpensesAccount::~ExpensesAccount() {}
 
 AccountType ExpensesAccount::type() const {return ACCOUNT_TYPE_EXPENSES;}
 
+AccountMonthMap::AccountMonthMap() : i_first_month(0), i_months(0), i_accounts(0), i_sums_months(0) {}
+void AccountMonthMap::resize(int first_month, int months, int accounts) {
+	if(first_month == i_first_month && accounts == i_accounts) {
+		v_values.resize(months * accounts);
+		i_months = months;
+		if(i_sums_months > months) i_sums_months = months;
+		return;
+	}
+	i_sums_months = 0;
+	QVector<double> values(months * accounts, 0.0);
+	for(int m = 0; m < i_months; m++) {
+		for(int a = 0; a < i_accounts; a++) {
+			values[(m + i_first_month - first_month) * accounts + a] = v_values[m * i_accounts + a];
+		}
+	}
+	v_values = values;
+	i_first_month = first_month;
+	i_months = months;
+	i_accounts = accounts;
+}
+double &AccountMonthMap::operator()(int row, const QDate &monthdate) {
+	Q_ASSERT(row >= 0);
+	//each budget month ends in a different calendar month
+	int month = monthdate.year() * 12 + monthdate.month() - 1;
+	if(i_months == 0) {
+		i_first_month = month;
+		i_accounts = row + 1;
+		resize(month, 1, i_accounts);
+	} else if(month < i_first_month || month >= i_first_month + i_months || row >= i_accounts) {
+		int first_month = month < i_first_month ? month : i_first_month;
+		int months = (month >= i_first_month + i_months ? month + 1 : i_first_month + i_months) - first_month;
+		int accounts = i_accounts;
+		if(row >= accounts) {
+			accounts *= 2;
+			if(row >= accounts) accounts = row + 1;
+		}
+		resize(first_month, months, accounts);
+	}
+	if(month - i_first_month < i_sums_months) i_sums_months = month - i_first_month;
+	return v_values[(month - i_first_month) * i_accounts + row];
+}
+double &AccountMonthMap::operator()(const Account *account, const QDate &monthdate) {
+	return operator()(account->ordinal(), monthdate);
+}
+double AccountMonthMap::value(int row, const QDate &monthdate) const {
+	int month = monthdate.year() * 12 + monthdate.month() - 1;
+	if(row < 0 || row >= i_accounts || month < i_first_month || month >= i_first_month + i_months) return 0.0;
+	return v_values[(month - i_first_month) * i_accounts + row];
+}
+double AccountMonthMap::value(const Account *account, const QDate &monthdate) const {
+	return value(account->ordinal(), monthdate);
+}
+QVector<double> AccountMonthMap::sumBefore(const QDate &monthdate) const {
+	int months = monthdate.year() * 12 + monthdate.month() - 1 - i_first_month;
+	if(months > i_months) months = i_months;
+	if(months <= 0) return QVector<double>(i_accounts, 0.0);
+	if(i_sums_months < months) {
+		//extend the running totals from the last month that has not been modified since they were calculated
+		v_sums.resize((i_months + 1) * i_accounts);
+		if(i_sums_months == 0) {
+			for(int a = 0; a < i_accounts; a++) v_sums[a] = 0.0;
+		}
+		for(int m = i_sums_months; m < months; m++) {
+			for(int a = 0; a < i_accounts; a++) {
+				v_sums[(m + 1) * i_accounts + a] = v_sums[m * i_accounts + a] + v_values[m * i_accounts + a];
+			}
+		}
+		i_sums_months = months;
+	}
+	return v_sums.mid(months * i_accounts, i_accounts);
+}
+void AccountMonthMap::clear() {
+	v_values.clear();
+	v_sums.clear();
+	i_sums_months = 0;
+	i_first_month = 0;
+	i_months = 0;
+	i_accounts = 0;
+}
@@ -24,6 +24,7 @@
 #include <QDateTime>
 #include <QMap>
 #include <QString>
+#include <QVector>
 
 #include "eqonomizelist.h"
 
@@ -57,6 +58,7 @@ class Account {
 
 		Budget *o_budget;
 		qlonglong i_id;
+		int i_ordinal;
 		int i_first_revision, i_last_revision;
 		QString s_name, s_description;
 
@@ -87,6 +89,8 @@ class Account {
 		Budget *budget() const;
 		qlonglong id() const;
 		void setId(qlonglong new_id);
+		//dense index of the account, unique within the budget and restarted when the budget is cleared (-1 if the account has no budget); copies share the index of the original
+		int ordinal() const;
 		int firstRevision() const;
 		void setFirstRevision(int new_rev);
 		int lastRevision() const;
@@ -156,6 +160,49 @@ template<class type> class AccountList : public EqonomizeList<type> {
 		}
 };
 
+template<class T> class AccountMap {
+	protected:
+		QVector<T> v_values;
+	public:
+		AccountMap() {};
+		T &operator[](const Account *account) {
+			Q_ASSERT(account->ordinal() >= 0);
+			if(account->ordinal() >= v_values.size()) v_values.resize(account->ordinal() + 1);
+			return v_values[account->ordinal()];
+		}
+		T value(const Account *account) const {
+			if(account->ordinal() < 0 || account->ordinal() >= v_values.size()) return T();
+			return v_values[account->ordinal()];
+		}
+		void remove(const Account *account) {
+			if(account->ordinal() >= 0 && account->ordinal() < v_values.size()) v_values[account->ordinal()] = T();
+		}
+		void clear() {
+			v_values.clear();
+		}
+};
+
+//per account and budget month values, stored month by month in one flat vector and keyed by the last day of the budget month
+class AccountMonthMap {
+	protected:
+		int i_first_month, i_months, i_accounts;
+		QVector<double> v_values;
+		//sum of each row over the months before each month, up to date for the first i_sums_months + 1 months
+		mutable QVector<double> v_sums;
+		mutable int i_sums_months;
+		void resize(int first_month, int months, int accounts);
+	public:
+		AccountMonthMap();
+		double &operator()(int row, const QDate &monthdate);
+		double &operator()(const Account *account, const QDate &monthdate);
+		//returns zero for months and rows that have not been set, without growing the map
+		double value(int row, const QDate &monthdate) const;
+		double value(const Account *account, const QDate &monthdate) const;
+		//sum of each row over all months before the month of monthdate
+		QVector<double> sumBefore(const QDate &monthdate) const;
+		void clear();
+};
+
 class CategoryAccount : public Account {
 
 	public:
@@ -171,6 +218,7 @@ class CategoryAccount : public Account {
 		void setMergeBudgets(const CategoryAccount *account);
 		void mergeBudgets(const CategoryAccount *account, bool keep = true);
 
+		//call budgetsModified() after changing mbudgets directly
 		QMap<QDate, double> mbudgets;
 
 		virtual void readAttributes(QXmlStreamAttributes *attr, bool *valid);
@@ -182,6 +230,15 @@ class CategoryAccount : public Account {
 		void setMonthlyBudget(int year, int month, double new_monthly_budget);
 		double monthlyBudget(const QDate &date, bool no_default = false) const;
 		void setMonthlyBudget(const QDate &date, double new_monthly_budget);
+		//first month with a non-negative budget, or a null date
+		QDate firstMonthlyBudget() const;
+		//sum of the non-negative budgets of subcategories, -1 if none has a budget
+		double subCategoriesMonthlyBudget(const QDate &date) const;
+		//own budget, or the sum of the subcategory budgets if not set
+		double totalMonthlyBudget(const QDate &date) const;
+		//sum of totalMonthlyBudget() from first_month to last_month (inclusive)
+		double totalMonthlyBudget(const QDate &first_month, const QDate &last_month) const;
+		void budgetsModified();
 		QString nameWithParent(bool formatted = true) const;
 		virtual Account *topAccount();
 		virtual AccountType type() const = 0;
@@ -194,6 +251,16 @@ class CategoryAccount : public Account {
 		AccountList<CategoryAccount*> subCategories;
 		CategoryAccount *o_parent;
 
+	protected:
+
+		//months where the own or a subcategory budget changes, with the budgets carried forward to each month and running totals of totalMonthlyBudget() at the start of each month
+		mutable QVector<QDate> v_budget_months;
+		mutable QVector<double> v_budgets, v_subs_budgets, v_budget_sums;
+		mutable QDate d_first_budget;
+		mutable bool b_budget_series_valid;
+		void updateBudgetSeries() const;
+		int budgetSeriesIndex(const QDate &date) const;
+
 };
 
 class IncomesAccount : public CategoryAccount {
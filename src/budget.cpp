@@ -40,6 +40,7 @@
 #include <QProcess>
 #include <QTemporaryFile>
 #include <math.h>
+#include <algorithm>
 
 #include <QDebug>
 
@@ -195,6 +196,7 @@ Budget::Budget() {
 	loadCurrencies();
 	default_currency = currency_euro;
 	last_id = 0;
+	i_account_ordinals = 0;
 	balancingAccount = new AssetsAccount(this, ASSETS_TYPE_BALANCING, tr("Balancing", "Name of account for transactions that adjust account balances"), 0.0);
 	balancingAccount->setCurrency(NULL);
 	balancingAccount->setId(0);
@@ -205,6 +207,11 @@ Budget::Budget() {
 	i_quotation_decimals = 4;
 	i_budget_day = 1;
 	i_budget_month = 1;
+	i_calendar_first_jd = 0;
+	updateBudgetCalendar();
+	b_categories_valid = false;
+	b_text_index_valid = false;
+	b_completion_index_valid = false;
 	i_revision = 1;
 	i_opened_revision = 0;
 	last_id = 0;
@@ -282,14 +289,20 @@ qlonglong Budget::getNewId() {
 	last_id++;
 	return last_id;
 }
+int Budget::newAccountOrdinal() {
+	return i_account_ordinals++;
+}
 int Budget::revision() {return i_revision;}
 
 void Budget::clear() {
 	i_revision = 1;
 	i_opened_revision = 0;
 	last_id = 0;
+	//the balancing account is kept
+	i_account_ordinals = balancingAccount->ordinal() + 1;
 	transactions.clear();
 	scheduledTransactions.clear();
+	schedule_occurrences.clear();
 	splitTransactions.clear();
 	securities.clear();
 	expenses.clear();
@@ -315,6 +328,9 @@ void Budget::clear() {
 	}
 	incomesAccounts.clear();
 	expensesAccounts.clear();
+	categoriesModified();
+	resetTextIndex();
+	resetCompletionIndex();
 	assetsAccounts.clear();
 	tags.clear();
 	assetsAccounts.append(balancingAccount);
@@ -1395,12 +1411,15 @@ QString Budget::loadFile(QString filename, QString &errors, bool *default_curren
 		security->scheduledReinvestedDividends.sort();
 		security->reinvestedDividends.sort();
 		security->tradedShares.sort();
+		security->transactionsModified();
 	}
 	transactions.sort();
 	scheduledTransactions.sort();
 	splitTransactions.sort();
 	expensesAccounts.sort();
 	incomesAccounts.sort();
+	//categories are appended directly to the lists above
+	categoriesModified();
 	assetsAccounts.sort();
 	accounts.sort();
 	securities.sort();
@@ -1425,6 +1444,9 @@ QString Budget::loadFile(QString filename, QString &errors, bool *default_curren
 	}
 	file.close();
 
+	updateBudgetCalendar();
+	resetTextIndex();
+	resetCompletionIndex();
 	resetDefaultCurrencyChanged();
 	return QString();
 }
@@ -2154,12 +2176,15 @@ QString Budget::syncFile(QString filename, QString &errors, int synced_revision)
 		security->scheduledReinvestedDividends.sort();
 		security->reinvestedDividends.sort();
 		security->tradedShares.sort();
+		security->transactionsModified();
 	}
 	transactions.sort();
 	scheduledTransactions.sort();
 	splitTransactions.sort();
 	expensesAccounts.sort();
 	incomesAccounts.sort();
+	//categories are appended directly to the lists above
+	categoriesModified();
 	assetsAccounts.sort();
 	accounts.sort();
 	securities.sort();
@@ -2181,6 +2206,8 @@ QString Budget::syncFile(QString filename, QString &errors, int synced_revision)
 		errors += tr("Unable to load %n transaction(s).", "", transaction_errors);
 	}
 	file.close();
+	resetTextIndex();
+	resetCompletionIndex();
 	return QString();
 }
 
@@ -2378,6 +2405,7 @@ void Budget::addTransaction(Transaction *trans) {
 			if(((Income*) trans)->security()) {
 				if(trans->subtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND) ((Income*) trans)->security()->reinvestedDividends.inSort((ReinvestedDividend*) trans);
 				else ((Income*) trans)->security()->dividends.inSort((Income*) trans);
+				((Income*) trans)->security()->transactionsModified();
 			}
 			break;
 		}
@@ -2387,17 +2415,22 @@ void Budget::addTransaction(Transaction *trans) {
 			SecurityTransaction *sectrans = (SecurityTransaction*) trans;
 			securityTransactions.inSort(sectrans);
 			sectrans->security()->transactions.inSort(sectrans);
+			sectrans->security()->transactionsModified();
 			//if(sectrans->shareValue() > 0.0) sectrans->security()->setQuotation(sectrans->date(), sectrans->shareValue(), true);
 			break;
 		}
 	}
 	transactions.inSort(trans);
+	if(b_text_index_valid) text_index.updateTransaction(trans);
+	if(b_completion_index_valid) completion_index.updateTransaction(trans);
 }
 void Budget::removeTransaction(Transaction *trans, bool keep) {
 	if(trans->parentSplit()) {
 		trans->parentSplit()->removeTransaction(trans, keep);
 		return;
 	}
+	if(b_text_index_valid) text_index.removeTransaction(trans);
+	if(b_completion_index_valid) completion_index.removeTransaction(trans);
 	transactions.removeRef(trans);
 	switch(trans->type()) {
 		case TRANSACTION_TYPE_EXPENSE: {
@@ -2412,6 +2445,7 @@ void Budget::removeTransaction(Transaction *trans, bool keep) {
 			if(((Income*) trans)->security()) {
 				if(trans->subtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND) ((Income*) trans)->security()->reinvestedDividends.removeRef((ReinvestedDividend*) trans);
 				else ((Income*) trans)->security()->dividends.removeRef((Income*) trans);
+				((Income*) trans)->security()->transactionsModified();
 			}
 			incomes.removeRef((Income*) trans);
 			incomes.setAutoDelete(true);
@@ -2431,6 +2465,7 @@ void Budget::removeTransaction(Transaction *trans, bool keep) {
 			sectrans->security()->removeQuotation(sectrans->date(), true);
 			securityTransactions.setAutoDelete(false);
 			sectrans->security()->transactions.removeRef(sectrans);
+			sectrans->security()->transactionsModified();
 			securityTransactions.removeRef(sectrans);
 			securityTransactions.setAutoDelete(true);
 			if(!keep) delete trans;
@@ -2443,12 +2478,16 @@ void Budget::addSplitTransaction(SplitTransaction *split) {
 	if(split->firstRevision() == 0) split->setFirstRevision(i_revision);
 	if(split->lastRevision() == 0) split->setLastRevision(i_revision);
 	splitTransactions.inSort(split);
+	if(b_text_index_valid) text_index.updateTransaction(split);
+	if(b_completion_index_valid) completion_index.updateTransaction(split);
 	int c = split->count();
 	for(int i = 0; i < c; i++) {
 		addTransaction(split->at(i));
 	}
 }
 void Budget::removeSplitTransaction(SplitTransaction *split, bool keep) {
+	if(b_text_index_valid) updateTextIndex(split, true);
+	if(b_completion_index_valid) updateCompletionIndex(split, true);
 	int c = split->count();
 	for(int i = 0; i < c; i++) {
 		Transaction *trans = split->at(i);
@@ -2465,6 +2504,7 @@ void Budget::removeSplitTransaction(SplitTransaction *split, bool keep) {
 				incomes.removeRef((Income*) trans);
 				if(trans->subtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND) ((Income*) trans)->security()->reinvestedDividends.removeRef((ReinvestedDividend*) trans);
 				else if(((Income*) trans)->security()) ((Income*) trans)->security()->dividends.removeRef((Income*) trans);
+				if(((Income*) trans)->security()) ((Income*) trans)->security()->transactionsModified();
 				incomes.setAutoDelete(true);
 				break;
 			}
@@ -2480,6 +2520,7 @@ void Budget::removeSplitTransaction(SplitTransaction *split, bool keep) {
 				sectrans->security()->removeQuotation(sectrans->date(), true);
 				securityTransactions.setAutoDelete(false);
 				sectrans->security()->transactions.removeRef(sectrans);
+				sectrans->security()->transactionsModified();
 				securityTransactions.removeRef(sectrans);
 				securityTransactions.setAutoDelete(true);
 				break;
@@ -2495,20 +2536,29 @@ void Budget::addScheduledTransaction(ScheduledTransaction *strans) {
 	if(strans->firstRevision() == 0) strans->setFirstRevision(i_revision);
 	if(strans->lastRevision() == 0) strans->setLastRevision(i_revision);
 	scheduledTransactions.inSort(strans);
+	if(b_text_index_valid) updateTextIndex(strans, false);
+	if(b_completion_index_valid) updateCompletionIndex(strans, false);
 	if(strans->transactiontype() == TRANSACTION_TYPE_SECURITY_BUY || strans->transactiontype() == TRANSACTION_TYPE_SECURITY_SELL) {
 		((SecurityTransaction*) strans->transaction())->security()->scheduledTransactions.inSort(strans);
+		((SecurityTransaction*) strans->transaction())->security()->transactionsModified();
 	} else if(strans->transactiontype() == TRANSACTION_TYPE_INCOME && ((Income*) strans->transaction())->security()) {
 		if(strans->transactionsubtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND) ((Income*) strans->transaction())->security()->scheduledReinvestedDividends.inSort(strans);
 		else ((Income*) strans->transaction())->security()->scheduledDividends.inSort(strans);
+		((Income*) strans->transaction())->security()->transactionsModified();
 	}
 }
 void Budget::removeScheduledTransaction(ScheduledTransaction *strans, bool keep) {
 	 if(strans->transactiontype() == TRANSACTION_TYPE_SECURITY_BUY || strans->transactiontype() == TRANSACTION_TYPE_SECURITY_SELL) {
 		((SecurityTransaction*) strans->transaction())->security()->scheduledTransactions.removeRef(strans);
+		((SecurityTransaction*) strans->transaction())->security()->transactionsModified();
 	 } else if(strans->transactiontype() == TRANSACTION_TYPE_INCOME && ((Income*) strans->transaction())->security()) {
 	 	if(strans->transactionsubtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND) ((Income*) strans->transaction())->security()->scheduledReinvestedDividends.removeRef(strans);
 		else ((Income*) strans->transaction())->security()->scheduledDividends.removeRef(strans);
+		((Income*) strans->transaction())->security()->transactionsModified();
 	}
+	schedule_occurrences.remove(strans);
+	if(b_text_index_valid) updateTextIndex(strans, true);
+	if(b_completion_index_valid) updateCompletionIndex(strans, true);
 	if(keep) scheduledTransactions.setAutoDelete(false);
 	scheduledTransactions.removeRef(strans);
 	if(keep) scheduledTransactions.setAutoDelete(true);
@@ -2518,8 +2568,8 @@ void Budget::addAccount(Account *account) {
 	if(account->firstRevision() == 0) account->setFirstRevision(i_revision);
 	if(account->lastRevision() == 0) account->setLastRevision(i_revision);
 	switch(account->type()) {
-		case ACCOUNT_TYPE_EXPENSES: {expensesAccounts.inSort((ExpensesAccount*) account); break;}
-		case ACCOUNT_TYPE_INCOMES: {incomesAccounts.inSort((IncomesAccount*) account); break;}
+		case ACCOUNT_TYPE_EXPENSES: {expensesAccounts.inSort((ExpensesAccount*) account); categoriesModified(); break;}
+		case ACCOUNT_TYPE_INCOMES: {incomesAccounts.inSort((IncomesAccount*) account); categoriesModified(); break;}
 		case ACCOUNT_TYPE_ASSETS: {assetsAccounts.inSort((AssetsAccount*) account); break;}
 	}
 	accounts.inSort(account);
@@ -2530,7 +2580,12 @@ void Budget::accountModified(Account *account) {
 	switch(account->type()) {
 		case ACCOUNT_TYPE_EXPENSES: {expensesAccounts.sort(); break;}
 		case ACCOUNT_TYPE_INCOMES: {incomesAccounts.sort(); break;}
-		case ACCOUNT_TYPE_ASSETS: {assetsAccounts.sort(); break;}
+		case ACCOUNT_TYPE_ASSETS: {
+			assetsAccounts.sort();
+			//descriptions of loan payments include the account name
+			if(b_completion_index_valid) resetCompletionIndex();
+			break;
+		}
 	}
 	accounts.sort();
 }
@@ -2579,12 +2634,14 @@ void Budget::removeAccount(Account *account, bool keep) {
 			if(keep) expensesAccounts.setAutoDelete(false);
 			expensesAccounts.removeRef((ExpensesAccount*) account);
 			if(keep) expensesAccounts.setAutoDelete(true);
+			categoriesModified();
 			break;
 		}
 		case ACCOUNT_TYPE_INCOMES: {
 			if(keep) incomesAccounts.setAutoDelete(false);
 			incomesAccounts.removeRef((IncomesAccount*) account);
 			if(keep) incomesAccounts.setAutoDelete(true);
+			categoriesModified();
 			break;
 		}
 		case ACCOUNT_TYPE_ASSETS: {
@@ -2620,6 +2677,116 @@ bool Budget::accountHasTransactions(Account *account, bool check_subs) {
 	}
 	return false;
 }
+void Budget::resetTextIndex() {
+	text_index.clear();
+	b_text_index_valid = false;
+}
+void Budget::updateTextIndex(Transactions *transs, bool remove) {
+	switch(transs->generaltype()) {
+		case GENERAL_TRANSACTION_TYPE_SINGLE: {
+			if(remove) text_index.removeTransaction(transs);
+			else text_index.updateTransaction(transs);
+			break;
+		}
+		case GENERAL_TRANSACTION_TYPE_SPLIT: {
+			SplitTransaction *split = (SplitTransaction*) transs;
+			if(remove) text_index.removeTransaction(split);
+			else text_index.updateTransaction(split);
+			for(int i = 0; i < split->count(); i++) updateTextIndex(split->at(i), remove);
+			break;
+		}
+		case GENERAL_TRANSACTION_TYPE_SCHEDULE: {
+			if(((ScheduledTransaction*) transs)->transaction()) updateTextIndex(((ScheduledTransaction*) transs)->transaction(), remove);
+			break;
+		}
+	}
+}
+const TransactionTextIndex &Budget::textIndex() {
+	if(!b_text_index_valid) {
+		text_index.clear();
+		for(TransactionList<Transaction*>::const_iterator it = transactions.constBegin(); it != transactions.constEnd(); ++it) {
+			text_index.updateTransaction(*it);
+		}
+		for(SplitTransactionList<SplitTransaction*>::const_iterator it = splitTransactions.constBegin(); it != splitTransactions.constEnd(); ++it) {
+			text_index.updateTransaction(*it);
+		}
+		for(ScheduledTransactionList<ScheduledTransaction*>::const_iterator it = scheduledTransactions.constBegin(); it != scheduledTransactions.constEnd(); ++it) {
+			updateTextIndex(*it, false);
+		}
+		b_text_index_valid = true;
+	}
+	return text_index;
+}
+void Budget::transactionTextModified(Transactions *transs) {
+	if(b_completion_index_valid) updateCompletionIndex(transs, false);
+	if(!b_text_index_valid) return;
+	updateTextIndex(transs, false);
+	if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SINGLE && ((Transaction*) transs)->parentSplit()) text_index.updateTransaction(((Transaction*) transs)->parentSplit());
+}
+void Budget::resetCompletionIndex() {
+	completion_index.clear();
+	b_completion_index_valid = false;
+	completion_index.notifyModels();
+}
+void Budget::updateCompletionIndex(Transactions *transs, bool remove) {
+	if(remove) completion_index.removeTransaction(transs);
+	else completion_index.updateTransaction(transs);
+	if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT) {
+		SplitTransaction *split = (SplitTransaction*) transs;
+		for(int i = 0; i < split->count(); i++) updateCompletionIndex(split->at(i), remove);
+	} else if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SCHEDULE) {
+		Transactions *stranss = ((ScheduledTransaction*) transs)->transaction();
+		if(stranss && stranss->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT) {
+			SplitTransaction *split = (SplitTransaction*) stranss;
+			for(int i = 0; i < split->count(); i++) updateCompletionIndex(split->at(i), remove);
+		}
+	}
+}
+const CompletionIndex &Budget::completionIndex() {
+	if(!b_completion_index_valid) {
+		completion_index.clear();
+		for(TransactionList<Transaction*>::const_iterator it = transactions.constBegin(); it != transactions.constEnd(); ++it) {
+			completion_index.updateTransaction(*it);
+		}
+		for(SplitTransactionList<SplitTransaction*>::const_iterator it = splitTransactions.constBegin(); it != splitTransactions.constEnd(); ++it) {
+			completion_index.updateTransaction(*it);
+		}
+		for(ScheduledTransactionList<ScheduledTransaction*>::const_iterator it = scheduledTransactions.constBegin(); it != scheduledTransactions.constEnd(); ++it) {
+			updateCompletionIndex(*it, false);
+		}
+		b_completion_index_valid = true;
+	}
+	return completion_index;
+}
+void Budget::addCompletionModel(CompletionModel *model) {
+	completion_index.addModel(model);
+}
+void Budget::removeCompletionModel(CompletionModel *model) {
+	completion_index.removeModel(model);
+}
+void Budget::categoriesModified() {
+	b_categories_valid = false;
+}
+void Budget::appendCategory(CategoryAccount *ca, int parent) {
+	int index = v_categories.count();
+	v_categories << ca;
+	v_category_parents << parent;
+	for(AccountList<CategoryAccount*>::const_iterator it = ca->subCategories.constBegin(); it != ca->subCategories.constEnd(); ++it) {
+		appendCategory(*it, index);
+	}
+}
+void Budget::updateCategoryHierarchy() {
+	if(b_categories_valid) return;
+	v_categories.clear();
+	v_category_parents.clear();
+	for(AccountList<IncomesAccount*>::const_iterator it = incomesAccounts.constBegin(); it != incomesAccounts.constEnd(); ++it) {
+		if(!(*it)->parentCategory()) appendCategory(*it, -1);
+	}
+	for(AccountList<ExpensesAccount*>::const_iterator it = expensesAccounts.constBegin(); it != expensesAccounts.constEnd(); ++it) {
+		if(!(*it)->parentCategory()) appendCategory(*it, -1);
+	}
+	b_categories_valid = true;
+}
 void Budget::moveTransactions(Account *account, Account *new_account, bool move_from_subs) {
 	if(move_from_subs && (account->type() == ACCOUNT_TYPE_INCOMES || account->type() == ACCOUNT_TYPE_EXPENSES)) {
 		for(AccountList<CategoryAccount*>::const_iterator it = ((CategoryAccount*) account)->subCategories.constBegin(); it != ((CategoryAccount*) account)->subCategories.constEnd(); ++it) {
@@ -2645,6 +2812,8 @@ void Budget::moveTransactions(Account *account, Account *new_account, bool move_
 		ScheduledTransaction *strans = *it;
 		strans->replaceAccount(account, new_account);
 	}
+	//transactions are indexed by category
+	if(b_completion_index_valid && account->type() != ACCOUNT_TYPE_ASSETS) resetCompletionIndex();
 }
 void Budget::transactionsSortModified(Transactions *trans) {
 	switch(trans->generaltype()) {
@@ -2668,6 +2837,7 @@ void Budget::transactionSortModified(Transaction *t) {
 			if(i->security()) {
 				if(i->subtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND && i->security()->reinvestedDividends.removeRef((ReinvestedDividend*) i)) i->security()->reinvestedDividends.inSort((ReinvestedDividend*) i);
 				else if(i->security()->dividends.removeRef(i)) i->security()->dividends.inSort(i);
+				i->security()->transactionsModified();
 			}
 			incomes.setAutoDelete(false);
 			if(incomes.removeRef(i)) incomes.inSort(i);
@@ -2685,6 +2855,7 @@ void Budget::transactionSortModified(Transaction *t) {
 		case TRANSACTION_TYPE_SECURITY_SELL: {
 			SecurityTransaction *tr = (SecurityTransaction*) t;
 			if(tr->security()->transactions.removeRef(tr)) tr->security()->transactions.inSort(tr);
+			tr->security()->transactionsModified();
 			securityTransactions.setAutoDelete(false);
 			if(securityTransactions.removeRef(tr)) securityTransactions.inSort(tr);
 			securityTransactions.setAutoDelete(true);
@@ -2708,14 +2879,53 @@ void Budget::transactionDateModified(Transaction*, const QDate&) {
 		}
 	}*/
 }
-void Budget::scheduledTransactionDateModified(ScheduledTransaction*) {
+void Budget::scheduledTransactionDateModified(ScheduledTransaction *strans) {
+	schedule_occurrences.remove(strans);
+}
+void Budget::scheduledTransactionTransactionRemoved(ScheduledTransaction *strans) {
+	if(b_text_index_valid && strans->transaction()) updateTextIndex(strans->transaction(), true);
+	if(b_completion_index_valid) updateCompletionIndex(strans, true);
+}
+QVector<QDate> Budget::scheduledOccurrences(ScheduledTransaction *strans, const QDate &last_date) {
+	Recurrence *rec = strans->recurrence();
+	QVector<QDate> dates;
+	if(!rec) {
+		if(strans->date() <= last_date) dates << strans->date();
+		return dates;
+	}
+	bool in_budget = false;
+	for(ScheduledTransactionList<ScheduledTransaction*>::const_iterator it = std::lower_bound(scheduledTransactions.constBegin(), scheduledTransactions.constEnd(), strans, schedule_list_less_than); it != scheduledTransactions.constEnd() && !schedule_list_less_than(strans, *it); ++it) {
+		if(*it == strans) {
+			in_budget = true;
+			break;
+		}
+	}
+	if(!in_budget) return rec->occurrences(rec->firstOccurrence(), last_date);
+	QHash<ScheduledTransaction*, ScheduleOccurrences>::iterator it_so = schedule_occurrences.find(strans);
+	if(it_so == schedule_occurrences.end() || it_so->revision != rec->revision()) {
+		ScheduleOccurrences so;
+		so.revision = rec->revision();
+		so.next = rec->firstOccurrence();
+		it_so = schedule_occurrences.insert(strans, so);
+	}
+	if(it_so->until.isNull() || it_so->until < last_date) {
+		if(!it_so->next.isNull() && it_so->next <= last_date) {
+			it_so->dates += rec->occurrences(it_so->next, last_date);
+			it_so->next = rec->nextOccurrence(last_date);
+		}
+		it_so->until = last_date;
+	}
+	return it_so->dates;
 }
 void Budget::scheduledTransactionSortModified(ScheduledTransaction *strans) {
+	schedule_occurrences.remove(strans);
 	if(strans->transactiontype() == TRANSACTION_TYPE_SECURITY_BUY || strans->transactiontype() == TRANSACTION_TYPE_SECURITY_SELL) {
 		if(((SecurityTransaction*) strans->transaction())->security()->scheduledTransactions.removeRef(strans)) ((SecurityTransaction*) strans->transaction())->security()->scheduledTransactions.inSort(strans);
+		((SecurityTransaction*) strans->transaction())->security()->transactionsModified();
 	} else if(strans->transactiontype() == TRANSACTION_TYPE_INCOME && ((Income*) strans->transaction())->security()) {
 		if(strans->transactionsubtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND && ((Income*) strans->transaction())->security()->scheduledReinvestedDividends.removeRef(strans)) ((Income*) strans->transaction())->security()->scheduledReinvestedDividends.inSort(strans);
 		if(((Income*) strans->transaction())->security()->scheduledDividends.removeRef(strans)) ((Income*) strans->transaction())->security()->scheduledDividends.inSort(strans);
+		((Income*) strans->transaction())->security()->transactionsModified();
 	}
 	scheduledTransactions.setAutoDelete(false);
 	if(scheduledTransactions.removeRef(strans)) scheduledTransactions.inSort(strans);
@@ -2793,20 +3003,23 @@ void Budget::removeSecurity(Security *security, bool keep) {
 		}
 		for(ScheduledSecurityTransactionList<ScheduledTransaction*>::const_iterator it = security->scheduledTransactions.constBegin(); it != security->scheduledTransactions.constEnd(); ++it) {
 			ScheduledTransaction *strans = *it;
+			schedule_occurrences.remove(strans);
 			scheduledTransactions.removeRef(strans);
 		}
 		for(ScheduledSecurityTransactionList<ScheduledTransaction*>::const_iterator it = security->scheduledDividends.constBegin(); it != security->scheduledDividends.constEnd(); ++it) {
 			ScheduledTransaction *strans = *it;
+			schedule_occurrences.remove(strans);
 			scheduledTransactions.removeRef(strans);
 		}
 		for(ScheduledSecurityTransactionList<ScheduledTransaction*>::const_iterator it = security->scheduledReinvestedDividends.constBegin(); it != security->scheduledReinvestedDividends.constEnd(); ++it) {
 			ScheduledTransaction *strans = *it;
+			schedule_occurrences.remove(strans);
 			scheduledTransactions.removeRef(strans);
 		}
 		for(TradedSharesList<SecurityTrade*>::const_iterator it = security->tradedShares.constBegin(); it != security->tradedShares.constEnd(); ++it) {
 			SecurityTrade *ts = *it;
-			if(ts->to_security == security) ts->from_security->tradedShares.removeRef(ts);
-			else ts->to_security->tradedShares.removeRef(ts);
+			if(ts->to_security == security) {ts->from_security->tradedShares.removeRef(ts); ts->from_security->transactionsModified();}
+			else {ts->to_security->tradedShares.removeRef(ts); ts->to_security->transactionsModified();}
 			securityTrades.removeRef(ts);
 		}
 	}
@@ -2844,10 +3057,14 @@ void Budget::addSecurityTrade(SecurityTrade *ts) {
 	securityTrades.inSort(ts);
 	ts->from_security->tradedShares.inSort(ts);
 	ts->to_security->tradedShares.inSort(ts);
+	ts->from_security->transactionsModified();
+	ts->to_security->transactionsModified();
 }
 void Budget::removeSecurityTrade(SecurityTrade *ts, bool keep) {
 	ts->from_security->tradedShares.removeRef(ts);
 	ts->to_security->tradedShares.removeRef(ts);
+	ts->from_security->transactionsModified();
+	ts->to_security->transactionsModified();
 	ts->from_security->removeQuotation(ts->date, true);
 	ts->to_security->removeQuotation(ts->date, true);
 	if(keep) securityTrades.setAutoDelete(false);
@@ -2866,6 +3083,8 @@ void Budget::securityTradeDateModified(SecurityTrade *ts, const QDate &olddate)
 	if(ts->to_security->tradedShares.removeRef(ts)) {
 		ts->to_security->tradedShares.inSort(ts);
 	}
+	ts->from_security->transactionsModified();
+	ts->to_security->transactionsModified();
 	ts->from_security->removeQuotation(olddate, true);
 	ts->to_security->removeQuotation(olddate, true);
 }
@@ -2944,6 +3163,12 @@ void Budget::addCurrency(Currency *cur) {
 }
 void Budget::currencyModified(Currency*) {
 	b_currency_modified = true;
+	exchangeRatesModified();
+}
+void Budget::exchangeRatesModified() {
+	for(SecurityList<Security*>::const_iterator it = securities.constBegin(); it != securities.constEnd(); ++it) {
+		(*it)->transactionsModified();
+	}
 }
 void Budget::removeCurrency(Currency *cur) {
 	currencies.removeRef(cur);
@@ -2979,10 +3204,63 @@ bool Budget::usesMultipleCurrencies() {
 	return false;
 }
 
-void Budget::setBudgetDay(int day_of_month) {if(day_of_month <= 28 && day_of_month >= -26) i_budget_day = day_of_month;}
+void Budget::setBudgetDay(int day_of_month) {
+	if(day_of_month <= 28 && day_of_month >= -26) {
+		i_budget_day = day_of_month;
+		updateBudgetCalendar();
+	}
+}
 int Budget::budgetDay() const {return i_budget_day;}
-void Budget::setBudgetMonth(int month_of_year) {if(month_of_year <= 12 && month_of_year >= 1) i_budget_month = month_of_year;}
+void Budget::setBudgetMonth(int month_of_year) {
+	if(month_of_year <= 12 && month_of_year >= 1) {
+		i_budget_month = month_of_year;
+		updateBudgetCalendar();
+	}
+}
 int Budget::budgetMonth() const {return i_budget_month;}
+void Budget::updateBudgetCalendar() {
+	//disable lookups while the table is calculated
+	i_calendar_day = 100;
+	i_calendar_month = 0;
+	v_calendar_months.clear();
+	v_calendar_years.clear();
+	v_calendar_month_numbers.clear();
+	v_calendar_month_first.clear();
+	QDate first_date = QDate::currentDate(), last_date = first_date;
+	if(!transactions.isEmpty()) {
+		if(transactions.first()->date() < first_date) first_date = transactions.first()->date();
+		if(transactions.last()->date() > last_date) last_date = transactions.last()->date();
+	}
+	first_date = firstBudgetDay(QDate(first_date.year() - 2, 1, 1));
+	last_date = QDate(last_date.year() + 20, 12, 31);
+	i_calendar_first_jd = first_date.toJulianDay();
+	v_calendar_months.reserve(first_date.daysTo(last_date) + 1);
+	v_calendar_years.reserve(first_date.daysTo(last_date) + 1);
+	QDate date = first_date;
+	int i_month = 0;
+	while(date <= last_date) {
+		QDate next_date = date;
+		addBudgetMonthsSetFirst(next_date, 1);
+		v_calendar_month_first << date.toJulianDay();
+		v_calendar_month_numbers << budgetMonth(date);
+		for(; date < next_date; date = date.addDays(1)) {
+			v_calendar_months << i_month;
+			v_calendar_years << budgetYear(date);
+		}
+		i_month++;
+	}
+	v_calendar_month_first << date.toJulianDay();
+	v_calendar_month_numbers << budgetMonth(date);
+	i_calendar_day = i_budget_day;
+	i_calendar_month = i_budget_month;
+}
+int Budget::budgetCalendarIndex(const QDate &date) const {
+	//the table is not used while averageMonth() and similar functions temporarily change i_budget_day
+	if(i_calendar_day != i_budget_day || i_calendar_month != i_budget_month) return -1;
+	qint64 i = date.toJulianDay() - i_calendar_first_jd;
+	if(i < 0 || i >= v_calendar_months.count()) return -1;
+	return (int) i;
+}
 
 bool isLeapYear(long int year) {
 	return year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
@@ -3027,9 +3305,13 @@ int daysPerMonth(int month, long int year) {
 }
 
 bool Budget::isSameBudgetMonth(const QDate &date1, const QDate &date2) const {
+	int i1 = budgetCalendarIndex(date1), i2 = budgetCalendarIndex(date2);
+	if(i1 >= 0 && i2 >= 0) return v_calendar_years[i1] == v_calendar_years[i2] && v_calendar_month_numbers[v_calendar_months[i1]] == v_calendar_month_numbers[v_calendar_months[i2]];
 	return budgetYear(date1) == budgetYear(date2) && budgetMonth(date1) == budgetMonth(date2);
 }
 int Budget::daysInBudgetMonth(const QDate &date) const {
+	int i = budgetCalendarIndex(date);
+	if(i >= 0) return v_calendar_month_first[v_calendar_months[i] + 1] - v_calendar_month_first[v_calendar_months[i]];
 	if(i_budget_day == 1) {
 		return date.daysInMonth();
 	} else if(i_budget_day > 0) {
@@ -3051,10 +3333,14 @@ int Budget::dayOfBudgetYear(const QDate &date) const {
 }
 int Budget::dayOfBudgetMonth(const QDate &date) const {
 	if(i_budget_day == 1) return date.day();
+	int i = budgetCalendarIndex(date);
+	if(i >= 0) return date.toJulianDay() - v_calendar_month_first[v_calendar_months[i]] + 1;
 	return firstBudgetDay(date).daysTo(date) + 1;
 }
 int Budget::budgetMonth(const QDate &date) const {
 	int i_month = 1;
+	int i = budgetCalendarIndex(date);
+	if(i >= 0) return v_calendar_month_numbers[v_calendar_months[i]];
 	if(i_budget_day == 1) {
 		i_month = date.month();
 	} else {
@@ -3074,6 +3360,8 @@ int Budget::budgetMonth(const QDate &date) const {
 }
 int Budget::budgetYear(const QDate &date) const {
 	if(i_budget_day == 1 && i_budget_month == 1) return date.year();
+	int i = budgetCalendarIndex(date);
+	if(i >= 0) return v_calendar_years[i];
 	int ibd = i_budget_day;
 	int year = date.year();
 	if(i_budget_day <= 0) ibd = daysPerMonth(i_budget_month == 1 ? 12 : i_budget_month - 1, year) + i_budget_day;
@@ -3136,6 +3424,15 @@ bool Budget::isLastBudgetDay(const QDate &date) const {
 	return ((i_budget_day == 1 && date.day() == date.daysInMonth()) || (i_budget_day > 1 && date.day() == i_budget_day - 1) || (i_budget_day <= 0 && date.day() == date.daysInMonth() + i_budget_day - 1));
 }
 void Budget::addBudgetMonthsSetLast(QDate &date, int months) const {
+	int i = budgetCalendarIndex(date);
+	//with days counted from the end of the month, dates within a budget month might move to another month than the following one
+	if(i >= 0 && (i_budget_day > 0 || date.toJulianDay() == v_calendar_month_first[v_calendar_months[i] + 1] - 1)) {
+		int i_month = v_calendar_months[i] + months;
+		if(i_month >= 0 && i_month + 1 < v_calendar_month_first.count()) {
+			date = QDate::fromJulianDay(v_calendar_month_first[i_month + 1] - 1);
+			return;
+		}
+	}
 	if(i_budget_day <= 0) {
 		int dfl = date.daysInMonth() - date.day();
 		date = date.addMonths(months); 
@@ -3146,6 +3443,14 @@ void Budget::addBudgetMonthsSetLast(QDate &date, int months) const {
 	date = lastBudgetDay(date);
 }
 void Budget::addBudgetMonthsSetFirst(QDate &date, int months) const {
+	int i = budgetCalendarIndex(date);
+	if(i >= 0 && (i_budget_day > 0 || date.toJulianDay() == v_calendar_month_first[v_calendar_months[i]])) {
+		int i_month = v_calendar_months[i] + months;
+		if(i_month >= 0 && i_month < v_calendar_month_first.count()) {
+			date = QDate::fromJulianDay(v_calendar_month_first[i_month]);
+			return;
+		}
+	}
 	if(i_budget_day <= 0) {
 		int dfl = date.daysInMonth() - date.day();
 		date = date.addMonths(months); 
@@ -3174,6 +3479,8 @@ QDate Budget::budgetDateToMonth(QDate date) const {
 	return date;
 }
 QDate Budget::firstBudgetDay(QDate date) const {
+	int i = budgetCalendarIndex(date);
+	if(i >= 0) return QDate::fromJulianDay(v_calendar_month_first[v_calendar_months[i]]);
 	int ibd = i_budget_day;
 	if(i_budget_day < 1) ibd = date.daysInMonth() + i_budget_day;
 	if(date.day() < ibd) {
@@ -3184,6 +3491,8 @@ QDate Budget::firstBudgetDay(QDate date) const {
 	return date;
 }
 QDate Budget::lastBudgetDay(QDate date) const {
+	int i = budgetCalendarIndex(date);
+	if(i >= 0) return QDate::fromJulianDay(v_calendar_month_first[v_calendar_months[i] + 1] - 1);
 	int ibd = i_budget_day;
 	if(i_budget_day < 1) ibd = date.daysInMonth() + i_budget_day;
 	if(ibd == 1) {
@@ -3421,3 +3730,51 @@ QString Budget::findTag(const QString &tag) {
 }
 void Budget::setRecordNewTags(bool rnt) {b_record_new_tags = rnt;}
 
+static bool schedule_iterator_entry_greater(const ScheduleIteratorEntry &e1, const ScheduleIteratorEntry &e2) {
+	const QDate &date1 = e1.dates[e1.index], &date2 = e2.dates[e2.index];
+	return date1 > date2 || (date1 == date2 && e1.order > e2.order);
+}
+ScheduleIterator::ScheduleIterator(Budget *parent_budget, const QDate &first_date, const QDate &last_date) : o_budget(parent_budget), d_first(first_date), d_last(last_date), o_strans(NULL) {
+	int order = 0;
+	for(ScheduledTransactionList<ScheduledTransaction*>::const_iterator it = o_budget->scheduledTransactions.constBegin(); it != o_budget->scheduledTransactions.constEnd(); ++it) {
+		ScheduledTransaction *strans = *it;
+		if(strans->firstOccurrence() > d_last) break;
+		ScheduleIteratorEntry e;
+		e.order = order;
+		e.strans = strans;
+		e.dates = o_budget->scheduledOccurrences(strans, d_last);
+		e.index = 0;
+		if(!d_first.isNull()) e.index = std::lower_bound(e.dates.constBegin(), e.dates.constEnd(), d_first) - e.dates.constBegin();
+		if(e.index < e.dates.count() && e.dates[e.index] <= d_last) {
+			v_heap << e;
+			order++;
+		}
+	}
+	std::make_heap(v_heap.begin(), v_heap.end(), schedule_iterator_entry_greater);
+}
+bool ScheduleIterator::next() {
+	if(v_heap.isEmpty()) {
+		o_strans = NULL;
+		d_date = QDate();
+		return false;
+	}
+	std::pop_heap(v_heap.begin(), v_heap.end(), schedule_iterator_entry_greater);
+	ScheduleIteratorEntry &e = v_heap.last();
+	d_date = e.dates[e.index];
+	o_strans = e.strans;
+	e.index++;
+	if(e.index < e.dates.count() && e.dates[e.index] <= d_last) std::push_heap(v_heap.begin(), v_heap.end(), schedule_iterator_entry_greater);
+	else v_heap.pop_back();
+	return true;
+}
+const QDate &ScheduleIterator::date() const {return d_date;}
+ScheduledTransaction *ScheduleIterator::scheduledTransaction() const {return o_strans;}
+int ScheduleIterator::count() const {
+	if(!o_strans || !o_strans->transaction()) return 0;
+	if(o_strans->transaction()->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT) return ((SplitTransaction*) o_strans->transaction())->count();
+	return 1;
+}
+Transaction *ScheduleIterator::transaction(int index) const {
+	if(o_strans->transaction()->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT) return ((SplitTransaction*) o_strans->transaction())->at(index);
+	return (Transaction*) o_strans->transaction();
+}
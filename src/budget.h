@@ -36,6 +36,8 @@
 #include "transaction.h"
 #include "security.h"
 #include "currency.h"
+#include "transactiontextindex.h"
+#include "completionindex.h"
 
 #define MONETARY_DECIMAL_PLACES 2
 #define SAVE_MONETARY_DECIMAL_PLACES 4
@@ -130,6 +132,22 @@ struct BudgetSynchronization {
 	}
 };
 
+struct ScheduleOccurrences {
+	//Recurrence::revision() of the expanded recurrence
+	int revision;
+	QDate until, next;
+	QVector<QDate> dates;
+};
+
+inline void add_category_value(double &value, const double &sub_value) {value += sub_value;}
+inline void add_category_value(QVector<double> &value, const QVector<double> &sub_value) {
+	if(value.count() < sub_value.count()) value.resize(sub_value.count());
+	for(int i = 0; i < sub_value.count(); i++) value[i] += sub_value[i];
+}
+inline void add_category_value(QMap<QString, double> &value, const QMap<QString, double> &sub_value) {
+	for(QMap<QString, double>::const_iterator it = sub_value.constBegin(); it != sub_value.constEnd(); ++it) value[it.key()] += it.value();
+}
+
 class Budget {
 
 	Q_DECLARE_TR_FUNCTIONS(Budget)
@@ -139,14 +157,43 @@ class Budget {
 		int i_quotation_decimals, i_share_decimals, i_budget_day, i_budget_month, i_opened_revision, i_revision;
 		bool b_record_new_tags, b_record_new_accounts, b_record_new_securities, b_default_currency_changed, b_currency_modified;
 		TransactionConversionRateDate i_tcrd;
+
+		//budget month index and budget year of each day from i_calendar_first_jd, and the first day of each budget month (with one extra month at the end), built for i_calendar_day and i_calendar_month
+		QVector<int> v_calendar_months, v_calendar_years, v_calendar_month_numbers;
+		QVector<qint64> v_calendar_month_first;
+		qint64 i_calendar_first_jd;
+		int i_calendar_day, i_calendar_month;
+		int budgetCalendarIndex(const QDate &date) const;
 		
 		qlonglong last_id;
+		int i_account_ordinals;
 		
 		Currency *default_currency;
 		
 		QNetworkReply *syncReply;
 		QProcess *syncProcess;
 
+		QHash<ScheduledTransaction*, ScheduleOccurrences> schedule_occurrences;
+
+		//incomes and expenses categories with each category followed by its subcategories, and the index of the parent (-1 for top categories)
+		QVector<CategoryAccount*> v_categories;
+		QVector<int> v_category_parents;
+		bool b_categories_valid;
+		void updateCategoryHierarchy();
+		void appendCategory(CategoryAccount *ca, int parent);
+
+		//built when first requested
+		TransactionTextIndex text_index;
+		bool b_text_index_valid;
+		void resetTextIndex();
+		void updateTextIndex(Transactions *transs, bool remove);
+
+		//built when first requested, and thereafter updated incrementally
+		CompletionIndex completion_index;
+		bool b_completion_index_valid;
+		void resetCompletionIndex();
+		void updateCompletionIndex(Transactions *transs, bool remove);
+
 	public:
 	
 		BudgetSynchronization *o_sync;
@@ -208,6 +255,29 @@ class Budget {
 		void accountModified(Account*);
 
 		bool accountHasTransactions(Account*, bool check_subs = true);
+
+		const TransactionTextIndex &textIndex();
+		//should be called when the description, comment, payee/payer, tags, date or accounts of a transaction has been changed
+		void transactionTextModified(Transactions *transs);
+
+		const CompletionIndex &completionIndex();
+		//models are refreshed when completion texts are added or removed
+		void addCompletionModel(CompletionModel *model);
+		void removeCompletionModel(CompletionModel *model);
+
+		//should be called when incomes or expenses categories have been added, removed or moved
+		void categoriesModified();
+		//adds the values of subcategories to their parents; values should only include direct transactions of each category
+		template<class T> void rollUpCategoryValues(QMap<Account*, T> &values) {
+			updateCategoryHierarchy();
+			for(int i = v_categories.count() - 1; i >= 0; i--) {
+				if(v_category_parents[i] < 0) continue;
+				typename QMap<Account*, T>::const_iterator it = values.constFind(v_categories[i]);
+				if(it == values.constEnd()) continue;
+				T value = it.value();
+				add_category_value(values[v_categories[v_category_parents[i]]], value);
+			}
+		}
 		void moveTransactions(Account*, Account*, bool move_from_subs = true);
 		
 		Transaction *findDuplicateTransaction(Transaction *trans); 
@@ -224,6 +294,10 @@ class Budget {
 		bool securityHasTransactions(Security*);
 
 		void scheduledTransactionDateModified(ScheduledTransaction*);
+		//should be called before the transaction of a scheduled transaction is deleted or replaced
+		void scheduledTransactionTransactionRemoved(ScheduledTransaction*);
+		//occurrence dates, in order, until (at least) last_date; expanded occurrences of scheduled transactions in the budget are cached until the revision of the recurrence changes
+		QVector<QDate> scheduledOccurrences(ScheduledTransaction *strans, const QDate &last_date);
 		void transactionDateModified(Transaction*, const QDate &olddate);
 		void splitTransactionDateModified(SplitTransaction*, const QDate &olddate);
 		void transactionsSortModified(Transactions*);
@@ -257,8 +331,11 @@ class Budget {
 		bool currenciesModified();
 		void resetCurrenciesModified();
 		void currencyModified(Currency*);
+		//clears values of securities that have been converted using exchange rates
+		void exchangeRatesModified();
 		
 		qlonglong getNewId();
+		int newAccountOrdinal();
 		int revision();
 		
 		AccountList<IncomesAccount*> incomesAccounts;
@@ -294,6 +371,8 @@ class Budget {
 		int budgetDay() const;
 		void setBudgetMonth(int month_of_year);
 		int budgetMonth() const;
+		//rebuild the budget month lookup table after budget period or date span changes
+		void updateBudgetCalendar();
 		
 		bool isSameBudgetMonth(const QDate &date1, const QDate &date2) const;
 		int daysInBudgetMonth(const QDate &date) const;
@@ -340,4 +419,33 @@ class Budget {
 
 };
 
+struct ScheduleIteratorEntry {
+	int order, index;
+	ScheduledTransaction *strans;
+	QVector<QDate> dates;
+};
+
+//Iterates over occurrences of all scheduled transactions from first_date to last_date, in date order
+class ScheduleIterator {
+
+	protected:
+
+		Budget *o_budget;
+		QDate d_first, d_last, d_date;
+		ScheduledTransaction *o_strans;
+		QVector<ScheduleIteratorEntry> v_heap;
+
+	public:
+
+		ScheduleIterator(Budget *parent_budget, const QDate &first_date, const QDate &last_date);
+
+		bool next();
+		const QDate &date() const;
+		ScheduledTransaction *scheduledTransaction() const;
+		//number of transactions (parts of split transactions) for the current occurrence
+		int count() const;
+		Transaction *transaction(int index = 0) const;
+
+};
+
 #endif
@@ -1161,66 +1161,60 @@ void CategoriesComparisonReport::updateDisplay() {
 				if(!include_subs) from_account = from_account->topAccount();
 				Account *to_account = trans->toAccount();
 				if(!include_subs) to_account = to_account->topAccount();
-				while(true) {
-					bool b_top = (current_account || !include_subs) || (from_account == from_account->topAccount() && to_account == to_account->topAccount());
-					if(!current_account || to_account->topAccount() == current_account || from_account->topAccount() == current_account) {
-						if(from_account->type() == ACCOUNT_TYPE_EXPENSES) {
-							values[from_account] -= v;
-							if(month_index >= 0) month_values[from_account][month_index] -= v;
-							if(b_top) costs -= v;
-							if(b_top && month_index >= 0) month_costs[month_index] -= v;
-							counts[from_account] += trans->quantity();
-							if(b_top) costs_count += trans->quantity();
-							if(b_tags) {
-								for(int i = 0; i < trans->tagsCount(true); i++) {
-									tag_values[from_account][trans->getTag(i, true)] -= v;
-									if(b_top) tag_costs[trans->getTag(i, true)] -= v;
-								}
+				if(!current_account || to_account->topAccount() == current_account || from_account->topAccount() == current_account) {
+					if(from_account->type() == ACCOUNT_TYPE_EXPENSES) {
+						values[from_account] -= v;
+						if(month_index >= 0) month_values[from_account][month_index] -= v;
+						costs -= v;
+						if(month_index >= 0) month_costs[month_index] -= v;
+						counts[from_account] += trans->quantity();
+						costs_count += trans->quantity();
+						if(b_tags) {
+							for(int i = 0; i < trans->tagsCount(true); i++) {
+								tag_values[from_account][trans->getTag(i, true)] -= v;
+								tag_costs[trans->getTag(i, true)] -= v;
 							}
-						} else if(from_account->type() == ACCOUNT_TYPE_INCOMES) {
-							values[from_account] += v;
-							if(month_index >= 0) month_values[from_account][month_index] += v;
-							if(b_top) incomes += v;
-							if(b_top && month_index >= 0) month_incomes[month_index] += v;
-							counts[from_account] += trans->quantity();
-							if(b_top) incomes_count += trans->quantity();
-							if(b_tags) {
-								for(int i = 0; i < trans->tagsCount(true); i++) {
-									tag_values[from_account][trans->getTag(i, true)] += v;
-									if(b_top) tag_incomes[trans->getTag(i, true)] += v;
-								}
+						}
+					} else if(from_account->type() == ACCOUNT_TYPE_INCOMES) {
+						values[from_account] += v;
+						if(month_index >= 0) month_values[from_account][month_index] += v;
+						incomes += v;
+						if(month_index >= 0) month_incomes[month_index] += v;
+						counts[from_account] += trans->quantity();
+						incomes_count += trans->quantity();
+						if(b_tags) {
+							for(int i = 0; i < trans->tagsCount(true); i++) {
+								tag_values[from_account][trans->getTag(i, true)] += v;
+								tag_incomes[trans->getTag(i, true)] += v;
 							}
-						} else if(to_account->type() == ACCOUNT_TYPE_EXPENSES) {
-							values[to_account] += v;
-							if(month_index >= 0) month_values[to_account][month_index] += v;
-							if(b_top) costs += v;
-							if(b_top && month_index >= 0) month_costs[month_index] += v;
-							counts[to_account] += trans->quantity();
-							if(b_top) costs_count += trans->quantity();
-							if(b_tags) {
-								for(int i = 0; i < trans->tagsCount(true); i++) {
-									tag_values[to_account][trans->getTag(i, true)] += v;
-									if(b_top) tag_costs[trans->getTag(i, true)] += v;
-								}
+						}
+					} else if(to_account->type() == ACCOUNT_TYPE_EXPENSES) {
+						values[to_account] += v;
+						if(month_index >= 0) month_values[to_account][month_index] += v;
+						costs += v;
+						if(month_index >= 0) month_costs[month_index] += v;
+						counts[to_account] += trans->quantity();
+						costs_count += trans->quantity();
+						if(b_tags) {
+							for(int i = 0; i < trans->tagsCount(true); i++) {
+								tag_values[to_account][trans->getTag(i, true)] += v;
+								tag_costs[trans->getTag(i, true)] += v;
 							}
-						} else if(to_account->type() == ACCOUNT_TYPE_INCOMES) {
-							values[to_account] -= v;
-							if(month_index >= 0) month_values[to_account][month_index] -= v;
-							if(b_top) incomes -= v;
-							if(b_top && month_index >= 0) month_incomes[month_index] -= v;
-							counts[to_account] += trans->quantity();
-							if(b_top) incomes_count += trans->quantity();
-							if(b_tags) {
-								for(int i = 0; i < trans->tagsCount(true); i++) {
-									tag_values[to_account][trans->getTag(i, true)] -= v;
-									if(b_top) tag_incomes[trans->getTag(i, true)] -= v;
-								}
+						}
+					} else if(to_account->type() == ACCOUNT_TYPE_INCOMES) {
+						values[to_account] -= v;
+						if(month_index >= 0) month_values[to_account][month_index] -= v;
+						incomes -= v;
+						if(month_index >= 0) month_incomes[month_index] -= v;
+						counts[to_account] += trans->quantity();
+						incomes_count += trans->quantity();
+						if(b_tags) {
+							for(int i = 0; i < trans->tagsCount(true); i++) {
+								tag_values[to_account][trans->getTag(i, true)] -= v;
+								tag_incomes[trans->getTag(i, true)] -= v;
 							}
 						}
 					}
-					if(b_top) break;
-					from_account = from_account->topAccount();
-					to_account = to_account->topAccount();
 				}
 			}
 		}
@@ -1417,70 +1411,64 @@ void CategoriesComparisonReport::updateDisplay() {
 					Account *to_account = trans->toAccount();
 					if(!include_subs) to_account = to_account->topAccount();
 					double v = trans->value(true);
-					while(true) {
-						bool b_top = (current_account || !include_subs) || (from_account == from_account->topAccount() && to_account == to_account->topAccount());
-						if(!current_account || to_account->topAccount() == current_account || from_account->topAccount() == current_account) {
-							if(from_account->type() == ACCOUNT_TYPE_EXPENSES) {
-								int count = strans->recurrence() ? strans->recurrence()->countOccurrences(first_month_date, last_month_date) : 1;
-								counts[from_account] += count * trans->quantity();
-								values[from_account] -= v * count;
-								if(month_index2 >= 0) month_values[from_account][month_index2] -= v * count;
-								if(b_top && month_index2 >= 0) month_costs[month_index2] -= v * count;
-								if(b_top) costs_count += count * trans->quantity();
-								if(b_top) costs -= v * count;
-								if(b_tags) {
-									for(int i = 0; i < trans->tagsCount(true); i++) {
-										tag_values[from_account][trans->getTag(i, true)] -= v * count;
-										if(b_top) tag_costs[trans->getTag(i, true)] -= v * count;
-									}
+					if(!current_account || to_account->topAccount() == current_account || from_account->topAccount() == current_account) {
+						if(from_account->type() == ACCOUNT_TYPE_EXPENSES) {
+							int count = strans->recurrence() ? strans->recurrence()->countOccurrences(first_month_date, last_month_date) : 1;
+							counts[from_account] += count * trans->quantity();
+							values[from_account] -= v * count;
+							if(month_index2 >= 0) month_values[from_account][month_index2] -= v * count;
+							if(month_index2 >= 0) month_costs[month_index2] -= v * count;
+							costs_count += count * trans->quantity();
+							costs -= v * count;
+							if(b_tags) {
+								for(int i = 0; i < trans->tagsCount(true); i++) {
+									tag_values[from_account][trans->getTag(i, true)] -= v * count;
+									tag_costs[trans->getTag(i, true)] -= v * count;
 								}
-							} else if(from_account->type() == ACCOUNT_TYPE_INCOMES) {
-								int count = strans->recurrence() ? strans->recurrence()->countOccurrences(first_month_date, last_month_date) : 1;
-								counts[from_account] += count * trans->quantity();
-								values[from_account] += v * count;
-								if(month_index2 >= 0) month_values[from_account][month_index2] += v * count;
-								if(b_top && month_index2 >= 0) month_incomes[month_index2] += v * count;
-								if(b_top) incomes_count += count * trans->quantity();
-								if(b_top) incomes += v * count;
-								if(b_tags) {
-									for(int i = 0; i < trans->tagsCount(true); i++) {
-										tag_values[from_account][trans->getTag(i, true)] += v * count;
-										if(b_top) tag_incomes[trans->getTag(i, true)] += v * count;
-									}
+							}
+						} else if(from_account->type() == ACCOUNT_TYPE_INCOMES) {
+							int count = strans->recurrence() ? strans->recurrence()->countOccurrences(first_month_date, last_month_date) : 1;
+							counts[from_account] += count * trans->quantity();
+							values[from_account] += v * count;
+							if(month_index2 >= 0) month_values[from_account][month_index2] += v * count;
+							if(month_index2 >= 0) month_incomes[month_index2] += v * count;
+							incomes_count += count * trans->quantity();
+							incomes += v * count;
+							if(b_tags) {
+								for(int i = 0; i < trans->tagsCount(true); i++) {
+									tag_values[from_account][trans->getTag(i, true)] += v * count;
+									tag_incomes[trans->getTag(i, true)] += v * count;
 								}
-							} else if(to_account->type() == ACCOUNT_TYPE_EXPENSES) {
-								int count = strans->recurrence() ? strans->recurrence()->countOccurrences(first_month_date, last_month_date) : 1;
-								counts[to_account] += count * trans->quantity();
-								values[to_account] += v * count;
-								if(month_index2 >= 0) month_values[to_account][month_index2] += v * count;
-								if(b_top && month_index2 >= 0) month_costs[month_index2] += v * count;
-								if(b_top) costs_count += count * trans->quantity();
-								if(b_top) costs += v * count;
-								if(b_tags) {
-									for(int i = 0; i < trans->tagsCount(true); i++) {
-										tag_values[to_account][trans->getTag(i, true)] += v * count;
-										if(b_top) tag_costs[trans->getTag(i, true)] += v * count;
-									}
+							}
+						} else if(to_account->type() == ACCOUNT_TYPE_EXPENSES) {
+							int count = strans->recurrence() ? strans->recurrence()->countOccurrences(first_month_date, last_month_date) : 1;
+							counts[to_account] += count * trans->quantity();
+							values[to_account] += v * count;
+							if(month_index2 >= 0) month_values[to_account][month_index2] += v * count;
+							if(month_index2 >= 0) month_costs[month_index2] += v * count;
+							costs_count += count * trans->quantity();
+							costs += v * count;
+							if(b_tags) {
+								for(int i = 0; i < trans->tagsCount(true); i++) {
+									tag_values[to_account][trans->getTag(i, true)] += v * count;
+									tag_costs[trans->getTag(i, true)] += v * count;
 								}
-							} else if(to_account->type() == ACCOUNT_TYPE_INCOMES) {
-								int count = strans->recurrence() ? strans->recurrence()->countOccurrences(first_month_date, last_month_date) : 1;
-								counts[to_account] += count * trans->quantity();
-								values[to_account] -= v * count;
-								if(month_index2 >= 0) month_values[to_account][month_index2] -= v * count;
-								if(b_top && month_index2 >= 0) month_incomes[month_index2] -= v * count;
-								if(b_top) incomes_count += count * trans->quantity();
-								if(b_top) incomes -= v * count;
-								if(b_tags) {
-									for(int i = 0; i < trans->tagsCount(true); i++) {
-										tag_values[to_account][trans->getTag(i, true)] -= v * count;
-										if(b_top) tag_incomes[trans->getTag(i, true)] -= v * count;
-									}
+							}
+						} else if(to_account->type() == ACCOUNT_TYPE_INCOMES) {
+							int count = strans->recurrence() ? strans->recurrence()->countOccurrences(first_month_date, last_month_date) : 1;
+							counts[to_account] += count * trans->quantity();
+							values[to_account] -= v * count;
+							if(month_index2 >= 0) month_values[to_account][month_index2] -= v * count;
+							if(month_index2 >= 0) month_incomes[month_index2] -= v * count;
+							incomes_count += count * trans->quantity();
+							incomes -= v * count;
+							if(b_tags) {
+								for(int i = 0; i < trans->tagsCount(true); i++) {
+									tag_values[to_account][trans->getTag(i, true)] -= v * count;
+									tag_incomes[trans->getTag(i, true)] -= v * count;
 								}
 							}
 						}
-						if(b_top) break;
-						from_account = from_account->topAccount();
-						to_account = to_account->topAccount();
 					}
 				}
 				if(i_months > 0) {
@@ -1495,6 +1483,13 @@ void CategoriesComparisonReport::updateDisplay() {
 			split_i = 0;
 		}
 	}
+	if(!current_account && include_subs) {
+		//values were only added to the category of each transaction, add subcategory values to the parent categories
+		budget->rollUpCategoryValues(values);
+		budget->rollUpCategoryValues(counts);
+		if(i_months > 0) budget->rollUpCategoryValues(month_values);
+		if(b_tags) budget->rollUpCategoryValues(tag_values);
+	}
 	if(current_account && include_subs) {
 		if(type == ACCOUNT_TYPE_EXPENSES) {
 			value = costs - incomes;
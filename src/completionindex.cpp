@@ -0,0 +1,259 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Hanna Knutsson                                  *
+ *   hanna.knutsson@protonmail.com                                         *
+ *                                                                         *
+ *   This file is part of Eqonomize!.                                      *
+ *                                                                         *
+ *   Eqonomize! is free software: you can redistribute it and/or modify    *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Eqonomize! is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Eqonomize!. If not, see <http://www.gnu.org/licenses/>.    *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "completionindex.h"
+
+#include "completionmodel.h"
+#include "transaction.h"
+
+#include <algorithm>
+
+//number of recent transactions used for prediction
+#define PREDICTION_DEPTH 10
+
+bool date_less_than_transaction(const QDate &date, Transaction *trans) {
+	return date < trans->date();
+}
+bool transaction_less_than_date(Transaction *trans, const QDate &date) {
+	return trans->date() < date;
+}
+void insert_transaction(QVector<Transaction*> &v, Transaction *trans) {
+	v.insert(std::upper_bound(v.begin(), v.end(), trans->date(), date_less_than_transaction) - v.begin(), trans);
+}
+//date is the date of the transaction when it was inserted
+void remove_transaction(QVector<Transaction*> &v, Transaction *trans, const QDate &date) {
+	for(int i = std::lower_bound(v.begin(), v.end(), date, transaction_less_than_date) - v.begin(); i < v.count() && (v[i] == trans || v[i]->date() <= date); i++) {
+		if(v[i] == trans) {
+			v.remove(i);
+			return;
+		}
+	}
+	for(int i = v.count() - 1; i >= 0; i--) {
+		if(v[i] == trans) {
+			v.remove(i);
+			break;
+		}
+	}
+}
+Account *prediction_category(Transaction *trans) {
+	if(trans->type() == TRANSACTION_TYPE_INCOME) return trans->fromAccount();
+	return trans->toAccount();
+}
+Account *prediction_account(Transaction *trans) {
+	if(trans->type() == TRANSACTION_TYPE_INCOME) return trans->toAccount();
+	return trans->fromAccount();
+}
+bool same_prediction_group(Transaction *t1, Transaction *t2, bool by_description) {
+	if(by_description) return t1->description().compare(t2->description(), Qt::CaseInsensitive) == 0;
+	return prediction_category(t1) == prediction_category(t2);
+}
+//the group with the highest count among the last transactions wins, with ties resolved in favour of the most recent transaction
+Transaction *predict_transaction(const QVector<Transaction*> &v, bool by_description, Account **account) {
+	if(v.isEmpty()) return NULL;
+	int first = v.count() > PREDICTION_DEPTH ? v.count() - PREDICTION_DEPTH : 0;
+	Transaction *trans = NULL;
+	int best_count = 0;
+	for(int i = v.count() - 1; i >= first; i--) {
+		int c = 0;
+		for(int i2 = first; i2 < v.count(); i2++) {
+			if(same_prediction_group(v[i], v[i2], by_description)) c++;
+		}
+		if(c > best_count) {
+			trans = v[i];
+			best_count = c;
+		}
+	}
+	if(account) {
+		*account = prediction_account(trans);
+		best_count = 0;
+		for(int i = v.count() - 1; i >= first; i--) {
+			if(!same_prediction_group(v[i], trans, by_description)) continue;
+			int c = 0;
+			for(int i2 = first; i2 < v.count(); i2++) {
+				if(prediction_account(v[i2]) == prediction_account(v[i]) && same_prediction_group(v[i2], trans, by_description)) c++;
+			}
+			if(c > best_count) {
+				*account = prediction_account(v[i]);
+				best_count = c;
+			}
+		}
+	}
+	return trans;
+}
+
+int completion_source(int transaction_type) {
+	switch(transaction_type) {
+		case TRANSACTION_TYPE_EXPENSE: return COMPLETION_SOURCE_EXPENSES;
+		case TRANSACTION_TYPE_INCOME: return COMPLETION_SOURCE_INCOMES;
+		case TRANSACTION_TYPE_TRANSFER: return COMPLETION_SOURCE_TRANSFERS;
+	}
+	return -1;
+}
+
+CompletionIndex::CompletionIndex() : b_changed(false) {}
+
+void CompletionIndex::clear() {
+	for(int source = 0; source < COMPLETION_SOURCES; source++) {
+		for(int field = 0; field < COMPLETION_FIELDS; field++) {
+			entries[source][field].clear();
+			v_keys[source][field].clear();
+		}
+		category_transactions[source].clear();
+	}
+	records.clear();
+	b_changed = true;
+}
+void CompletionIndex::addText(int source, int field, const QString &text, Transactions *transs, Transaction *trans, bool generated) {
+	QString key = text.toLower();
+	QHash<QString, CompletionEntry>::iterator it = entries[source][field].find(key);
+	if(it == entries[source][field].end()) {
+		it = entries[source][field].insert(key, CompletionEntry());
+		it->text = text;
+		it->count = 0;
+		it->generated = 0;
+		it->last_date = transs->date();
+		QVector<QString> &v = v_keys[source][field];
+		v.insert(std::lower_bound(v.begin(), v.end(), key) - v.begin(), key);
+		b_changed = true;
+	} else if(transs->date() >= it->last_date) {
+		it->last_date = transs->date();
+		if(it->text != text) {
+			it->text = text;
+			b_changed = true;
+		}
+	}
+	it->count++;
+	if(generated) it->generated++;
+	else if(trans) insert_transaction(it->transactions, trans);
+}
+void CompletionIndex::removeText(int source, int field, const QString &key, Transaction *trans, const QDate &date, bool generated) {
+	QHash<QString, CompletionEntry>::iterator it = entries[source][field].find(key);
+	if(it == entries[source][field].end()) return;
+	it->count--;
+	if(generated) it->generated--;
+	else if(trans) remove_transaction(it->transactions, trans, date);
+	if(it->count > 0) return;
+	entries[source][field].erase(it);
+	QVector<QString> &v = v_keys[source][field];
+	QVector<QString>::iterator vit = std::lower_bound(v.begin(), v.end(), key);
+	if(vit != v.end() && *vit == key) v.erase(vit);
+	b_changed = true;
+}
+void CompletionIndex::updateTransaction(Transactions *transs) {
+	removeTransaction(transs);
+	CompletionRecord r;
+	r.generated = false;
+	r.category = NULL;
+	r.trans = NULL;
+	//scheduled transactions are indexed with the texts of their transaction
+	Transactions *ttranss = transs;
+	if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SCHEDULE) {
+		ttranss = ((ScheduledTransaction*) transs)->transaction();
+		if(!ttranss) return;
+	}
+	if(ttranss->generaltype() == GENERAL_TRANSACTION_TYPE_SINGLE) {
+		Transaction *trans = (Transaction*) ttranss;
+		r.trans = trans;
+		r.date = trans->date();
+		switch(trans->type()) {
+			case TRANSACTION_TYPE_EXPENSE: {
+				r.source = COMPLETION_SOURCE_EXPENSES;
+				r.payee = ((Expense*) trans)->payee();
+				break;
+			}
+			case TRANSACTION_TYPE_INCOME: {
+				if(((Income*) trans)->security()) return;
+				r.source = COMPLETION_SOURCE_INCOMES;
+				r.payee = ((Income*) trans)->payer();
+				break;
+			}
+			case TRANSACTION_TYPE_TRANSFER: {
+				r.source = COMPLETION_SOURCE_TRANSFERS;
+				break;
+			}
+			default: {return;}
+		}
+		r.generated = (trans->subtype() == TRANSACTION_SUBTYPE_DEBT_FEE || trans->subtype() == TRANSACTION_SUBTYPE_DEBT_INTEREST || trans->subtype() == TRANSACTION_SUBTYPE_DEBT_REDUCTION);
+		if(!r.generated && r.source != COMPLETION_SOURCE_TRANSFERS) {
+			r.category = prediction_category(trans);
+			insert_transaction(category_transactions[r.source][r.category], trans);
+		}
+	} else if(ttranss->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT && ((SplitTransaction*) ttranss)->type() == SPLIT_TRANSACTION_TYPE_MULTIPLE_ITEMS) {
+		r.source = COMPLETION_SOURCE_SPLITS;
+	} else {
+		return;
+	}
+	r.description = ttranss->description();
+	if(r.description.isEmpty() && r.payee.isEmpty() && !r.category) return;
+	if(!r.description.isEmpty()) addText(r.source, COMPLETION_FIELD_DESCRIPTION, r.description, transs, r.trans, r.generated);
+	if(!r.payee.isEmpty()) addText(r.source, COMPLETION_FIELD_PAYEE, r.payee, transs, r.trans, r.generated);
+	r.description = r.description.toLower();
+	r.payee = r.payee.toLower();
+	records[transs] = r;
+	notifyModels();
+}
+void CompletionIndex::removeTransaction(Transactions *transs) {
+	QHash<Transactions*, CompletionRecord>::iterator it = records.find(transs);
+	if(it == records.end()) return;
+	if(!it->description.isEmpty()) removeText(it->source, COMPLETION_FIELD_DESCRIPTION, it->description, it->trans, it->date, it->generated);
+	if(!it->payee.isEmpty()) removeText(it->source, COMPLETION_FIELD_PAYEE, it->payee, it->trans, it->date, it->generated);
+	if(it->category) {
+		QHash<Account*, QVector<Transaction*> >::iterator cit = category_transactions[it->source].find(it->category);
+		if(cit != category_transactions[it->source].end()) {
+			remove_transaction(cit.value(), it->trans, it->date);
+			if(cit->isEmpty()) category_transactions[it->source].erase(cit);
+		}
+	}
+	records.erase(it);
+	notifyModels();
+}
+const QVector<QString> &CompletionIndex::keys(int source, int field) const {
+	return v_keys[source][field];
+}
+const CompletionEntry *CompletionIndex::entry(int source, int field, const QString &key) const {
+	QHash<QString, CompletionEntry>::const_iterator it = entries[source][field].constFind(key);
+	if(it == entries[source][field].constEnd()) return NULL;
+	return &it.value();
+}
+Transaction *CompletionIndex::predictTransaction(int source, int field, const QString &text, Account **account) const {
+	const CompletionEntry *e = entry(source, field, text.toLower());
+	if(!e) return NULL;
+	return predict_transaction(e->transactions, false, account);
+}
+Transaction *CompletionIndex::predictTransaction(int source, Account *category, Account **account) const {
+	QHash<Account*, QVector<Transaction*> >::const_iterator it = category_transactions[source].constFind(category);
+	if(it == category_transactions[source].constEnd()) return NULL;
+	return predict_transaction(it.value(), true, account);
+}
+void CompletionIndex::addModel(CompletionModel *model) {
+	models << model;
+}
+void CompletionIndex::removeModel(CompletionModel *model) {
+	models.removeAll(model);
+}
+void CompletionIndex::notifyModels() {
+	if(!b_changed) return;
+	b_changed = false;
+	for(int i = 0; i < models.count(); i++) models[i]->refresh();
+}
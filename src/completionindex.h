@@ -0,0 +1,112 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Hanna Knutsson                                  *
+ *   hanna.knutsson@protonmail.com                                         *
+ *                                                                         *
+ *   This file is part of Eqonomize!.                                      *
+ *                                                                         *
+ *   Eqonomize! is free software: you can redistribute it and/or modify    *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Eqonomize! is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Eqonomize!. If not, see <http://www.gnu.org/licenses/>.    *
+ ***************************************************************************/
+
+#ifndef COMPLETION_INDEX_H
+#define COMPLETION_INDEX_H
+
+#include <QDate>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+class Account;
+class Transaction;
+class Transactions;
+class CompletionModel;
+
+#define COMPLETION_SOURCES 4
+#define COMPLETION_FIELDS 2
+
+typedef enum {
+	COMPLETION_SOURCE_EXPENSES,
+	COMPLETION_SOURCE_INCOMES,
+	COMPLETION_SOURCE_TRANSFERS,
+	COMPLETION_SOURCE_SPLITS
+} CompletionSource;
+
+typedef enum {
+	COMPLETION_FIELD_DESCRIPTION,
+	COMPLETION_FIELD_PAYEE
+} CompletionField;
+
+//completion source for a transaction type, or -1
+int completion_source(int transaction_type);
+
+struct CompletionEntry {
+	//text with the case used by the most recent transaction
+	QString text;
+	//number of transactions using the text, and how many of those have a description generated from a loan name
+	int count, generated;
+	QDate last_date;
+	//transactions, excluding loan payments and split transactions, sorted by date, including the transactions of schedules
+	QVector<Transaction*> transactions;
+};
+
+//descriptions and payees/payers of expenses, incomes (excluding dividends), transfers and split transactions with multiple items, including scheduled transactions, keyed by lower case text, and transactions of each category, used for completion and prediction of default values
+class CompletionIndex {
+
+	public:
+
+		CompletionIndex();
+
+		void clear();
+		//adds the transaction, or reindexes it if already added
+		void updateTransaction(Transactions *transs);
+		void removeTransaction(Transactions *transs);
+		//sorted lower case texts
+		const QVector<QString> &keys(int source, int field) const;
+		const CompletionEntry *entry(int source, int field, const QString &key) const;
+
+		//returns the most recent transaction with the text, among the last transactions with the text, with the most commonly used category (the to account for transfers) and, in account, the most commonly used assets account (from account for expenses and transfers) with that category
+		Transaction *predictTransaction(int source, int field, const QString &text, Account **account = NULL) const;
+		//returns the most recent transaction of the category with the most common description, among the last transactions of the category, and the most commonly used assets account
+		Transaction *predictTransaction(int source, Account *category, Account **account = NULL) const;
+
+		//models are notified when texts are added or removed, or when the case of a text changes
+		void addModel(CompletionModel *model);
+		void removeModel(CompletionModel *model);
+		void notifyModels();
+
+	protected:
+
+		struct CompletionRecord {
+			int source;
+			QString description, payee;
+			Account *category;
+			//transaction added to the transaction lists, if any, and its date when added (used to find it again)
+			Transaction *trans;
+			QDate date;
+			bool generated;
+		};
+
+		QHash<QString, CompletionEntry> entries[COMPLETION_SOURCES][COMPLETION_FIELDS];
+		QVector<QString> v_keys[COMPLETION_SOURCES][COMPLETION_FIELDS];
+		QHash<Account*, QVector<Transaction*> > category_transactions[COMPLETION_SOURCES];
+		QHash<Transactions*, CompletionRecord> records;
+		QList<CompletionModel*> models;
+		bool b_changed;
+
+		void addText(int source, int field, const QString &text, Transactions *transs, Transaction *trans, bool generated);
+		void removeText(int source, int field, const QString &key, Transaction *trans, const QDate &date, bool generated);
+
+};
+
+#endif
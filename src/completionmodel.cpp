@@ -0,0 +1,123 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Hanna Knutsson                                  *
+ *   hanna.knutsson@protonmail.com                                         *
+ *                                                                         *
+ *   This file is part of Eqonomize!.                                      *
+ *                                                                         *
+ *   Eqonomize! is free software: you can redistribute it and/or modify    *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Eqonomize! is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Eqonomize!. If not, see <http://www.gnu.org/licenses/>.    *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "completionmodel.h"
+
+#include "budget.h"
+#include "completionindex.h"
+
+#include <QPair>
+#include <QTimer>
+
+#include <algorithm>
+
+CompletionModel::CompletionModel(Budget *budg, QObject *parent) : QAbstractListModel(parent), budget(budg), b_tags(false), b_refresh_queued(false) {
+	budget->addCompletionModel(this);
+}
+CompletionModel::~CompletionModel() {
+	budget->removeCompletionModel(this);
+}
+void CompletionModel::addSource(int source, int field, bool include_generated) {
+	v_sources << source;
+	v_fields << field;
+	v_generated << include_generated;
+	refresh();
+}
+void CompletionModel::setIncludeTags(bool b) {
+	b_tags = b;
+	refresh();
+}
+int CompletionModel::rowCount(const QModelIndex &parent) const {
+	if(parent.isValid()) return 0;
+	return v_texts.count();
+}
+QVariant CompletionModel::data(const QModelIndex &index, int role) const {
+	if(!index.isValid() || index.row() >= v_texts.count()) return QVariant();
+	if(role == Qt::DisplayRole || role == Qt::EditRole) return v_texts[index.row()];
+	return QVariant();
+}
+void CompletionModel::refresh() {
+	if(b_refresh_queued) return;
+	b_refresh_queued = true;
+	QTimer::singleShot(0, this, SLOT(updateCompletions()));
+}
+void CompletionModel::merge(const QVector<QString> &keys, const QVector<QString> &texts) {
+	if(v_keys.isEmpty()) {
+		v_keys = keys;
+		v_texts = texts;
+		return;
+	}
+	QVector<QString> new_keys, new_texts;
+	new_keys.reserve(v_keys.count() + keys.count());
+	new_texts.reserve(v_keys.count() + keys.count());
+	int i = 0, i2 = 0;
+	while(i < v_keys.count() || i2 < keys.count()) {
+		if(i2 >= keys.count() || (i < v_keys.count() && v_keys[i] < keys[i2])) {
+			new_keys << v_keys[i];
+			new_texts << v_texts[i];
+			i++;
+		} else {
+			if(i < v_keys.count() && v_keys[i] == keys[i2]) i++;
+			new_keys << keys[i2];
+			new_texts << texts[i2];
+			i2++;
+		}
+	}
+	v_keys = new_keys;
+	v_texts = new_texts;
+}
+void CompletionModel::updateCompletions() {
+	//the index is built, if necessary, before the refresh flag is reset, so that the notifications from the build do not queue another update
+	const CompletionIndex &index = budget->completionIndex();
+	b_refresh_queued = false;
+	beginResetModel();
+	v_keys.clear();
+	v_texts.clear();
+	for(int i = 0; i < v_sources.count(); i++) {
+		const QVector<QString> &skeys = index.keys(v_sources[i], v_fields[i]);
+		QVector<QString> keys, texts;
+		keys.reserve(skeys.count());
+		texts.reserve(skeys.count());
+		for(int i2 = 0; i2 < skeys.count(); i2++) {
+			const CompletionEntry *e = index.entry(v_sources[i], v_fields[i], skeys[i2]);
+			if(!v_generated[i] && e->generated == e->count) continue;
+			keys << skeys[i2];
+			texts << e->text;
+		}
+		merge(keys, texts);
+	}
+	if(b_tags) {
+		QVector<QPair<QString, QString> > tags;
+		for(int i = 0; i < budget->tags.count(); i++) tags << qMakePair(budget->tags[i].toLower(), budget->tags[i]);
+		std::sort(tags.begin(), tags.end());
+		QVector<QString> keys, texts;
+		for(int i = 0; i < tags.count(); i++) {
+			if(!keys.isEmpty() && keys.last() == tags[i].first) continue;
+			keys << tags[i].first;
+			texts << tags[i].second;
+		}
+		merge(keys, texts);
+	}
+	endResetModel();
+}
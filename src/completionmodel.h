@@ -0,0 +1,66 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Hanna Knutsson                                  *
+ *   hanna.knutsson@protonmail.com                                         *
+ *                                                                         *
+ *   This file is part of Eqonomize!.                                      *
+ *                                                                         *
+ *   Eqonomize! is free software: you can redistribute it and/or modify    *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Eqonomize! is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Eqonomize!. If not, see <http://www.gnu.org/licenses/>.    *
+ ***************************************************************************/
+
+#ifndef COMPLETION_MODEL_H
+#define COMPLETION_MODEL_H
+
+#include <QAbstractListModel>
+#include <QString>
+#include <QVector>
+
+class Budget;
+
+//completion texts from the shared completion index of the budget, sorted case insensitively (for QCompleter::CaseInsensitivelySortedModel)
+class CompletionModel : public QAbstractListModel {
+
+	Q_OBJECT
+
+	public:
+
+		CompletionModel(Budget *budg, QObject *parent = NULL);
+		~CompletionModel();
+
+		//include_generated: include descriptions that are only used by loan payments (generated from the loan name)
+		void addSource(int source, int field, bool include_generated = true);
+		void setIncludeTags(bool b);
+
+		int rowCount(const QModelIndex &parent = QModelIndex()) const;
+		QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+
+		//schedules an update of the model
+		void refresh();
+
+	protected:
+
+		Budget *budget;
+		QVector<int> v_sources, v_fields;
+		QVector<bool> v_generated;
+		bool b_tags, b_refresh_queued;
+		QVector<QString> v_keys, v_texts;
+
+		void merge(const QVector<QString> &keys, const QVector<QString> &texts);
+
+	protected slots:
+
+		void updateCompletions();
+
+};
+
+#endif
@@ -78,7 +78,6 @@ EditScheduledTransactionDialog::EditScheduledTransactionDialog(bool extra_parame
 		}
 	}
 	transactionEditWidget->updateAccounts(NULL, NULL, true);
-	transactionEditWidget->transactionsReset();
 	if(account) transactionEditWidget->setAccount(account);
 	recurrenceEditWidget = new RecurrenceEditWidget(transactionEditWidget->date(), budget);
 	tabs->addTab(recurrenceEditWidget, tr("Recurrence"));
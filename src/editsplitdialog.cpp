@@ -40,7 +40,6 @@
 #include <QKeyEvent>
 #include <QRadioButton>
 #include <QCompleter>
-#include <QStandardItemModel>
 #include <QStandardPaths>
 #include <QDirModel>
 #include <QFileDialog>
@@ -48,6 +47,7 @@
 
 #include "accountcombobox.h"
 #include "budget.h"
+#include "completionmodel.h"
 #include "editsplitdialog.h"
 #include "editaccountdialogs.h"
 #include "eqonomize.h"
@@ -283,25 +283,11 @@ EditMultiItemWidget::EditMultiItemWidget(Budget *budg, QWidget *parent, AssetsAc
 	grid->addWidget(descriptionEdit, 0, 1);
 	descriptionEdit->setFocus();
 	descriptionEdit->setCompleter(new QCompleter(this));
-	descriptionEdit->completer()->setModel(new QStandardItemModel(this));
+	CompletionModel *descriptionModel = new CompletionModel(budget, this);
+	descriptionModel->addSource(COMPLETION_SOURCE_SPLITS, COMPLETION_FIELD_DESCRIPTION);
+	descriptionEdit->completer()->setModel(descriptionModel);
 	descriptionEdit->completer()->setModelSorting(QCompleter::CaseInsensitivelySortedModel);
 	descriptionEdit->completer()->setCaseSensitivity(Qt::CaseInsensitive);
-	
-	QStringList descr_list;
-	QString descr;
-	for(SplitTransactionList<SplitTransaction*>::const_iterator it = budget->splitTransactions.constEnd(); it != budget->splitTransactions.constBegin();) {
-		--it;
-		SplitTransaction *split = *it;
-		descr = split->description();
-		if(split->type() == SPLIT_TRANSACTION_TYPE_MULTIPLE_ITEMS && !descr.isEmpty() && !descr_list.contains(descr, Qt::CaseInsensitive)) {
-			QList<QStandardItem*> row;
-			row << new QStandardItem(descr);
-			row << new QStandardItem(descr.toLower());
-			((QStandardItemModel*) descriptionEdit->completer()->model())->appendRow(row);
-			descr_list << descr.toLower();
-		}
-	}
-	((QStandardItemModel*) descriptionEdit->completer()->model())->sort(1);
 
 	grid->addWidget(new QLabel(tr("Date:")), 1, 0);
 	dateEdit = new EqonomizeDateEdit(this);
@@ -319,37 +305,12 @@ EditMultiItemWidget::EditMultiItemWidget(Budget *budg, QWidget *parent, AssetsAc
 		payeeEdit = new QLineEdit();
 		grid->addWidget(payeeEdit, 3, 1);
 		payeeEdit->setCompleter(new QCompleter(this));
-		payeeEdit->completer()->setModel(new QStandardItemModel(this));
+		CompletionModel *payeeModel = new CompletionModel(budget, this);
+		payeeModel->addSource(COMPLETION_SOURCE_EXPENSES, COMPLETION_FIELD_PAYEE, false);
+		payeeModel->addSource(COMPLETION_SOURCE_INCOMES, COMPLETION_FIELD_PAYEE);
+		payeeEdit->completer()->setModel(payeeModel);
 		payeeEdit->completer()->setModelSorting(QCompleter::CaseInsensitivelySortedModel);
 		payeeEdit->completer()->setCaseSensitivity(Qt::CaseInsensitive);
-		QStringList payee_list;
-		for(TransactionList<Expense*>::const_iterator it = budget->expenses.constEnd(); it != budget->expenses.constBegin();) {
-			--it;
-			Expense *expense = *it;
-			if(expense->subtype() != TRANSACTION_SUBTYPE_DEBT_FEE && expense->subtype() != TRANSACTION_SUBTYPE_DEBT_INTEREST) {
-				if(!expense->payee().isEmpty() && !payee_list.contains(expense->payee(), Qt::CaseInsensitive)) {
-					QList<QStandardItem*> row;
-					row << new QStandardItem(expense->payee());
-					row << new QStandardItem(expense->payee().toLower());
-					((QStandardItemModel*) payeeEdit->completer()->model())->appendRow(row);
-					payee_list << expense->payee().toLower();
-				}
-			}
-		}
-		for(TransactionList<Income*>::const_iterator it = budget->incomes.constEnd(); it != budget->incomes.constBegin();) {
-			--it;
-			Income *income = *it;
-			if(!income->security()) {
-				if(!income->payer().isEmpty() && !payee_list.contains(income->payer(), Qt::CaseInsensitive)) {
-					QList<QStandardItem*> row;
-					row << new QStandardItem(income->payer());
-					row << new QStandardItem(income->payer().toLower());
-					((QStandardItemModel*) payeeEdit->completer()->model())->appendRow(row);
-					payee_list << income->payer().toLower();
-				}
-			}
-		}
-		((QStandardItemModel*) payeeEdit->completer()->model())->sort(1);
 	} else {
 		payeeEdit = NULL;
 	}
@@ -105,6 +105,7 @@
 #include "ledgerdialog.h"
 #include "overtimechart.h"
 #include "overtimereport.h"
+#include "portfolio.h"
 #include "qifimportexport.h"
 #include "recurrence.h"
 #include "recurrenceeditwidget.h"
@@ -229,6 +230,9 @@ void setColumnStrlenWidth(QTreeWidget *w, int i, int l) {
 	setColumnTextWidth(w, i, QString(l, 'h'));
 }
 
+bool schedule_is_due(ScheduledTransaction *strans, const QTime &confirm_time) {
+	return strans->firstOccurrence() < QDate::currentDate() || (QTime::currentTime() >= confirm_time && strans->firstOccurrence() == QDate::currentDate());
+}
 void open_file_list(QString url) {
 	if(url.isEmpty()) return;
 	if(!url.contains(",")) {
@@ -1055,12 +1059,11 @@ void EditQuotationsDialog::setSecurity(Security *sec) {
 	if(items.isEmpty()) quotationsView->setMinimumWidth(quotationsView->columnWidth(0) + quotationsView->columnWidth(1) + 10);
 }
 void EditQuotationsDialog::modifyQuotations() {
-	security->quotations.clear();
+	security->clearQuotations();
 	QTreeWidgetItemIterator it(quotationsView);
 	QuotationListViewItem *i = (QuotationListViewItem*) *it;
 	while(i) {
-		security->quotations[i->date] = i->value;
-		security->quotations_auto[i->date] = false;
+		security->setQuotation(i->date, i->value);
 		++it;
 		i = (QuotationListViewItem*) *it;
 	}
@@ -1855,20 +1858,16 @@ void ConfirmScheduleDialog::updateTransactions() {
 	settings.beginGroup("GeneralOptions");
 	QTime confirm_time = settings.value("scheduleConfirmationTime", QTime(18, 0)).toTime();
 	settings.endGroup();
-	for(ScheduledTransactionList<ScheduledTransaction*>::iterator it = budget->scheduledTransactions.begin(); it != budget->scheduledTransactions.end();) {
-		ScheduledTransaction *strans = *it;
-		if(strans->firstOccurrence() < QDate::currentDate() || (QTime::currentTime() >= confirm_time && strans->firstOccurrence() == QDate::currentDate())) {
-			bool b = strans->isOneTimeTransaction();
-			Transactions *trans = strans->realize(strans->firstOccurrence());
-			if(trans) {
-				new ConfirmScheduleListViewItem(transactionsView, trans);
-			}
-			if(b) budget->removeScheduledTransaction(strans);
-			else strans->setModified();
-			it = budget->scheduledTransactions.begin();
-		} else {
-			++it;
+	//scheduled transactions are sorted by next occurrence, so only the due schedules at the front are visited
+	while(!budget->scheduledTransactions.isEmpty() && schedule_is_due(budget->scheduledTransactions.first(), confirm_time)) {
+		ScheduledTransaction *strans = budget->scheduledTransactions.first();
+		bool b = strans->isOneTimeTransaction();
+		Transactions *trans = strans->realize(strans->firstOccurrence());
+		if(trans) {
+			new ConfirmScheduleListViewItem(transactionsView, trans);
 		}
+		if(b) budget->removeScheduledTransaction(strans);
+		else strans->setModified();
 	}
 	transactionsView->setSortingEnabled(true);
 	QTreeWidgetItemIterator qit(transactionsView);
@@ -2292,6 +2291,8 @@ class AccountsListView : public EqonomizeTreeWidget {
 Eqonomize::Eqonomize() : QMainWindow() {
 
 	in_batch_edit = false;
+	b_value_display_queued = false;
+	b_month_values_valid = false;
 	
 	clicked_item = NULL;
 
@@ -3148,19 +3149,19 @@ void Eqonomize::budgetChanged(double value) {
 	if(account->type() == ACCOUNT_TYPE_ASSETS) return;
 	CategoryAccount *ca = (CategoryAccount*) account;
 	QDate month = budgetMonthEdit->date();
-	ca->mbudgets[month] = value;
+	ca->setMonthlyBudget(month, value);
 	for(AccountList<IncomesAccount*>::const_iterator it = budget->incomesAccounts.constBegin(); it != budget->incomesAccounts.constEnd(); ++it) {
 		ca = *it;
 		if(!ca->mbudgets.contains(month)) {
 			value = ca->monthlyBudget(month);
-			ca->mbudgets[month] = value;
+			ca->setMonthlyBudget(month, value);
 		}
 	}
 	for(AccountList<ExpensesAccount*>::const_iterator it = budget->expensesAccounts.constBegin(); it != budget->expensesAccounts.constEnd(); ++it) {
 		ca = *it;
 		if(!ca->mbudgets.contains(month)) {
 			value = ca->monthlyBudget(month);
-			ca->mbudgets[month] = value;
+			ca->setMonthlyBudget(month, value);
 		}
 	}
 	setModified(true);
@@ -3173,20 +3174,20 @@ void Eqonomize::budgetToggled(bool b) {
 	if(account->type() == ACCOUNT_TYPE_ASSETS) return;
 	CategoryAccount *ca = (CategoryAccount*) account;
 	QDate month = budgetMonthEdit->date();
-	if(b) ca->mbudgets[month] = budgetEdit->value();
-	else ca->mbudgets[month] = -1;
+	if(b) ca->setMonthlyBudget(month, budgetEdit->value());
+	else ca->setMonthlyBudget(month, -1);
 	for(AccountList<IncomesAccount*>::const_iterator it = budget->incomesAccounts.constBegin(); it != budget->incomesAccounts.constEnd(); ++it) {
 		ca = *it;
 		if(!ca->mbudgets.contains(month)) {
 			double value = ca->monthlyBudget(month);
-			ca->mbudgets[month] = value;
+			ca->setMonthlyBudget(month, value);
 		}
 	}
 	for(AccountList<ExpensesAccount*>::const_iterator it = budget->expensesAccounts.constBegin(); it != budget->expensesAccounts.constEnd(); ++it) {
 		ca = *it;
 		if(!ca->mbudgets.contains(month)) {
 			double value = ca->monthlyBudget(month);
-			ca->mbudgets[month] = value;
+			ca->setMonthlyBudget(month, value);
 		}
 	}
 	setModified(true);
@@ -3529,6 +3530,12 @@ void Eqonomize::popupSecuritiesMenu(const QPoint &p) {
 	}
 	securitiesPopupMenu->popup(securitiesView->viewport()->mapToGlobal(p));
 }
+void Eqonomize::updateSecurityToolTips(QTreeWidgetItem *i, Security *security, Currency *cur) {
+	QDate rate_from = securities_from_date;
+	if(!securitiesPeriodFromButton->isChecked()) rate_from = security->quotations.isEmpty() ? securities_to_date : security->quotations.firstKey();
+	i->setToolTip(6, tr("Money-weighted return: %1\nTime-weighted return: %2").arg(budget->formatValue(security->moneyWeightedRate(rate_from, securities_to_date) * 100, 2) + "%").arg(budget->formatValue(security->timeWeightedRate(rate_from, securities_to_date) * 100, 2) + "%"));
+	i->setToolTip(5, tr("Realized profit: %1\nUnrealized profit: %2").arg(cur->formatValue(security->realizedProfit(securities_to_date))).arg(cur->formatValue(security->unrealizedProfit(securities_to_date))));
+}
 void Eqonomize::appendSecurity(Security *security) {
 	double value = 0.0, cost = 0.0, rate = 0.0, profit = 0.0, quotation = 0.0, shares = 0.0;
 	value = security->value(securities_to_date, 1);
@@ -3548,6 +3555,7 @@ void Eqonomize::appendSecurity(Security *security) {
 	SecurityListViewItem *i = new SecurityListViewItem(security, security->name(), cur->formatValue(value), budget->formatValue(shares, security->decimals()), cur->formatValue(quotation, security->quotationDecimals()), cur->formatValue(cost), cur->formatValue(profit), budget->formatValue(rate * 100, 2) + "%", QString(), security->account()->name());
 	i->rate = rate;
 	i->shares = shares;
+	updateSecurityToolTips(i, security, cur);
 	if(cur != budget->defaultCurrency()) {
 		i->sprofit = security->profit(securities_to_date, true, false, budget->defaultCurrency());
 		i->scost = security->cost(securities_to_date, false, budget->defaultCurrency());
@@ -3589,6 +3597,7 @@ void Eqonomize::appendSecurity(Security *security) {
 	securitiesView->setSortingEnabled(true);
 }
 void Eqonomize::updateSecurity(Security *security) {
+	security->transactionsModified();
 	QTreeWidgetItemIterator it(securitiesView);
 	QTreeWidgetItem *i = *it;
 	while(i != NULL) {
@@ -3625,6 +3634,7 @@ void Eqonomize::updateSecurity(QTreeWidgetItem *i_pre) {
 	}
 	i->rate = rate;
 	i->shares = shares;
+	updateSecurityToolTips(i, security, cur);
 	if(cur != budget->defaultCurrency()) {
 		i->sprofit = security->profit(securities_to_date, true, false, budget->defaultCurrency());
 		i->scost = security->cost(securities_to_date, false, budget->defaultCurrency());
@@ -5070,7 +5080,7 @@ void Eqonomize::accountsPeriodToChanged(const QDate &date) {
 		return;
 	}
 	to_date = date;
-	filterAccounts();
+	filterAccountsPeriod();
 }
 void Eqonomize::accountsPeriodFromChanged(const QDate &date) {
 	bool error = false;
@@ -5098,7 +5108,7 @@ void Eqonomize::accountsPeriodFromChanged(const QDate &date) {
 		return;
 	}
 	from_date = date;
-	if(accountsPeriodFromButton->isChecked()) filterAccounts();
+	if(accountsPeriodFromButton->isChecked()) filterAccountsPeriod();
 }
 void Eqonomize::prevMonth() {
 	accountsPeriodFromEdit->blockSignals(true);
@@ -5108,7 +5118,7 @@ void Eqonomize::prevMonth() {
 	accountsPeriodToEdit->setDate(to_date);
 	accountsPeriodFromEdit->blockSignals(false);
 	accountsPeriodToEdit->blockSignals(false);
-	filterAccounts();
+	filterAccountsPeriod();
 }
 void Eqonomize::nextMonth() {
 	accountsPeriodFromEdit->blockSignals(true);
@@ -5118,7 +5128,7 @@ void Eqonomize::nextMonth() {
 	accountsPeriodToEdit->setDate(to_date);
 	accountsPeriodFromEdit->blockSignals(false);
 	accountsPeriodToEdit->blockSignals(false);
-	filterAccounts();
+	filterAccountsPeriod();
 }
 void Eqonomize::currentMonth() {
 	accountsPeriodFromEdit->blockSignals(true);
@@ -5130,7 +5140,7 @@ void Eqonomize::currentMonth() {
 	accountsPeriodToEdit->setDate(to_date);
 	accountsPeriodFromEdit->blockSignals(false);
 	accountsPeriodToEdit->blockSignals(false);
-	filterAccounts();
+	filterAccountsPeriod();
 }
 void Eqonomize::prevYear() {
 	accountsPeriodFromEdit->blockSignals(true);
@@ -5140,7 +5150,7 @@ void Eqonomize::prevYear() {
 	accountsPeriodToEdit->setDate(to_date);
 	accountsPeriodFromEdit->blockSignals(false);
 	accountsPeriodToEdit->blockSignals(false);
-	filterAccounts();
+	filterAccountsPeriod();
 }
 void Eqonomize::nextYear() {
 	accountsPeriodFromEdit->blockSignals(true);
@@ -5150,7 +5160,7 @@ void Eqonomize::nextYear() {
 	accountsPeriodToEdit->setDate(to_date);
 	accountsPeriodFromEdit->blockSignals(false);
 	accountsPeriodToEdit->blockSignals(false);
-	filterAccounts();
+	filterAccountsPeriod();
 }
 void Eqonomize::currentYear() {
 	accountsPeriodFromEdit->blockSignals(true);
@@ -5162,7 +5172,7 @@ void Eqonomize::currentYear() {
 	accountsPeriodToEdit->setDate(to_date);
 	accountsPeriodFromEdit->blockSignals(false);
 	accountsPeriodToEdit->blockSignals(false);
-	filterAccounts();
+	filterAccountsPeriod();
 }
 
 void Eqonomize::securitiesPeriodToChanged(const QDate &date) {
@@ -5303,8 +5313,16 @@ void Eqonomize::setModified(bool has_been_modified) {
 		auto_save_timeout = true;
 	}
 }
+void Eqonomize::clearTransactionLists() {
+	//the transactions of the budget are about to be freed; no list may refer to them while the event loop runs
+	expensesWidget->budgetCleared();
+	incomesWidget->budgetCleared();
+	transfersWidget->budgetCleared();
+	emit transactionsCleared();
+}
 void Eqonomize::createDefaultBudget() {
 	if(!askSave()) return;
+	clearTransactionLists();
 	budget->clear();
 	bool new_currency = false, adjust_contents = false;
 	if(current_url.isEmpty()) {
@@ -5473,8 +5491,12 @@ bool Eqonomize::openURL(const QUrl& url, bool merge) {
 
 	QString errors;
 	bool new_currency = false;
+	clearTransactionLists();
 	QString error = budget->loadFile(url.toLocalFile(), errors, &new_currency, merge, rename_duplicate_accounts, rename_duplicate_categories, rename_duplicate_securities, ignore_duplicate_transactions);
 	if(!error.isNull()) {
+		reloadBudget();
+		emit accountsModified();
+		emit transactionsModified();
 		QMessageBox::critical(this, tr("Couldn't open file"), tr("Error loading %1: %2.").arg(url.toString()).arg(error));
 		return false;
 	}
@@ -5643,6 +5665,7 @@ void Eqonomize::cancelSync() {
 }
 void Eqonomize::sync(bool do_save, bool on_load, QWidget *parent) {
 	if(!parent) parent = this;
+	if(!budget->o_sync->isComplete()) return;
 	QProgressDialog *syncProgressDialog = new QProgressDialog(tr("Synchronizing…"), tr("Abort"), 0, 1, parent);
 	syncProgressDialog->setWindowModality(Qt::WindowModal);
 	syncProgressDialog->setMinimumDuration(200);
@@ -5651,7 +5674,12 @@ void Eqonomize::sync(bool do_save, bool on_load, QWidget *parent) {
 	syncProgressDialog->setValue(0);
 	QString error, errors;
 	int rev_bak = budget->o_sync->revision;
-	if(budget->sync(error, errors, true, on_load)) {
+	clearTransactionLists();
+	bool synced = budget->sync(error, errors, true, on_load);
+	reloadBudget();
+	emit accountsModified();
+	emit transactionsModified();
+	if(synced) {
 		syncProgressDialog->setValue(1);
 		syncProgressDialog->deleteLater();
 		if(!error.isEmpty()) QMessageBox::critical(parent, tr("Error synchronizing file"), tr("Error synchronizing %1: %2.").arg(current_url.toString()).arg(error));
@@ -5659,7 +5687,6 @@ void Eqonomize::sync(bool do_save, bool on_load, QWidget *parent) {
 		if(do_save) {
 			saveURL(current_url, false, false, parent);
 		}
-		reloadBudget();
 	} else {
 		syncProgressDialog->reset();
 		syncProgressDialog->deleteLater();
@@ -5687,7 +5714,11 @@ bool Eqonomize::saveURL(const QUrl& url, bool do_local_sync, bool do_cloud_sync,
 				switch(QMessageBox::question(parent, tr("Synchronize file?"), tr("The file has been modified by a different user or program. Do you wish to merge changes?"), QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel, QMessageBox::Yes)) {
 					case QMessageBox::Yes: {
 						QString errors;
+						clearTransactionLists();
 						error = budget->syncFile(url.toLocalFile(), errors);
+						reloadBudget();
+						emit accountsModified();
+						emit transactionsModified();
 						if(!error.isNull()) {
 							QMessageBox::critical(parent, tr("Couldn't open file"), tr("Error loading %1: %2.").arg(url.toString()).arg(error));
 							return false;
@@ -5696,7 +5727,6 @@ bool Eqonomize::saveURL(const QUrl& url, bool do_local_sync, bool do_cloud_sync,
 							QMessageBox::critical(parent, tr("Error"), errors);
 							return false;
 						}
-						reloadBudget();
 						break;
 					}
 					case QMessageBox::No: {break;}
@@ -5990,6 +6020,7 @@ void Eqonomize::cancelUpdateExchangeRates() {
 	updateExchangeRatesReply->abort();
 }
 void Eqonomize::currenciesModified() {
+	budget->exchangeRatesModified();
 	expensesWidget->updateFromAccounts();
 	incomesWidget->updateToAccounts();
 	transfersWidget->updateAccounts();
@@ -7368,6 +7399,7 @@ bool Eqonomize::crashRecovery(QUrl url) {
 		if(QMessageBox::question(this, tr("Crash Recovery"), tr("%1 exited unexpectedly before the file was saved and data was lost.\nDo you want to load the last auto-saved version of the file?").arg(qApp->applicationDisplayName()), QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes) {
 			QString errors;
 			bool new_currency = false;
+			clearTransactionLists();
 			QString error = budget->loadFile(autosaveFileName, errors, &new_currency);
 			if(!error.isNull()) {
 				QMessageBox::critical(this, tr("Couldn't open file"), tr("Error loading %1: %2.").arg(autosaveFileName).arg(error));
@@ -7570,6 +7602,7 @@ void Eqonomize::fileNew() {
 
 	if(!askSave()) return;
 
+	clearTransactionLists();
 	budget->clear();
 
 	bool new_currency = false;
@@ -7693,13 +7726,7 @@ bool Eqonomize::checkSchedule(bool update_display, QWidget *parent) {
 	settings.beginGroup("GeneralOptions");
 	QTime confirm_time = settings.value("scheduleConfirmationTime", QTime(18, 0)).toTime();
 	settings.endGroup();
-	for(ScheduledTransactionList<ScheduledTransaction*>::const_iterator it = budget->scheduledTransactions.constBegin(); it != budget->scheduledTransactions.constEnd(); ++it) {
-		ScheduledTransaction *strans = *it;
-		if(strans->firstOccurrence() < QDate::currentDate() || (QTime::currentTime() >= confirm_time && strans->firstOccurrence() == QDate::currentDate())) {
-			b = true;
-			break;
-		}
-	}
+	if(!budget->scheduledTransactions.isEmpty()) b = schedule_is_due(budget->scheduledTransactions.first(), confirm_time);
 	if(b) {
 		budget->setRecordNewAccounts(true);
 		budget->setRecordNewSecurities(true);
@@ -7746,6 +7773,7 @@ void Eqonomize::startBatchEdit() {
 void Eqonomize::endBatchEdit() {
 	if(in_batch_edit) {
 		in_batch_edit = false;
+		updateValueDisplay();
 		emit budgetUpdated();
 		emit transactionsModified();
 	}
@@ -8589,13 +8617,28 @@ void Eqonomize::deleteTag() {
 		if(QMessageBox::question(this, tr("Remove tag?"), tr("Do you wish to remove the tag \"%1\" from %n transaction(s)?", "", n).arg(tag), QMessageBox::Yes | QMessageBox::Cancel) != QMessageBox::Yes) return;
 		startBatchEdit();
 		for(TransactionList<Transaction*>::const_iterator it = budget->transactions.constBegin(); it != budget->transactions.constEnd(); ++it) {
-			if((*it)->removeTag(tag)) transactionModified(*it, *it);
+			if((*it)->hasTag(tag, false)) {
+				Transaction *oldtrans = (*it)->copy();
+				(*it)->removeTag(tag);
+				transactionModified(*it, oldtrans);
+				delete oldtrans;
+			}
 		}
 		for(TransactionList<SplitTransaction*>::const_iterator it = budget->splitTransactions.constBegin(); it != budget->splitTransactions.constEnd(); ++it) {
-			if((*it)->removeTag(tag)) transactionModified(*it, *it);
+			if((*it)->hasTag(tag, false)) {
+				SplitTransaction *oldtrans = (*it)->copy();
+				(*it)->removeTag(tag);
+				transactionModified(*it, oldtrans);
+				delete oldtrans;
+			}
 		}
 		for(TransactionList<ScheduledTransaction*>::const_iterator it = budget->scheduledTransactions.constBegin(); it != budget->scheduledTransactions.constEnd(); ++it) {
-			if((*it)->removeTag(tag)) transactionModified(*it, *it);
+			if((*it)->hasTag(tag, false)) {
+				ScheduledTransaction *oldtrans = (*it)->copy();
+				(*it)->removeTag(tag);
+				transactionModified(*it, oldtrans);
+				delete oldtrans;
+			}
 		}
 		endBatchEdit();
 	}
@@ -8630,13 +8673,34 @@ void Eqonomize::renameTag() {
 		tag_value[new_tag] = tag_value[tag];
 		bool b = false;
 		for(TransactionList<Transaction*>::const_iterator it = budget->transactions.constBegin(); it != budget->transactions.constEnd(); ++it) {
-			if((*it)->removeTag(tag)) {(*it)->addTag(new_tag); transactionModified(*it, *it); b = true;}
+			if((*it)->hasTag(tag, false)) {
+				Transaction *oldtrans = (*it)->copy();
+				(*it)->removeTag(tag);
+				(*it)->addTag(new_tag);
+				transactionModified(*it, oldtrans);
+				delete oldtrans;
+				b = true;
+			}
 		}
 		for(TransactionList<SplitTransaction*>::const_iterator it = budget->splitTransactions.constBegin(); it != budget->splitTransactions.constEnd(); ++it) {
-			if((*it)->removeTag(tag)) {(*it)->addTag(new_tag); transactionModified(*it, *it); b = true;}
+			if((*it)->hasTag(tag, false)) {
+				SplitTransaction *oldtrans = (*it)->copy();
+				(*it)->removeTag(tag);
+				(*it)->addTag(new_tag);
+				transactionModified(*it, oldtrans);
+				delete oldtrans;
+				b = true;
+			}
 		}
 		for(TransactionList<ScheduledTransaction*>::const_iterator it = budget->scheduledTransactions.constBegin(); it != budget->scheduledTransactions.constEnd(); ++it) {
-			if((*it)->removeTag(tag)) {(*it)->addTag(new_tag); transactionModified(*it, *it); b = true;}
+			if((*it)->hasTag(tag, false)) {
+				ScheduledTransaction *oldtrans = (*it)->copy();
+				(*it)->removeTag(tag);
+				(*it)->addTag(new_tag);
+				transactionModified(*it, oldtrans);
+				delete oldtrans;
+				b = true;
+			}
 		}
 		if(b) endBatchEdit();
 		else in_batch_edit = false;
@@ -8654,6 +8718,7 @@ void Eqonomize::transactionAdded(Transactions *transs) {
 		case GENERAL_TRANSACTION_TYPE_SINGLE: {
 			Transaction *trans = (Transaction*) transs;
 			addTransactionValue(trans, trans->date(), true);
+			addTransactionMonthValue(trans);
 			if(trans->type() == TRANSACTION_TYPE_SECURITY_BUY || trans->type() == TRANSACTION_TYPE_SECURITY_SELL) {
 				updateSecurity(((SecurityTransaction*) trans)->security());
 			} else if(trans->type() == TRANSACTION_TYPE_INCOME && ((Income*) trans)->security()) {
@@ -8667,6 +8732,7 @@ void Eqonomize::transactionAdded(Transactions *transs) {
 			for(int i = 0; i < c; i++) {
 				Transaction *trans = split->at(i);
 				addTransactionValue(trans, trans->date(), true);
+				addTransactionMonthValue(trans);
 				expensesWidget->onTransactionAdded(trans);
 				incomesWidget->onTransactionAdded(trans);
 				transfersWidget->onTransactionAdded(trans);
@@ -8702,19 +8768,25 @@ void Eqonomize::transactionAdded(Transactions *transs) {
 			break;
 		}
 	}
-	if(!in_batch_edit) emit transactionsModified();
+	if(!in_batch_edit) {
+		emit singleTransactionAdded(transs);
+		emit transactionsModified();
+	}
 	expensesWidget->onTransactionAdded(transs);
 	incomesWidget->onTransactionAdded(transs);
 	transfersWidget->onTransactionAdded(transs);
 }
 void Eqonomize::transactionModified(Transactions *transs, Transactions *oldtranss) {
 	setModified(true);
+	budget->transactionTextModified(transs);
 	switch(transs->generaltype()) {
 		case GENERAL_TRANSACTION_TYPE_SINGLE: {
 			Transaction *trans = (Transaction*) transs;
 			Transaction *oldtrans = (Transaction*) oldtranss;
 			subtractTransactionValue(oldtrans, true);
 			addTransactionValue(trans, trans->date(), true);
+			addTransactionMonthValue(oldtrans, true);
+			addTransactionMonthValue(trans);
 			if(trans->type() == TRANSACTION_TYPE_SECURITY_BUY || trans->type() == TRANSACTION_TYPE_SECURITY_SELL) {
 				updateSecurity(((SecurityTransaction*) trans)->security());
 			} else if(trans->type() == TRANSACTION_TYPE_INCOME && ((Income*) trans)->security()) {
@@ -8739,12 +8811,14 @@ void Eqonomize::transactionModified(Transactions *transs, Transactions *oldtrans
 			for(int i = 0; i < c; i++) {
 				Transaction *trans = split->at(i);
 				subtractTransactionValue(trans, true);
+				addTransactionMonthValue(trans, true);
 			}
 			split = (SplitTransaction*) transs;
 			c = split->count();
 			for(int i = 0; i < c; i++) {
 				Transaction *trans = split->at(i);
 				addTransactionValue(trans, trans->date(), true);
+				addTransactionMonthValue(trans);
 			}
 			break;
 		}
@@ -8782,7 +8856,10 @@ void Eqonomize::transactionModified(Transactions *transs, Transactions *oldtrans
 			break;
 		}
 	}
-	if(!in_batch_edit) emit transactionsModified();
+	if(!in_batch_edit) {
+		emit singleTransactionModified(transs, oldtranss);
+		emit transactionsModified();
+	}
 	expensesWidget->onTransactionModified(transs, oldtranss);
 	incomesWidget->onTransactionModified(transs, oldtranss);
 	transfersWidget->onTransactionModified(transs, oldtranss);
@@ -8794,6 +8871,7 @@ void Eqonomize::transactionRemoved(Transactions *transs, Transactions *oldvalue)
 		case GENERAL_TRANSACTION_TYPE_SINGLE: {
 			Transaction *trans = (Transaction*) oldvalue;
 			subtractTransactionValue(trans, true);
+			addTransactionMonthValue(trans, true);
 			if(trans->type() == TRANSACTION_TYPE_SECURITY_BUY || trans->type() == TRANSACTION_TYPE_SECURITY_SELL) {
 				updateSecurity(((SecurityTransaction*) trans)->security());
 			} else if(trans->type() == TRANSACTION_TYPE_INCOME && ((Income*) trans)->security()) {
@@ -8807,6 +8885,7 @@ void Eqonomize::transactionRemoved(Transactions *transs, Transactions *oldvalue)
 			for(int i = 0; i < c; i++) {
 				Transaction *trans = split->at(i);
 				subtractTransactionValue(trans, true);
+				addTransactionMonthValue(trans, true);
 				expensesWidget->onTransactionRemoved(trans);
 				incomesWidget->onTransactionRemoved(trans);
 				transfersWidget->onTransactionRemoved(trans);
@@ -8851,7 +8930,10 @@ void Eqonomize::transactionRemoved(Transactions *transs, Transactions *oldvalue)
 			break;
 		}
 	}
-	if(!in_batch_edit) emit transactionsModified();
+	if(!in_batch_edit) {
+		emit singleTransactionRemoved(transs, oldvalue);
+		emit transactionsModified();
+	}
 	expensesWidget->onTransactionRemoved(transs);
 	incomesWidget->onTransactionRemoved(transs);
 	transfersWidget->onTransactionRemoved(transs);
@@ -9140,22 +9222,20 @@ void Eqonomize::addScheduledTransactionValue(ScheduledTransaction *strans, bool
 		}
 		return addTransactionValue((Transaction*) strans->transaction(), strans->transaction()->date(), update_value_display, subtract, -1, -1, NULL);
 	}
-	Recurrence *rec = strans->recurrence();
-	QDate curdate = rec->firstOccurrence();
+	QVector<QDate> dates = budget->scheduledOccurrences(strans, to_date);
 	int b_future = 1;
 	if(to_date <= QDate::currentDate()) b_future = 0;
 	else if(strans->transaction()->date() <= QDate::currentDate()) b_future = -1;
-	while(!curdate.isNull() && curdate <= to_date) {
+	for(QVector<QDate>::const_iterator it = dates.constBegin(); it != dates.constEnd() && *it <= to_date; ++it) {
 		if(strans->transaction()->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT) {
 			SplitTransaction *split = (SplitTransaction*) strans->transaction();
 			int c = split->count();
 			for(int i = 0; i < c; i++) {
-				addTransactionValue(split->at(i), curdate, update_value_display, subtract, 1, b_future, NULL);
+				addTransactionValue(split->at(i), *it, update_value_display, subtract, 1, b_future, NULL);
 			}
 		} else {
-			addTransactionValue((Transaction*) strans->transaction(), curdate, update_value_display, subtract, 1, b_future, NULL);
+			addTransactionValue((Transaction*) strans->transaction(), *it, update_value_display, subtract, 1, b_future, NULL);
 		}
-		curdate = rec->nextOccurrence(curdate);
 	}
 }
 void Eqonomize::subtractTransactionValue(Transaction *trans, bool update_value_display) {
@@ -9175,6 +9255,16 @@ void Eqonomize::addTransactionValue(Transaction *trans, const QDate &transdate,
 		}
 		b_lastmonth = true;
 	}
+	if(update_value_display) {
+		account_display_dirty[trans->fromAccount()] = true;
+		account_display_dirty[trans->fromAccount()->topAccount()] = true;
+		account_display_dirty[trans->toAccount()] = true;
+		account_display_dirty[trans->toAccount()->topAccount()] = true;
+		if(!b_value_display_queued) {
+			b_value_display_queued = true;
+			QTimer::singleShot(0, this, SLOT(updateValueDisplay()));
+		}
+	}
 	bool b_filter =  !b_lastmonth && b_from && transdate < from_date;
 	bool b_curmonth = false;
 	bool b_firstmonth = false;	
@@ -9216,50 +9306,29 @@ void Eqonomize::addTransactionValue(Transaction *trans, const QDate &transdate,
 			if(b_lastmonth) {
 				account_month_endlast[trans->fromAccount()] -= cvalue_then;
 				if(from_sub) account_month_endlast[trans->fromAccount()->topAccount()] -= cvalue_then;
-				account_month[trans->fromAccount()][*monthdate] -= cvalue_then;
-				if(from_sub) account_month[trans->fromAccount()->topAccount()][*monthdate] -= cvalue_then;
-				if(update_value_display) {
-					updateMonthlyBudget(trans->fromAccount());
-					if(from_sub) updateMonthlyBudget(trans->fromAccount()->topAccount());
-					updateTotalMonthlyExpensesBudget();
-				}
+				account_month(trans->fromAccount(), *monthdate) -= cvalue_then;
+				if(from_sub) account_month(trans->fromAccount()->topAccount(), *monthdate) -= cvalue_then;
 				break;
 			}
-			bool update_month_display = false;
 			if(b_firstmonth) {
 				account_month_beginfirst[trans->fromAccount()] -= cvalue_then;
 				if(from_sub) account_month_beginfirst[trans->fromAccount()->topAccount()] -= cvalue_then;
-				update_month_display = true;
 			}
 			if(b_curmonth) {
 				account_month_begincur[trans->fromAccount()] -= cvalue_then;
 				if(from_sub) account_month_begincur[trans->fromAccount()->topAccount()] -= cvalue_then;
-				update_month_display = true;
 			}
 			if(b_future || (!frommonth_begin.isNull() && transdate >= frommonth_begin) || (!prevmonth_begin.isNull() && transdate >= prevmonth_begin)) {
-				account_month[trans->fromAccount()][*monthdate] -= cvalue_then;
-				if(from_sub) account_month[trans->fromAccount()->topAccount()][*monthdate] -= cvalue_then;
-				update_month_display = true;
-			}
-			if(update_value_display && update_month_display) {
-				updateMonthlyBudget(trans->fromAccount());
-				if(from_sub) updateMonthlyBudget(trans->fromAccount()->topAccount());
-				updateTotalMonthlyExpensesBudget();
+				account_month(trans->fromAccount(), *monthdate) -= cvalue_then;
+				if(from_sub) account_month(trans->fromAccount()->topAccount(), *monthdate) -= cvalue_then;
 			}
 			account_value[trans->fromAccount()] -= cvalue_then;
 			if(from_sub) account_value[trans->fromAccount()->topAccount()] -= cvalue_then;
 			expenses_accounts_value -= cvalue_then;
 			if(!b_filter) {
 				account_change[trans->fromAccount()] -= cvalue_then;
-				if(from_sub) account_value[trans->fromAccount()->topAccount()] -= cvalue_then;
+				if(from_sub) account_change[trans->fromAccount()->topAccount()] -= cvalue_then;
 				expenses_accounts_change -= cvalue_then;
-				if(update_value_display) {
-					expensesItem->setText(CHANGE_COLUMN, budget->formatMoney(expenses_accounts_change));
-					setAccountChangeColor(expensesItem, expenses_accounts_change, true);
-				}
-			}
-			if(update_value_display) {
-				expensesItem->setText(VALUE_COLUMN, budget->formatMoney(expenses_accounts_value) + " ");
 			}
 			break;
 		}
@@ -9268,35 +9337,21 @@ void Eqonomize::addTransactionValue(Transaction *trans, const QDate &transdate,
 			if(b_lastmonth) {
 				account_month_endlast[trans->fromAccount()] += cvalue_then;
 				if(from_sub) account_month_endlast[trans->fromAccount()->topAccount()] += cvalue_then;
-				account_month[trans->fromAccount()][*monthdate] += cvalue_then;
-				if(from_sub) account_month[trans->fromAccount()->topAccount()][*monthdate] += cvalue_then;
-				if(update_value_display) {
-					updateMonthlyBudget(trans->fromAccount());
-					if(from_sub) updateMonthlyBudget(trans->fromAccount()->topAccount());
-					updateTotalMonthlyIncomesBudget();
-				}
+				account_month(trans->fromAccount(), *monthdate) += cvalue_then;
+				if(from_sub) account_month(trans->fromAccount()->topAccount(), *monthdate) += cvalue_then;
 				break;
 			}
-			bool update_month_display = false;
 			if(b_firstmonth) {
 				account_month_beginfirst[trans->fromAccount()] += cvalue_then;
 				if(from_sub) account_month_beginfirst[trans->fromAccount()->topAccount()] += cvalue_then;
-				update_month_display = true;
 			}
 			if(b_curmonth) {
 				account_month_begincur[trans->fromAccount()] += cvalue_then;
 				if(from_sub) account_month_begincur[trans->fromAccount()->topAccount()] += cvalue_then;
-				update_month_display = true;
 			}
 			if(b_future || (!frommonth_begin.isNull() && transdate >= frommonth_begin) || (!prevmonth_begin.isNull() && transdate >= prevmonth_begin)) {
-				account_month[trans->fromAccount()][*monthdate] += cvalue_then;
-				if(from_sub) account_month[trans->fromAccount()->topAccount()][*monthdate] += cvalue_then;
-				update_month_display = true;
-			}
-			if(update_value_display && update_month_display) {
-				updateMonthlyBudget(trans->fromAccount());
-				if(from_sub) updateMonthlyBudget(trans->fromAccount()->topAccount());
-				updateTotalMonthlyIncomesBudget();
+				account_month(trans->fromAccount(), *monthdate) += cvalue_then;
+				if(from_sub) account_month(trans->fromAccount()->topAccount(), *monthdate) += cvalue_then;
 			}
 			account_value[trans->fromAccount()] += cvalue_then;
 			if(from_sub) account_value[trans->fromAccount()->topAccount()] += cvalue_then;
@@ -9305,33 +9360,12 @@ void Eqonomize::addTransactionValue(Transaction *trans, const QDate &transdate,
 				account_change[trans->fromAccount()] += cvalue_then;
 				if(from_sub) account_change[trans->fromAccount()->topAccount()] += cvalue_then;
 				incomes_accounts_change += cvalue_then;
-				if(update_value_display) {
-					incomesItem->setText(CHANGE_COLUMN, budget->formatMoney(incomes_accounts_change));
-					setAccountChangeColor(incomesItem, incomes_accounts_change, false);
-				}
-			}
-			if(update_value_display) {
-				incomesItem->setText(VALUE_COLUMN, budget->formatMoney(incomes_accounts_value) + " ");
 			}
 			break;
 		}
 		case ACCOUNT_TYPE_ASSETS: {
 			if(b_lastmonth) break;
 			if(((AssetsAccount*) trans->fromAccount())->accountType() == ASSETS_TYPE_SECURITIES) {
-				if(update_value_display) {
-					updateSecurityAccount((AssetsAccount*) trans->fromAccount(), false);
-					assetsItem->setText(VALUE_COLUMN, budget->formatMoney(assets_accounts_value) + " ");
-					assetsItem->setText(CHANGE_COLUMN, budget->formatMoney(assets_accounts_change));
-					QString s_group = ((AssetsAccount*) trans->fromAccount())->group();
-					if(item_assets_groups.contains(s_group)) {
-						item_assets_groups[s_group]->setText(VALUE_COLUMN, budget->formatMoney(assets_group_value[s_group]) + " ");
-						item_assets_groups[s_group]->setText(CHANGE_COLUMN, budget->formatMoney(assets_group_change[s_group]));
-						setAccountChangeColor(item_assets_groups[s_group], assets_group_change[s_group], false);
-					}
-					setAccountChangeColor(assetsItem, assets_accounts_change, false);
-					item_accounts[trans->fromAccount()]->setText(CHANGE_COLUMN, trans->fromAccount()->currency()->formatValue(account_change[trans->fromAccount()]));
-					setAccountChangeColor(item_accounts[trans->fromAccount()], account_change[trans->fromAccount()], false);
-				}
 				break;
 			}
 			balfrom = (trans->fromAccount() == budget->balancingAccount);
@@ -9349,39 +9383,6 @@ void Eqonomize::addTransactionValue(Transaction *trans, const QDate &transdate,
 					else assets_accounts_change -= cvalue;
 					if(from_is_debt) liabilities_group_change[s_group] -= cvalue;
 					else assets_group_change[s_group] -= cvalue;
-					if(update_value_display) {
-						if(from_is_debt) {
-							liabilitiesItem->setText(CHANGE_COLUMN, budget->formatMoney(-liabilities_accounts_change));
-							setAccountChangeColor(liabilitiesItem, -liabilities_accounts_change, true);
-							item_accounts[trans->fromAccount()]->setText(CHANGE_COLUMN, trans->fromAccount()->currency()->formatValue(-account_change[trans->fromAccount()]));
-							setAccountChangeColor(item_accounts[trans->fromAccount()], -account_change[trans->fromAccount()], true);
-						} else {
-							assetsItem->setText(CHANGE_COLUMN, budget->formatMoney(assets_accounts_change));
-							setAccountChangeColor(assetsItem, assets_accounts_change, false);
-							item_accounts[trans->fromAccount()]->setText(CHANGE_COLUMN, trans->fromAccount()->currency()->formatValue(account_change[trans->fromAccount()]));
-							setAccountChangeColor(item_accounts[trans->fromAccount()], account_change[trans->fromAccount()], false);
-						}
-						bool b_hide = trans->fromAccount()->isClosed() && is_zero(account_change[trans->fromAccount()]) && is_zero(account_value[trans->fromAccount()]); 
-						if(b_hide != item_accounts[trans->fromAccount()]->isHidden()) {
-							item_accounts[trans->fromAccount()]->setHidden(b_hide);
-							if(b_hide) assetsAccountItemHiddenOrRemoved((AssetsAccount*) trans->fromAccount());
-							else assetsAccountItemShownOrAdded((AssetsAccount*) trans->fromAccount());
-						}
-						if(!from_is_debt && item_assets_groups.contains(s_group)) {
-							item_assets_groups[s_group]->setText(CHANGE_COLUMN, budget->formatMoney(assets_group_change[s_group]));
-							setAccountChangeColor(item_assets_groups[s_group], assets_group_change[s_group], false);
-						} else if(from_is_debt && item_liabilities_groups.contains(s_group)) {
-							item_liabilities_groups[s_group]->setText(CHANGE_COLUMN, budget->formatMoney(-liabilities_group_change[s_group]));
-							setAccountChangeColor(item_liabilities_groups[s_group], -liabilities_group_change[s_group], true);
-						}
-					}
-				}
-				if(update_value_display) {
-					
-					if(from_is_debt) liabilitiesItem->setText(VALUE_COLUMN, budget->formatMoney(-liabilities_accounts_value) + " ");
-					else assetsItem->setText(VALUE_COLUMN, budget->formatMoney(assets_accounts_value) + " ");
-					if(!from_is_debt && item_assets_groups.contains(s_group)) item_assets_groups[s_group]->setText(VALUE_COLUMN, budget->formatMoney(assets_group_value[s_group]) + " ");
-					else if(from_is_debt && item_liabilities_groups.contains(s_group)) item_liabilities_groups[s_group]->setText(VALUE_COLUMN, budget->formatMoney(-liabilities_group_value[s_group]) + " ");
 				}
 			}
 			break;
@@ -9393,13 +9394,6 @@ void Eqonomize::addTransactionValue(Transaction *trans, const QDate &transdate,
 			if(tag.isEmpty()) break;
 			tag_value[tag] += cvalue_then;
 			if(!b_filter) tag_change[tag] += cvalue_then;
-			if(update_value_display) {
-				item_tags[tag]->setText(VALUE_COLUMN, budget->formatMoney(tag_value[tag]) + " ");
-				if(!b_filter) {
-					item_tags[tag]->setText(CHANGE_COLUMN, budget->formatMoney(tag_change[tag]));
-					setAccountChangeColor(item_tags[tag], tag_change[tag], false);
-				}
-			}
 		}
 	}
 	value = subtract ? -trans->toValue(false) : trans->toValue(false);
@@ -9412,35 +9406,21 @@ void Eqonomize::addTransactionValue(Transaction *trans, const QDate &transdate,
 			if(b_lastmonth) {
 				account_month_endlast[trans->toAccount()] += cvalue_then;
 				if(to_sub) account_month_endlast[trans->toAccount()->topAccount()] += cvalue_then;
-				account_month[trans->toAccount()][*monthdate] += cvalue_then;
-				if(to_sub) account_month[trans->toAccount()->topAccount()][*monthdate] += cvalue_then;
-				if(update_value_display) {
-					updateMonthlyBudget(trans->toAccount());
-					if(to_sub) updateMonthlyBudget(trans->toAccount()->topAccount());
-					updateTotalMonthlyExpensesBudget();
-				}
+				account_month(trans->toAccount(), *monthdate) += cvalue_then;
+				if(to_sub) account_month(trans->toAccount()->topAccount(), *monthdate) += cvalue_then;
 				break;
 			}
-			bool update_month_display = false;
 			if(b_firstmonth) {
 				account_month_beginfirst[trans->toAccount()] += cvalue_then;
 				if(to_sub) account_month_beginfirst[trans->toAccount()->topAccount()] += cvalue_then;
-				update_month_display = true;
 			}
 			if(b_curmonth) {
 				account_month_begincur[trans->toAccount()] += cvalue_then;
 				if(to_sub) account_month_begincur[trans->toAccount()->topAccount()] += cvalue_then;
-				update_month_display = true;
 			}
 			if(b_future || (!frommonth_begin.isNull() && transdate >= frommonth_begin) || (!prevmonth_begin.isNull() && transdate >= prevmonth_begin)) {
-				account_month[trans->toAccount()][*monthdate] += cvalue_then;
-				if(to_sub) account_month[trans->toAccount()->topAccount()][*monthdate] += cvalue_then;
-				update_month_display = true;
-			}
-			if(update_value_display && update_month_display) {
-				updateMonthlyBudget(trans->toAccount());
-				if(to_sub) updateMonthlyBudget(trans->toAccount()->topAccount());
-				updateTotalMonthlyExpensesBudget();
+				account_month(trans->toAccount(), *monthdate) += cvalue_then;
+				if(to_sub) account_month(trans->toAccount()->topAccount(), *monthdate) += cvalue_then;
 			}
 			account_value[trans->toAccount()] += cvalue_then;
 			if(to_sub) account_value[trans->toAccount()->topAccount()] += cvalue_then;
@@ -9449,13 +9429,6 @@ void Eqonomize::addTransactionValue(Transaction *trans, const QDate &transdate,
 				account_change[trans->toAccount()] += cvalue_then;
 				if(to_sub) account_change[trans->toAccount()->topAccount()] += cvalue_then;
 				expenses_accounts_change += cvalue_then;
-				if(update_value_display) {
-					expensesItem->setText(CHANGE_COLUMN, budget->formatMoney(expenses_accounts_change));
-					setAccountChangeColor(expensesItem, expenses_accounts_change, true);
-				}
-			}
-			if(update_value_display) {
-				expensesItem->setText(VALUE_COLUMN, budget->formatMoney(expenses_accounts_value) + " ");
 			}
 			break;
 		}
@@ -9464,69 +9437,35 @@ void Eqonomize::addTransactionValue(Transaction *trans, const QDate &transdate,
 			if(b_lastmonth) {
 				account_month_endlast[trans->toAccount()] -= cvalue_then;
 				if(to_sub) account_month_endlast[trans->toAccount()->topAccount()] -= cvalue_then;
-				account_month[trans->toAccount()][*monthdate] -= cvalue_then;
-				if(to_sub) account_month[trans->toAccount()->topAccount()][*monthdate] -= cvalue_then;
-				if(update_value_display) {
-					updateMonthlyBudget(trans->toAccount());
-					if(to_sub) updateMonthlyBudget(trans->toAccount()->topAccount());
-					updateTotalMonthlyIncomesBudget();
-				}
+				account_month(trans->toAccount(), *monthdate) -= cvalue_then;
+				if(to_sub) account_month(trans->toAccount()->topAccount(), *monthdate) -= cvalue_then;
 				break;
 			}
-			bool update_month_display = false;
 			if(b_firstmonth) {
 				account_month_beginfirst[trans->toAccount()] -= cvalue_then;
 				if(to_sub) account_month_beginfirst[trans->toAccount()->topAccount()] -= cvalue_then;
-				update_month_display = true;
 			}
 			if(b_curmonth) {
 				account_month_begincur[trans->toAccount()] -= cvalue_then;
 				if(to_sub) account_month_begincur[trans->toAccount()->topAccount()] -= cvalue_then;
-				update_month_display = true;
 			}
 			if(b_future || (!frommonth_begin.isNull() && transdate >= frommonth_begin) || (!prevmonth_begin.isNull() && transdate >= prevmonth_begin)) {
-				account_month[trans->toAccount()][*monthdate] -= cvalue_then;
-				if(to_sub) account_month[trans->toAccount()->topAccount()][*monthdate] -= cvalue_then;
-				update_month_display = true;
-			}
-			if(update_value_display && update_month_display) {
-				updateMonthlyBudget(trans->toAccount());
-				if(to_sub) updateMonthlyBudget(trans->toAccount()->topAccount());
-				updateTotalMonthlyIncomesBudget();
+				account_month(trans->toAccount(), *monthdate) -= cvalue_then;
+				if(to_sub) account_month(trans->toAccount()->topAccount(), *monthdate) -= cvalue_then;
 			}
 			account_value[trans->toAccount()] -= cvalue_then;
+			if(to_sub) account_value[trans->toAccount()->topAccount()] -= cvalue_then;
 			incomes_accounts_value -= cvalue_then;
 			if(!b_filter) {
 				account_change[trans->toAccount()] -= cvalue_then;
 				if(to_sub) account_change[trans->toAccount()->topAccount()] -= cvalue_then;
-				incomes_accounts_change -= value;
-				if(update_value_display) {
-					incomesItem->setText(CHANGE_COLUMN, budget->formatMoney(incomes_accounts_change));
-					setAccountChangeColor(incomesItem, incomes_accounts_change, false);
-				}
-			}
-			if(update_value_display) {
-				incomesItem->setText(VALUE_COLUMN, budget->formatMoney(incomes_accounts_value) + " ");
+				incomes_accounts_change -= cvalue_then;
 			}
 			break;
 		}
 		case ACCOUNT_TYPE_ASSETS: {
 			if(b_lastmonth) break;
 			if(((AssetsAccount*) trans->toAccount())->accountType() == ASSETS_TYPE_SECURITIES) {
-				if(update_value_display) {
-					updateSecurityAccount((AssetsAccount*) trans->toAccount(), false);
-					assetsItem->setText(VALUE_COLUMN, budget->formatMoney(assets_accounts_value) + " ");
-					assetsItem->setText(CHANGE_COLUMN, budget->formatMoney(assets_accounts_change));
-					setAccountChangeColor(assetsItem, assets_accounts_change, false);
-					QString s_group = ((AssetsAccount*) trans->toAccount())->group();
-					if(item_assets_groups.contains(s_group)) {
-						item_assets_groups[s_group]->setText(VALUE_COLUMN, budget->formatMoney(assets_group_value[s_group]) + " ");
-						item_assets_groups[s_group]->setText(CHANGE_COLUMN, budget->formatMoney(assets_group_change[s_group]));
-						setAccountChangeColor(item_assets_groups[s_group], assets_group_change[s_group], false);
-					}
-					item_accounts[trans->toAccount()]->setText(CHANGE_COLUMN, trans->toAccount()->currency()->formatValue(account_change[trans->toAccount()]));
-					setAccountChangeColor(item_accounts[trans->toAccount()], account_change[trans->toAccount()], false);
-				}
 				break;
 			}
 			balto = (trans->toAccount() == budget->balancingAccount);
@@ -9544,38 +9483,6 @@ void Eqonomize::addTransactionValue(Transaction *trans, const QDate &transdate,
 					else assets_accounts_change += cvalue;
 					if(to_is_debt) liabilities_group_change[s_group] += cvalue;
 					else assets_group_change[s_group] += cvalue;
-					if(update_value_display) {
-						if(to_is_debt) {
-							liabilitiesItem->setText(CHANGE_COLUMN, budget->formatMoney(-liabilities_accounts_change));
-							setAccountChangeColor(liabilitiesItem, -liabilities_accounts_change, true);
-							item_accounts[trans->toAccount()]->setText(CHANGE_COLUMN, trans->toAccount()->currency()->formatValue(-account_change[trans->toAccount()]));
-							setAccountChangeColor(item_accounts[trans->toAccount()], -account_change[trans->toAccount()], true);
-						} else {
-							assetsItem->setText(CHANGE_COLUMN, budget->formatMoney(assets_accounts_change));
-							setAccountChangeColor(assetsItem, assets_accounts_change, false);
-							item_accounts[trans->toAccount()]->setText(CHANGE_COLUMN, trans->toAccount()->currency()->formatValue(account_change[trans->toAccount()]));
-							setAccountChangeColor(item_accounts[trans->toAccount()], account_change[trans->toAccount()], false);
-						}
-						bool b_hide = trans->toAccount()->isClosed() && is_zero(account_change[trans->toAccount()]) && is_zero(account_value[trans->toAccount()]); 
-						if(b_hide != item_accounts[trans->toAccount()]->isHidden()) {
-							item_accounts[trans->toAccount()]->setHidden(b_hide);
-							if(b_hide) assetsAccountItemHiddenOrRemoved((AssetsAccount*) trans->toAccount());
-							else assetsAccountItemShownOrAdded((AssetsAccount*) trans->toAccount());
-						}
-						if(!to_is_debt && item_assets_groups.contains(s_group)) {
-							item_assets_groups[s_group]->setText(CHANGE_COLUMN, budget->formatMoney(assets_group_change[s_group]));
-							setAccountChangeColor(item_assets_groups[s_group], assets_group_change[s_group], false);
-						} else if(to_is_debt && item_liabilities_groups.contains(s_group)) {
-							item_liabilities_groups[s_group]->setText(CHANGE_COLUMN, budget->formatMoney(-liabilities_group_change[s_group]));
-							setAccountChangeColor(item_liabilities_groups[s_group], -liabilities_group_change[s_group], true);
-						}
-					}
-				}
-				if(update_value_display) {
-					if(to_is_debt) liabilitiesItem->setText(VALUE_COLUMN, budget->formatMoney(-liabilities_accounts_value) + " ");
-					else assetsItem->setText(VALUE_COLUMN, budget->formatMoney(assets_accounts_value) + " ");
-					if(!to_is_debt && item_assets_groups.contains(s_group)) item_assets_groups[s_group]->setText(VALUE_COLUMN, budget->formatMoney(assets_group_value[s_group]) + " ");
-					else if(to_is_debt && item_liabilities_groups.contains(s_group)) item_liabilities_groups[s_group]->setText(VALUE_COLUMN, budget->formatMoney(-liabilities_group_value[s_group]) + " ");
 				}
 			}
 			break;
@@ -9587,47 +9494,40 @@ void Eqonomize::addTransactionValue(Transaction *trans, const QDate &transdate,
 			if(tag.isEmpty()) break;
 			tag_value[tag] -= cvalue_then;
 			if(!b_filter) tag_change[tag] -= cvalue_then;
-			if(update_value_display) {
-				item_tags[tag]->setText(VALUE_COLUMN, budget->formatMoney(tag_value[tag]) + " ");
-				if(!b_filter) {
-					item_tags[tag]->setText(CHANGE_COLUMN, budget->formatMoney(tag_change[tag]));
-					setAccountChangeColor(item_tags[tag], tag_change[tag], false);
-				}
-			}
 		}
 	}
-	if(update_value_display && !b_lastmonth) {
-		if(!balfrom) {
-			item_accounts[trans->fromAccount()]->setText(VALUE_COLUMN, trans->fromAccount()->currency()->formatValue(from_is_debt ? -account_value[trans->fromAccount()] : account_value[trans->fromAccount()]) + " ");
-			item_accounts[trans->fromAccount()]->setText(CHANGE_COLUMN, trans->fromAccount()->currency()->formatValue(from_is_debt ? -account_change[trans->fromAccount()] : account_change[trans->fromAccount()]));
-			setAccountChangeColor(item_accounts[trans->fromAccount()], from_is_debt ? -account_change[trans->fromAccount()] : account_change[trans->fromAccount()], from_is_debt || trans->fromAccount()->type() == ACCOUNT_TYPE_EXPENSES);
-			bool b_hide = trans->fromAccount()->isClosed() && is_zero(account_change[trans->fromAccount()]) && is_zero(account_value[trans->fromAccount()]); 
-			if(b_hide != item_accounts[trans->fromAccount()]->isHidden()) {
-				item_accounts[trans->fromAccount()]->setHidden(b_hide);
-				if(b_hide) assetsAccountItemHiddenOrRemoved((AssetsAccount*) trans->fromAccount());
-				else assetsAccountItemShownOrAdded((AssetsAccount*) trans->fromAccount());
-			}
-			if(from_sub) {
-				item_accounts[trans->fromAccount()->topAccount()]->setText(VALUE_COLUMN, trans->fromAccount()->topAccount()->currency()->formatValue(account_value[trans->fromAccount()->topAccount()]) + " ");
-				item_accounts[trans->fromAccount()->topAccount()]->setText(CHANGE_COLUMN, trans->fromAccount()->topAccount()->currency()->formatValue(account_change[trans->fromAccount()->topAccount()]));
-				setAccountChangeColor(item_accounts[trans->fromAccount()->topAccount()], account_change[trans->fromAccount()->topAccount()], trans->fromAccount()->topAccount()->type() == ACCOUNT_TYPE_EXPENSES);
-			}
+}
+void Eqonomize::addTransactionMonthValue(Transaction *trans, bool subtract) {
+	if(!b_month_values_valid) return;
+	QDate monthdate = budget->lastBudgetDay(trans->date());
+	double value = subtract ? -trans->fromValue(false) : trans->fromValue(false);
+	double cvalue_then = subtract ? -trans->fromValue(true) : trans->fromValue(true);
+	switch(trans->fromAccount()->type()) {
+		case ACCOUNT_TYPE_EXPENSES: {account_month_value(trans->fromAccount(), monthdate) -= cvalue_then; break;}
+		case ACCOUNT_TYPE_INCOMES: {account_month_value(trans->fromAccount(), monthdate) += cvalue_then; break;}
+		case ACCOUNT_TYPE_ASSETS: {account_month_value(trans->fromAccount(), monthdate) -= value; break;}
+	}
+	if(trans->fromAccount()->type() == ACCOUNT_TYPE_EXPENSES || trans->fromAccount()->type() == ACCOUNT_TYPE_INCOMES) {
+		for(int i = 0; ; i++) {
+			const QString &tag = trans->getTag(i, true);
+			if(tag.isEmpty()) break;
+			if(!tag_month_rows.contains(tag)) tag_month_rows[tag] = tag_month_rows.count();
+			tag_month_value(tag_month_rows[tag], monthdate) += cvalue_then;
 		}
-		if(!balto) {
-			item_accounts[trans->toAccount()]->setText(VALUE_COLUMN, trans->toAccount()->currency()->formatValue(to_is_debt ? -account_value[trans->toAccount()] : account_value[trans->toAccount()]) + " ");
-			item_accounts[trans->toAccount()]->setText(CHANGE_COLUMN, trans->toAccount()->currency()->formatValue(to_is_debt ? -account_change[trans->toAccount()] : account_change[trans->toAccount()]));
-			setAccountChangeColor(item_accounts[trans->toAccount()], to_is_debt ? -account_change[trans->toAccount()] : account_change[trans->toAccount()], to_is_debt || trans->toAccount()->type() == ACCOUNT_TYPE_EXPENSES);
-			bool b_hide = trans->toAccount()->isClosed() && is_zero(account_change[trans->toAccount()]) && is_zero(account_value[trans->toAccount()]); 
-			if(b_hide != item_accounts[trans->toAccount()]->isHidden()) {
-				item_accounts[trans->toAccount()]->setHidden(b_hide);
-				if(b_hide) assetsAccountItemHiddenOrRemoved((AssetsAccount*) trans->toAccount());
-				else assetsAccountItemShownOrAdded((AssetsAccount*) trans->toAccount());
-			}
-			if(to_sub) {
-				item_accounts[trans->toAccount()->topAccount()]->setText(VALUE_COLUMN, trans->toAccount()->topAccount()->currency()->formatValue(account_value[trans->toAccount()->topAccount()]) + " ");
-				item_accounts[trans->toAccount()->topAccount()]->setText(CHANGE_COLUMN, trans->toAccount()->topAccount()->currency()->formatValue(account_change[trans->toAccount()->topAccount()]));
-				setAccountChangeColor(item_accounts[trans->toAccount()->topAccount()], account_change[trans->toAccount()->topAccount()], trans->toAccount()->topAccount()->type() == ACCOUNT_TYPE_EXPENSES);
-			}
+	}
+	value = subtract ? -trans->toValue(false) : trans->toValue(false);
+	cvalue_then = subtract ? -trans->toValue(true) : trans->toValue(true);
+	switch(trans->toAccount()->type()) {
+		case ACCOUNT_TYPE_EXPENSES: {account_month_value(trans->toAccount(), monthdate) += cvalue_then; break;}
+		case ACCOUNT_TYPE_INCOMES: {account_month_value(trans->toAccount(), monthdate) -= cvalue_then; break;}
+		case ACCOUNT_TYPE_ASSETS: {account_month_value(trans->toAccount(), monthdate) += value; break;}
+	}
+	if(trans->toAccount()->type() == ACCOUNT_TYPE_EXPENSES || trans->toAccount()->type() == ACCOUNT_TYPE_INCOMES) {
+		for(int i = 0; ; i++) {
+			const QString &tag = trans->getTag(i, true);
+			if(tag.isEmpty()) break;
+			if(!tag_month_rows.contains(tag)) tag_month_rows[tag] = tag_month_rows.count();
+			tag_month_value(tag_month_rows[tag], monthdate) -= cvalue_then;
 		}
 	}
 }
@@ -9683,41 +9583,22 @@ void Eqonomize::updateTotalMonthlyIncomesBudget() {
 	incomesItem->setText(BUDGET_COLUMN, "-");
 	setAccountBudgetColor(incomesItem, 0.0, false);
 }
-struct budget_info {
-	QMap<QDate, double>::const_iterator it;
-	QMap<QDate, double>::const_iterator it_n;
-	QMap<QDate, double>::const_iterator it_e;
-	CategoryAccount *ca;
-	bool after_from;
-};
 void Eqonomize::updateMonthlyBudget(Account *account) {
 
 	if(account->type() == ACCOUNT_TYPE_ASSETS) return;
 	CategoryAccount *ca = (CategoryAccount*) account;
 	double mbudget = 0.0;
 	QTreeWidgetItem *i = item_accounts[account];
-	QMap<QDate, double>::iterator it = ca->mbudgets.begin();
-	QMap<QDate, double>::iterator it_e = ca->mbudgets.end();
-	QVector<budget_info> subs;
-	while(it != it_e && it.value() < 0.0) ++it;
+	QDate first_budget = ca->firstMonthlyBudget();
+	QVector<CategoryAccount*> subs;
 
-	QMap<QDate, double>::const_iterator tmp_it;
-	QMap<QDate, double>::const_iterator tmp_it_e;
 	for(AccountList<CategoryAccount*>::const_iterator it = ca->subCategories.constBegin(); it != ca->subCategories.constEnd(); ++it) {
 		CategoryAccount *sub = *it;
-		tmp_it = sub->mbudgets.begin();
-		tmp_it_e = sub->mbudgets.end();
-		while(tmp_it != tmp_it_e && tmp_it.value() < 0.0) ++tmp_it;
-		if(tmp_it != tmp_it_e && tmp_it.key() <= to_date) {
-			struct budget_info bi;
-			bi.it = tmp_it;
-			bi.it_e = tmp_it_e;
-			bi.ca = sub;
-			subs << bi;
-		}
+		QDate sub_first = sub->firstMonthlyBudget();
+		if(!sub_first.isNull() && sub_first <= to_date) subs << sub;
 	}
 
-	if(subs.isEmpty() && (it == it_e || budget->monthToBudgetMonth(it.key()) > to_date)) {
+	if(subs.isEmpty() && (first_budget.isNull() || budget->monthToBudgetMonth(first_budget) > to_date)) {
 
 		i->setText(BUDGET_COLUMN, "-");
 		setAccountBudgetColor(i, 0.0, account->type() == ACCOUNT_TYPE_EXPENSES);
@@ -9729,95 +9610,69 @@ void Eqonomize::updateMonthlyBudget(Account *account) {
 		QDate monthdate, monthend, curdate = QDate::currentDate(), curmonth, frommonth;
 
 		frommonth = frommonth_begin;
-		if(it != it_e && accountsPeriodFromButton->isChecked() && frommonth > budget->monthToBudgetMonth(it.key())) {
-			QMap<QDate, double>::iterator it_b = ca->mbudgets.begin();
-			it = it_e;
-			--it;
-			while(it != it_b) {
-				if(frommonth >= budget->monthToBudgetMonth(it.key())) break;
-				--it;
-			}
+		if(!first_budget.isNull() && accountsPeriodFromButton->isChecked() && frommonth > budget->monthToBudgetMonth(first_budget)) {
 			after_from = false;
 		}
-		for(QVector<budget_info>::iterator sit = subs.begin(); sit != subs.end(); ++sit) {
-			if(accountsPeriodFromButton->isChecked() && frommonth > budget->monthToBudgetMonth(sit->it.key())) {
-				QMap<QDate, double>::iterator it_b = sit->ca->mbudgets.begin();
-				sit->it = sit->it_e;
-				--(sit->it);
-				while(sit->it != it_b) {
-					if(frommonth >= budget->monthToBudgetMonth(sit->it.key())) break;
-					--(sit->it);
-				}
+		for(QVector<CategoryAccount*>::const_iterator sit = subs.constBegin(); sit != subs.constEnd(); ++sit) {
+			if(accountsPeriodFromButton->isChecked() && frommonth > budget->monthToBudgetMonth((*sit)->firstMonthlyBudget())) {
 				after_from = false;
 			}
 		}
 		double diff = 0.0, future_diff = 0.0, future_change_diff = 0.0, m = 0.0, v = 0.0;
 		QDate monthlast = budget->firstBudgetDay(to_date);
 
-		QMap<QDate, double>::iterator it_n = it;
-		if(it_n != it_e) ++it_n;
-		for(QVector<budget_info>::iterator sit = subs.begin(); sit != subs.end(); ++sit) {
-			sit->it_n = sit->it;
-			if(sit->it_n != sit->it_e) ++(sit->it_n);
-		}
 		bool has_budget = false, has_subs_budget = false;
 		bool b_firstmonth = !after_from && (monthdate != frommonth);
 		monthdate = frommonth;
 
+		//budget of whole months, adjusted below for partial first and last months
+		mbudget = ca->totalMonthlyBudget(budget->budgetDateToMonth(frommonth), budget->budgetDateToMonth(monthlast));
+
 		do {
-			if(it != it_e && budget->monthToBudgetMonth(it.key()) <= monthdate) m = it.value();
-			else m = -1.0;
+			QDate month = budget->budgetDateToMonth(monthdate);
+			m = ca->monthlyBudget(month);
 			if(m >= 0.0) {
 				monthend = budget->lastBudgetDay(monthdate);
 				has_budget = true;
 				bool b_lastmonth = (monthlast == monthdate && to_date != monthend);
-				v = account_month[account][monthend];
+				v = account_month.value(account, monthend);
 				if(partial_budget && (b_firstmonth || b_lastmonth)) {
 					int days;
 					if(b_firstmonth) days = from_date.daysTo(b_lastmonth ? to_date : monthend);
 					else days = monthdate.daysTo(b_lastmonth ? to_date : monthend);
 					int dim = monthdate.daysTo(monthend) + 1;
+					mbudget -= m;
 					m = (m * (days + 1)) / dim;
+					mbudget += m;
 					if(b_firstmonth) v -= account_month_beginfirst[account];
 					if(b_lastmonth) v -= account_month_endlast[account];
 				}
-				mbudget += m;
 				diff += m - v;
 			} else if(!subs.isEmpty()) {
 				monthend = budget->lastBudgetDay(monthdate);
 				bool b_lastmonth = (monthlast == monthdate && to_date != monthend);
-				for(QVector<budget_info>::iterator sit = subs.begin(); sit != subs.end(); ++sit) {
-					if(budget->monthToBudgetMonth(sit->it.key()) <= monthdate) m = sit->it.value();
-					else m = -1.0;
+				for(QVector<CategoryAccount*>::const_iterator sit = subs.constBegin(); sit != subs.constEnd(); ++sit) {
+					m = (*sit)->monthlyBudget(month);
 					if(m >= 0.0) {
 						has_subs_budget = true;
-						v = account_month[sit->ca][monthend];
+						v = account_month.value(*sit, monthend);
 						if(partial_budget && (b_firstmonth || b_lastmonth)) {
 							int days;
 							if(b_firstmonth) days = from_date.daysTo(b_lastmonth ? to_date : monthend);
 							else days = monthdate.daysTo(b_lastmonth ? to_date : monthend);
 							int dim = monthdate.daysTo(monthend) + 1;
+							mbudget -= m;
 							m = (m * (days + 1)) / dim;
-							if(b_firstmonth) v -= account_month_beginfirst[sit->ca];
-							if(b_lastmonth) v -= account_month_endlast[sit->ca];
+							mbudget += m;
+							if(b_firstmonth) v -= account_month_beginfirst[*sit];
+							if(b_lastmonth) v -= account_month_endlast[*sit];
 						}
-						mbudget += m;
 						diff += m - v;
 					}
 				}
 			}
 			b_firstmonth = false;
 			budget->addBudgetMonthsSetFirst(monthdate, 1);
-			if(it_n != it_e && monthdate == budget->monthToBudgetMonth(it_n.key())) {
-				it = it_n;
-				++it_n;
-			}
-			for(QVector<budget_info>::iterator sit = subs.begin(); sit != subs.end(); ++sit) {
-				if(sit->it_n != sit->it_e && monthdate == budget->monthToBudgetMonth(sit->it_n.key())) {
-					sit->it = sit->it_n;
-					++(sit->it_n);
-				}
-			}
 		} while(monthdate <= monthlast);
 
 		bool b_future = (curdate < to_date);
@@ -9825,54 +9680,33 @@ void Eqonomize::updateMonthlyBudget(Account *account) {
 		if(b_future && !ca->parentCategory()) {
 			bool after_cur = true;
 			
-			it = ca->mbudgets.begin();
-			while(it != it_e && it.value() < 0.0) ++it;
-			if(it != it_e) {
-				if(curdate < budget->monthToBudgetMonth(it.key())) {
-					curmonth = budget->monthToBudgetMonth(it.key());
+			if(!first_budget.isNull()) {
+				if(curdate < budget->monthToBudgetMonth(first_budget)) {
+					curmonth = budget->monthToBudgetMonth(first_budget);
 					after_cur = true;
 				} else {
 					curmonth = budget->monthToBudgetMonth(curdate);
-					QMap<QDate, double>::const_iterator it_b = ca->mbudgets.begin();
-					it = it_e;
-					--it;
-					while(it != it_b) {
-						if(curmonth >= budget->monthToBudgetMonth(it.key())) break;
-						--it;
-					}
 					after_cur = false;
 				}
 			}
-			it_n = it;
-			if(it_n != it_e) ++it_n;
 			
-			for(QVector<budget_info>::iterator sit = subs.begin(); sit != subs.end(); ++sit) {
-				sit->it = sit->ca->mbudgets.begin();
-				while(sit->it != sit->it_e && sit->it.value() < 0.0) ++(sit->it);
-				if(curdate < budget->monthToBudgetMonth(sit->it.key())) {
-					if(after_cur && curmonth > budget->monthToBudgetMonth(sit->it.key())) curmonth = budget->monthToBudgetMonth(sit->it.key());
+			for(QVector<CategoryAccount*>::const_iterator sit = subs.constBegin(); sit != subs.constEnd(); ++sit) {
+				QDate sub_first = budget->monthToBudgetMonth((*sit)->firstMonthlyBudget());
+				if(curdate < sub_first) {
+					if(after_cur && (curmonth.isNull() || curmonth > sub_first)) curmonth = sub_first;
 				} else {
 					if(after_cur) curmonth = budget->monthToBudgetMonth(curdate);
-					QMap<QDate, double>::const_iterator it_b = sit->ca->mbudgets.begin();
-					sit->it = sit->it_e;
-					--(sit->it);
-					while(sit->it != it_b) {
-						if(curmonth >= budget->monthToBudgetMonth(sit->it.key())) break;
-						--(sit->it);
-					}
 					after_cur = false;
 				}
-				sit->it_n = sit->it;
-				if(sit->it_n != sit->it_e) ++(sit->it_n);
 			}
 			bool had_from = after_from || from_date <= curdate;
 			bool b_curmonth = !after_cur && (curmonth != curdate);
 			do {
-				if(it != it_e && budget->monthToBudgetMonth(it.key()) <= curmonth) m = it.value();
-				else m = -1.0;
+				QDate month = budget->budgetDateToMonth(curmonth);
+				m = ca->monthlyBudget(month);
 				if(m >= 0.0) {
 					monthend = budget->lastBudgetDay(curmonth);
-					v = account_month[account][monthend];
+					v = account_month.value(account, monthend);
 					bool b_lastmonth = (monthlast == curmonth && to_date != monthend);
 					bool b_frommonth = !had_from && frommonth == curmonth;
 					int dim = curmonth.daysTo(monthend) + 1;
@@ -9929,27 +9763,26 @@ void Eqonomize::updateMonthlyBudget(Account *account) {
 					monthend = budget->lastBudgetDay(curmonth);					
 					bool b_lastmonth = (monthlast == monthdate && to_date != monthend);
 					bool b_frommonth = !had_from && frommonth == curmonth;
-					for(QVector<budget_info>::iterator sit = subs.begin(); sit != subs.end(); ++sit) {
-						if(budget->monthToBudgetMonth(sit->it.key()) <= curmonth) m = sit->it.value();
-						else m = -1.0;
+					for(QVector<CategoryAccount*>::const_iterator sit = subs.constBegin(); sit != subs.constEnd(); ++sit) {
+						m = (*sit)->monthlyBudget(month);
 						if(m >= 0.0) {
-							v = account_month[sit->ca][monthend];
+							v = account_month.value(*sit, monthend);
 							int dim = curmonth.daysTo(monthend) + 1;
 							if(partial_budget && (b_curmonth || b_lastmonth || b_frommonth)) {
 								int days;
 								if(b_curmonth) {
-									v -= account_month_begincur[sit->ca];
+									v -= account_month_begincur[*sit];
 									days = curdate.daysTo(b_lastmonth ? to_date : monthend);
 								} else {
 									days = curmonth.daysTo(b_lastmonth ? to_date : monthend);
 								}
-								if(b_lastmonth) v -= account_month_endlast[sit->ca];
+								if(b_lastmonth) v -= account_month_endlast[*sit];
 								m = (m * (days + 1)) / dim;
 								if(b_frommonth) {
 									int days2;
 									if(b_curmonth) days2 = curdate.daysTo(from_date);
 									else days2 = curmonth.daysTo(from_date);
-									double v3 = b_curmonth ? (account_month_beginfirst[sit->ca] - account_month_begincur[sit->ca]) : account_month_beginfirst[sit->ca];
+									double v3 = b_curmonth ? (account_month_beginfirst[*sit] - account_month_begincur[*sit]) : account_month_beginfirst[*sit];
 									double m3 = ((m - v) * (days2 + 1)) / (days + 1);
 									if(v3 > m3) m3 = v3;
 									double m2 = m - m3;
@@ -9959,7 +9792,7 @@ void Eqonomize::updateMonthlyBudget(Account *account) {
 							} else if(b_frommonth) {
 								int days, days2;
 								if(b_lastmonth) {
-									v -= account_month_endlast[sit->ca];
+									v -= account_month_endlast[*sit];
 									m = (m * curmonth.daysTo(to_date)) / dim;
 								}
 								if(b_curmonth) {
@@ -9969,14 +9802,14 @@ void Eqonomize::updateMonthlyBudget(Account *account) {
 									days = curmonth.daysTo(b_lastmonth ? to_date : monthend);
 									days2 = curmonth.daysTo(from_date);
 								}
-								double v3 = b_curmonth ? (account_month_beginfirst[sit->ca] - account_month_begincur[sit->ca]) : account_month_beginfirst[sit->ca];
+								double v3 = b_curmonth ? (account_month_beginfirst[*sit] - account_month_begincur[*sit]) : account_month_beginfirst[*sit];
 								double m3 = ((m - v) * (days2 + 1)) / (days + 1);
 								if(v3 > m3) m3 = v3;
 								double m2 = m - v - m3;
-								double v2 = v - account_month_beginfirst[sit->ca];
+								double v2 = v - account_month_beginfirst[*sit];
 								if(m2 > v2) future_change_diff += m2 - v2;
 							} else if(b_lastmonth) {
-								v -= account_month_endlast[sit->ca];
+								v -= account_month_endlast[*sit];
 								m = (m * curmonth.daysTo(to_date)) / dim;
 							}							
 							if(m > v) {
@@ -9989,16 +9822,6 @@ void Eqonomize::updateMonthlyBudget(Account *account) {
 				}
 				b_curmonth = false;
 				budget->addBudgetMonthsSetFirst(curmonth, 1);
-				if(it_n != it_e && curmonth == budget->monthToBudgetMonth(it_n.key())) {
-					it = it_n;
-					++it_n;
-				}
-				for(QVector<budget_info>::iterator sit = subs.begin(); sit != subs.end(); ++sit) {
-					if(sit->it_n != sit->it_e && curmonth == budget->monthToBudgetMonth(sit->it_n.key())) {
-						sit->it = sit->it_n;
-						++(sit->it_n);
-					}
-				}
 			} while(curmonth <= monthlast);
 		}
 
@@ -10092,7 +9915,7 @@ void Eqonomize::updateBudgetEdit() {
 				if(d >= 0.0) {
 					d_prev += d;
 					b_budget_prev = true;
-					v_prev += account_month[ca][prevmonth_end];
+					v_prev += account_month.value(ca, prevmonth_end);
 				}
 			}
 			if(!b_budget_prev) {
@@ -10106,7 +9929,7 @@ void Eqonomize::updateBudgetEdit() {
 						ca = *it_e;
 						++it_e;
 					}
-					v_prev += account_month[ca][prevmonth_end];
+					v_prev += account_month.value(ca, prevmonth_end);
 				}
 			}
 			if(!b_budget_prev) prevMonthBudgetLabel->setText(tr("%1 (with no budget)").arg(budget->formatMoney(v_prev)));
@@ -10133,8 +9956,8 @@ void Eqonomize::updateBudgetEdit() {
 		}
 		budgetButton->setEnabled(true);
 		d = ca->monthlyBudget(budget->budgetDateToMonth(prevmonth_begin));
-		if(d < 0.0) prevMonthBudgetLabel->setText(tr("%1 (with no budget)").arg(budget->formatMoney(account_month[ca][prevmonth_begin.addDays(budget->daysInBudgetMonth(prevmonth_begin) - 1)])));
-		else prevMonthBudgetLabel->setText(tr("%1 (with budget %2)").arg(budget->formatMoney(account_month[ca][prevmonth_begin.addDays(budget->daysInBudgetMonth(prevmonth_begin) - 1)])).arg(budget->formatMoney(d)));
+		if(d < 0.0) prevMonthBudgetLabel->setText(tr("%1 (with no budget)").arg(budget->formatMoney(account_month.value(ca, prevmonth_begin.addDays(budget->daysInBudgetMonth(prevmonth_begin) - 1)))));
+		else prevMonthBudgetLabel->setText(tr("%1 (with budget %2)").arg(budget->formatMoney(account_month.value(ca, prevmonth_begin.addDays(budget->daysInBudgetMonth(prevmonth_begin) - 1)))).arg(budget->formatMoney(d)));
  	}
 	budgetEdit->blockSignals(false);
 	budgetButton->blockSignals(false);
@@ -10174,31 +9997,54 @@ void Eqonomize::accountsSelectionChanged() {
 	ActionShowAccountTransactions->setEnabled(i != NULL && i != tagsItem && i != assetsItem && i != liabilitiesItem && !assets_group_items.contains(i) && !liabilities_group_items.contains(i));
 	updateBudgetEdit();
 }
-void Eqonomize::updateSecurityAccount(AssetsAccount *account, bool update_display) {
-	double value = 0.0, value_from = 0.0;
+void Eqonomize::updateSecurityAccounts(const QList<AssetsAccount*> &accounts) {
+	if(accounts.isEmpty()) return;
 	bool b_from = accountsPeriodFromButton->isChecked();
+	QHash<AssetsAccount*, int> account_index;
+	for(int i = 0; i < accounts.count(); i++) account_index[accounts[i]] = i;
+	QList<Security*> securities;
 	for(SecurityList<Security*>::const_iterator it = budget->securities.constBegin(); it != budget->securities.constEnd(); ++it) {
 		Security *security = *it;
-		if(security->account() == account) {
-			value += security->value(to_date, -1);
-			if(b_from) value_from += security->value(from_date, -1);
-		}
+		if(account_index.contains(security->account())) securities << security;
+	}
+	QVector<double> values(accounts.count(), 0.0), values_from(accounts.count(), 0.0);
+	if(!securities.isEmpty()) {
+		//securities of all accounts are valued in one portfolio calculation, which is spread over the thread pool
+		QVector<QDate> dates;
+		if(b_from && from_date < to_date) dates << from_date;
+		dates << to_date;
+		Portfolio portfolio(budget);
+		portfolio.setDates(dates);
+		portfolio.calculate(securities, -1);
+		const QVector<PortfolioSecurity> &psecurities = portfolio.securities();
+		for(QVector<PortfolioSecurity>::const_iterator it = psecurities.constBegin(); it != psecurities.constEnd(); ++it) {
+			int i = account_index.value(it->security->account());
+			values[i] += it->value.last();
+			if(b_from) values_from[i] += it->value.first();
+		}
+	}
+	for(int i = 0; i < accounts.count(); i++) {
+		AssetsAccount *account = accounts[i];
+		double value = values[i], value_from = values_from[i];
+		if(!b_from) value_from = account->initialBalance();
+		assets_accounts_value -= account->currency()->convertTo(account_value[account], budget->defaultCurrency(), to_date);
+		assets_accounts_value += account->currency()->convertTo(value, budget->defaultCurrency(), to_date);
+		assets_accounts_change -= account->currency()->convertTo(account_change[account], budget->defaultCurrency(), to_date);
+		assets_accounts_change += account->currency()->convertTo((value - value_from), budget->defaultCurrency(), to_date);
+		QString s_group = account->group();
+		assets_group_value[s_group] -= account->currency()->convertTo(account_value[account], budget->defaultCurrency(), to_date);
+		assets_group_value[s_group] += account->currency()->convertTo(value, budget->defaultCurrency(), to_date);
+		assets_group_change[s_group] -= account->currency()->convertTo(account_change[account], budget->defaultCurrency(), to_date);
+		assets_group_change[s_group] += account->currency()->convertTo((value - value_from), budget->defaultCurrency(), to_date);
+		account_value[account] = value;
+		account_change[account] = value - value_from;
 	}
-	if(!b_from) {
-		value_from = account->initialBalance();
-	}
-	assets_accounts_value -= account->currency()->convertTo(account_value[account], budget->defaultCurrency(), to_date);
-	assets_accounts_value += account->currency()->convertTo(value, budget->defaultCurrency(), to_date);
-	assets_accounts_change -= account->currency()->convertTo(account_change[account], budget->defaultCurrency(), to_date);
-	assets_accounts_change += account->currency()->convertTo((value - value_from), budget->defaultCurrency(), to_date);
-	QString s_group = account->group();
-	assets_group_value[s_group] -= account->currency()->convertTo(account_value[account], budget->defaultCurrency(), to_date);
-	assets_group_value[s_group] += account->currency()->convertTo(value, budget->defaultCurrency(), to_date);
-	assets_group_change[s_group] -= account->currency()->convertTo(account_change[account], budget->defaultCurrency(), to_date);
-	assets_group_change[s_group] += account->currency()->convertTo((value - value_from), budget->defaultCurrency(), to_date);
-	account_value[account] = value;
-	account_change[account] = value - value_from;
+}
+void Eqonomize::updateSecurityAccount(AssetsAccount *account, bool update_display) {
+	updateSecurityAccounts(QList<AssetsAccount*>() << account);
 	if(update_display) {
+		double value = account_value[account], value_from = account_value[account] - account_change[account];
+		QString s_group = account->group();
 		assetsItem->setText(VALUE_COLUMN, budget->formatMoney(assets_accounts_value) + " ");
 		assetsItem->setText(CHANGE_COLUMN, budget->formatMoney(assets_accounts_change));
 		setAccountChangeColor(assetsItem, assets_accounts_change, false);
@@ -10218,7 +10064,74 @@ void Eqonomize::updateSecurityAccount(AssetsAccount *account, bool update_displa
 		}
 	}
 }
+void Eqonomize::updateAccountValueDisplay(QTreeWidgetItem *i, Account *account) {
+	bool is_debt = (account->type() == ACCOUNT_TYPE_ASSETS && IS_DEBT((AssetsAccount*) account));
+	i->setText(CHANGE_COLUMN, account->currency()->formatValue(is_debt ? -account_change[account] : account_change[account]));
+	i->setText(VALUE_COLUMN, account->currency()->formatValue(is_debt ? -account_value[account] : account_value[account]) + " ");
+	setAccountChangeColor(i, is_debt ? -account_change[account] : account_change[account], is_debt || account->type() == ACCOUNT_TYPE_EXPENSES);
+	bool b_hide = account->isClosed() && is_zero(account_change[account]) && is_zero(account_value[account]); 
+	if(b_hide != i->isHidden()) {
+		i->setHidden(b_hide);
+		if(b_hide) assetsAccountItemHiddenOrRemoved((AssetsAccount*) account);
+		else assetsAccountItemShownOrAdded((AssetsAccount*) account);
+	}
+}
+void Eqonomize::updateTotalValueDisplay() {
+	for(QMap<QTreeWidgetItem*, QString>::iterator it = assets_group_items.begin(); it != assets_group_items.end(); ++it) {
+		it.key()->setText(CHANGE_COLUMN, budget->formatMoney(assets_group_change[it.value()]));
+		it.key()->setText(VALUE_COLUMN, budget->formatMoney(assets_group_value[it.value()]) + " ");
+		setAccountChangeColor(it.key(), assets_group_change[it.value()], false);
+	}
+	for(QMap<QTreeWidgetItem*, QString>::iterator it = liabilities_group_items.begin(); it != liabilities_group_items.end(); ++it) {
+		it.key()->setText(CHANGE_COLUMN, budget->formatMoney(-liabilities_group_change[it.value()]));
+		it.key()->setText(VALUE_COLUMN, budget->formatMoney(-liabilities_group_value[it.value()]) + " ");
+		setAccountChangeColor(it.key(), -liabilities_group_change[it.value()], true);
+	}
+	for(QMap<QTreeWidgetItem*, QString>::iterator it = tag_items.begin(); it != tag_items.end(); ++it) {
+		it.key()->setText(CHANGE_COLUMN, budget->formatMoney(tag_change[it.value()]));
+		it.key()->setText(VALUE_COLUMN, budget->formatMoney(tag_value[it.value()]) + " ");
+		setAccountChangeColor(it.key(), tag_change[it.value()], false);
+	}
+	incomesItem->setText(VALUE_COLUMN, budget->formatMoney(incomes_accounts_value) + " ");
+	incomesItem->setText(CHANGE_COLUMN, budget->formatMoney(incomes_accounts_change));
+	setAccountChangeColor(incomesItem, incomes_accounts_change, false);
+	expensesItem->setText(VALUE_COLUMN, budget->formatMoney(expenses_accounts_value) + " ");
+	expensesItem->setText(CHANGE_COLUMN, budget->formatMoney(expenses_accounts_change));
+	setAccountChangeColor(expensesItem, expenses_accounts_change, true);
+	assetsItem->setText(VALUE_COLUMN, budget->formatMoney(assets_accounts_value) + " ");
+	assetsItem->setText(CHANGE_COLUMN, budget->formatMoney(assets_accounts_change));
+	setAccountChangeColor(assetsItem, assets_accounts_change, false);
+	liabilitiesItem->setText(VALUE_COLUMN, budget->formatMoney(-liabilities_accounts_value) + " ");
+	liabilitiesItem->setText(CHANGE_COLUMN, budget->formatMoney(-liabilities_accounts_change));
+	setAccountChangeColor(liabilitiesItem, -liabilities_accounts_change, true);
+}
+void Eqonomize::updateValueDisplay() {
+	b_value_display_queued = false;
+	//wait for endBatchEdit()
+	if(in_batch_edit) return;
+	QList<AssetsAccount*> securities_accounts;
+	for(QMap<QTreeWidgetItem*, Account*>::iterator it = account_items.begin(); it != account_items.end(); ++it) {
+		Account *account = it.value();
+		if(account_display_dirty.value(account) && account->type() == ACCOUNT_TYPE_ASSETS && ((AssetsAccount*) account)->accountType() == ASSETS_TYPE_SECURITIES) securities_accounts << (AssetsAccount*) account;
+	}
+	updateSecurityAccounts(securities_accounts);
+	for(QMap<QTreeWidgetItem*, Account*>::iterator it = account_items.begin(); it != account_items.end(); ++it) {
+		Account *account = it.value();
+		if(!account_display_dirty.value(account)) continue;
+		if(account->type() != ACCOUNT_TYPE_ASSETS) updateMonthlyBudget(account);
+		updateAccountValueDisplay(it.key(), account);
+	}
+	account_display_dirty.clear();
+	updateTotalMonthlyIncomesBudget();
+	updateTotalMonthlyExpensesBudget();
+	updateTotalValueDisplay();
+}
 void Eqonomize::filterAccounts() {
+	b_month_values_valid = false;
+	filterAccountsPeriod();
+}
+void Eqonomize::filterAccountsPeriod() {
+	account_display_dirty.clear();
 	expenses_accounts_value = 0.0;
 	expenses_accounts_change = 0.0;
 	incomes_accounts_value = 0.0;
@@ -10241,6 +10154,7 @@ void Eqonomize::filterAccounts() {
 	liabilities_group_change[""] = 0.0;
 	tag_value.clear();
 	tag_change.clear();
+	QList<AssetsAccount*> securities_accounts;
 	for(AccountList<AssetsAccount*>::const_iterator it = budget->assetsAccounts.constBegin(); it != budget->assetsAccounts.constEnd(); ++it) {
 		AssetsAccount *aaccount = *it;
 		QString s_group = aaccount->group();
@@ -10255,7 +10169,7 @@ void Eqonomize::filterAccounts() {
 		if(aaccount->isSecurities()) {
 			account_value[aaccount] = 0.0;
 			account_change[aaccount] = 0.0;
-			updateSecurityAccount(aaccount, false);
+			securities_accounts << aaccount;
 		} else {
 			account_value[aaccount] = aaccount->initialBalance();
 			account_change[aaccount] = 0.0;
@@ -10265,6 +10179,7 @@ void Eqonomize::filterAccounts() {
 			else assets_group_value[s_group] += aaccount->currency()->convertTo(account_value[aaccount], budget->defaultCurrency(), to_date);
 		}
 	}
+	updateSecurityAccounts(securities_accounts);
 	QDate monthdate, monthdate_begin;
 	bool b_from = accountsPeriodFromButton->isChecked();
 	QDate lastmonth = budget->lastBudgetDay(to_date);
@@ -10274,12 +10189,11 @@ void Eqonomize::filterAccounts() {
 	budget->addBudgetMonthsSetFirst(prevmonth_begin, -1);
 	curmonth = budget->lastBudgetDay(curdate);
 	frommonth_begin = QDate();
+	account_month.clear();
 	for(AccountList<IncomesAccount*>::const_iterator it = budget->incomesAccounts.constBegin(); it != budget->incomesAccounts.constEnd(); ++it) {
 		IncomesAccount *iaccount = *it;
 		account_value[iaccount] = 0.0;
 		account_change[iaccount] = 0.0;
-		account_month[iaccount] = QMap<QDate, double>();
-		account_month[iaccount][monthdate] = 0.0;
 		account_budget[iaccount] = -1.0;
 		account_budget_diff[iaccount] = 0.0;
 		account_month_beginfirst[iaccount] = 0.0;
@@ -10295,8 +10209,6 @@ void Eqonomize::filterAccounts() {
 		ExpensesAccount *eaccount = *it;
 		account_value[eaccount] = 0.0;
 		account_change[eaccount] = 0.0;
-		account_month[eaccount] = QMap<QDate, double>();
-		account_month[eaccount][monthdate] = 0.0;
 		account_budget[eaccount] = -1.0;
 		account_budget_diff[eaccount] = 0.0;
 		account_month_beginfirst[eaccount] = 0.0;
@@ -10323,12 +10235,63 @@ void Eqonomize::filterAccounts() {
 	}
 	if(monthdate_begin > curmonth_begin) monthdate_begin = curmonth_begin;
 	monthdate = budget->lastBudgetDay(monthdate_begin);
+	//transactions in budget months before values_begin only affect account values, which are summed from the monthly values instead
+	QDate values_begin;
+	if(b_from) {
+		values_begin = from_date;
+		if(!frommonth_begin.isNull() && frommonth_begin < values_begin) values_begin = frommonth_begin;
+		if(!prevmonth_begin.isNull() && prevmonth_begin < values_begin) values_begin = prevmonth_begin;
+		if(curmonth_begin < values_begin) values_begin = curmonth_begin;
+		values_begin = budget->firstBudgetDay(values_begin);
+		if(!b_month_values_valid) {
+			account_month_value.clear();
+			tag_month_value.clear();
+			tag_month_rows.clear();
+			b_month_values_valid = true;
+			for(TransactionList<Transaction*>::const_iterator it = budget->transactions.constBegin(); it != budget->transactions.constEnd(); ++it) {
+				addTransactionMonthValue(*it);
+			}
+		}
+		QVector<double> values = account_month_value.sumBefore(budget->lastBudgetDay(values_begin));
+		for(AccountList<IncomesAccount*>::const_iterator it = budget->incomesAccounts.constBegin(); it != budget->incomesAccounts.constEnd(); ++it) {
+			IncomesAccount *iaccount = *it;
+			if(iaccount->ordinal() >= values.count()) continue;
+			account_value[iaccount] += values[iaccount->ordinal()];
+			if(iaccount->topAccount() != iaccount) account_value[iaccount->topAccount()] += values[iaccount->ordinal()];
+			incomes_accounts_value += values[iaccount->ordinal()];
+		}
+		for(AccountList<ExpensesAccount*>::const_iterator it = budget->expensesAccounts.constBegin(); it != budget->expensesAccounts.constEnd(); ++it) {
+			ExpensesAccount *eaccount = *it;
+			if(eaccount->ordinal() >= values.count()) continue;
+			account_value[eaccount] += values[eaccount->ordinal()];
+			if(eaccount->topAccount() != eaccount) account_value[eaccount->topAccount()] += values[eaccount->ordinal()];
+			expenses_accounts_value += values[eaccount->ordinal()];
+		}
+		for(AccountList<AssetsAccount*>::const_iterator it = budget->assetsAccounts.constBegin(); it != budget->assetsAccounts.constEnd(); ++it) {
+			AssetsAccount *aaccount = *it;
+			if(aaccount->ordinal() >= values.count() || aaccount == budget->balancingAccount || aaccount->accountType() == ASSETS_TYPE_SECURITIES) continue;
+			account_value[aaccount] += values[aaccount->ordinal()];
+			double cvalue = aaccount->currency()->convertTo(values[aaccount->ordinal()], budget->defaultCurrency(), to_date);
+			if(IS_DEBT(aaccount)) {
+				liabilities_accounts_value += cvalue;
+				liabilities_group_value[aaccount->group()] += cvalue;
+			} else {
+				assets_accounts_value += cvalue;
+				assets_group_value[aaccount->group()] += cvalue;
+			}
+		}
+		values = tag_month_value.sumBefore(budget->lastBudgetDay(values_begin));
+		for(QHash<QString, int>::const_iterator it = tag_month_rows.constBegin(); it != tag_month_rows.constEnd(); ++it) {
+			if(it.value() < values.count()) tag_value[it.key()] += values[it.value()];
+		}
+	}
 	bool b_future = false;
 	bool b_past = (curdate >= to_date);
 	updateBudgetAccountTitle();
 	for(TransactionList<Transaction*>::const_iterator it = budget->transactions.constBegin(); it != budget->transactions.constEnd(); ++it) {
 		Transaction *trans = *it;
 		if(trans->date() > lastmonth) break;
+		if(!values_begin.isNull() && trans->date() < values_begin) continue;
 		if(!b_past && !b_future && trans->date() >= curmonth_begin) b_future = true;
 		if(!b_from || b_future || trans->date() >= frommonth_begin || trans->date() >= prevmonth_begin) {
 			while(trans->date() > monthdate) {
@@ -10336,11 +10299,11 @@ void Eqonomize::filterAccounts() {
 				monthdate = budget->lastBudgetDay(monthdate_begin);
 				for(AccountList<IncomesAccount*>::const_iterator it = budget->incomesAccounts.constBegin(); it != budget->incomesAccounts.constEnd(); ++it) {
 					IncomesAccount *iaccount = *it;
-					account_month[iaccount][monthdate] = 0.0;
+					account_month(iaccount, monthdate) = 0.0;
 				}
 				for(AccountList<ExpensesAccount*>::const_iterator it = budget->expensesAccounts.constBegin(); it != budget->expensesAccounts.constEnd(); ++it) {
 					ExpensesAccount *eaccount = *it;
-					account_month[eaccount][monthdate] = 0.0;
+					account_month(eaccount, monthdate) = 0.0;
 				}
 			}
 			addTransactionValue(trans, trans->date(), false, false, -1, b_future, &monthdate);
@@ -10353,17 +10316,29 @@ void Eqonomize::filterAccounts() {
 		monthdate = budget->lastBudgetDay(monthdate_begin);
 		for(AccountList<IncomesAccount*>::const_iterator it = budget->incomesAccounts.constBegin(); it != budget->incomesAccounts.constEnd(); ++it) {
 			IncomesAccount *iaccount = *it;
-			account_month[iaccount][monthdate] = 0.0;
+			account_month(iaccount, monthdate) = 0.0;
 		}
 		for(AccountList<ExpensesAccount*>::const_iterator it = budget->expensesAccounts.constBegin(); it != budget->expensesAccounts.constEnd(); ++it) {
 			ExpensesAccount *eaccount = *it;
-			account_month[eaccount][monthdate] = 0.0;
+			account_month(eaccount, monthdate) = 0.0;
 		}
 	}
-	for(ScheduledTransactionList<ScheduledTransaction*>::const_iterator it = budget->scheduledTransactions.constBegin(); it != budget->scheduledTransactions.constEnd(); ++it) {
-		ScheduledTransaction *strans = *it;
-		if(strans->transaction()->date() > lastmonth) break;
-		addScheduledTransactionValue(strans, false, false);
+	ScheduleIterator sit(budget, QDate(), lastmonth);
+	while(sit.next()) {
+		ScheduledTransaction *strans = sit.scheduledTransaction();
+		if(strans->recurrence()) {
+			if(sit.date() > to_date) continue;
+			int b_future = 1;
+			if(to_date <= curdate) b_future = 0;
+			else if(strans->transaction()->date() <= curdate) b_future = -1;
+			for(int i = 0; i < sit.count(); i++) {
+				addTransactionValue(sit.transaction(i), sit.date(), false, false, 1, b_future, NULL);
+			}
+		} else {
+			for(int i = 0; i < sit.count(); i++) {
+				addTransactionValue(sit.transaction(i), strans->date(), false, false, -1, -1, NULL);
+			}
+		}
 	}
 	for(QMap<QTreeWidgetItem*, Account*>::iterator it = account_items.begin(); it != account_items.end(); ++it) {
 		switch(it.value()->type()) {
@@ -10378,44 +10353,9 @@ void Eqonomize::filterAccounts() {
 	updateTotalMonthlyIncomesBudget();
 	updateTotalMonthlyExpensesBudget();
 	for(QMap<QTreeWidgetItem*, Account*>::iterator it = account_items.begin(); it != account_items.end(); ++it) {
-		bool is_debt = (it.value()->type() == ACCOUNT_TYPE_ASSETS && IS_DEBT((AssetsAccount*) it.value()));
-		it.key()->setText(CHANGE_COLUMN, it.value()->currency()->formatValue(is_debt ? -account_change[it.value()] : account_change[it.value()]));
-		it.key()->setText(VALUE_COLUMN, it.value()->currency()->formatValue(is_debt ? -account_value[it.value()] : account_value[it.value()]) + " ");
-		setAccountChangeColor(it.key(), is_debt ? -account_change[it.value()] : account_change[it.value()], is_debt || it.value()->type() == ACCOUNT_TYPE_EXPENSES);
-		bool b_hide = it.value()->isClosed() && is_zero(account_change[it.value()]) && is_zero(account_value[it.value()]); 
-		if(b_hide != it.key()->isHidden()) {
-			it.key()->setHidden(b_hide);
-			if(b_hide) assetsAccountItemHiddenOrRemoved((AssetsAccount*) it.value());
-			else assetsAccountItemShownOrAdded((AssetsAccount*) it.value());
-		}
-	}
-	for(QMap<QTreeWidgetItem*, QString>::iterator it = assets_group_items.begin(); it != assets_group_items.end(); ++it) {
-		it.key()->setText(CHANGE_COLUMN, budget->formatMoney(assets_group_change[it.value()]));
-		it.key()->setText(VALUE_COLUMN, budget->formatMoney(assets_group_value[it.value()]) + " ");
-		setAccountChangeColor(it.key(), assets_group_change[it.value()], false);
-	}
-	for(QMap<QTreeWidgetItem*, QString>::iterator it = liabilities_group_items.begin(); it != liabilities_group_items.end(); ++it) {
-		it.key()->setText(CHANGE_COLUMN, budget->formatMoney(-liabilities_group_change[it.value()]));
-		it.key()->setText(VALUE_COLUMN, budget->formatMoney(-liabilities_group_value[it.value()]) + " ");
-		setAccountChangeColor(it.key(), -liabilities_group_change[it.value()], true);
-	}
-	for(QMap<QTreeWidgetItem*, QString>::iterator it = tag_items.begin(); it != tag_items.end(); ++it) {
-		it.key()->setText(CHANGE_COLUMN, budget->formatMoney(tag_change[it.value()]));
-		it.key()->setText(VALUE_COLUMN, budget->formatMoney(tag_value[it.value()]) + " ");
-		setAccountChangeColor(it.key(), tag_change[it.value()], false);
+		updateAccountValueDisplay(it.key(), it.value());
 	}
-	incomesItem->setText(VALUE_COLUMN, budget->formatMoney(incomes_accounts_value) + " ");
-	incomesItem->setText(CHANGE_COLUMN, budget->formatMoney(incomes_accounts_change));
-	setAccountChangeColor(incomesItem, incomes_accounts_change, false);
-	expensesItem->setText(VALUE_COLUMN, budget->formatMoney(expenses_accounts_value) + " ");
-	expensesItem->setText(CHANGE_COLUMN, budget->formatMoney(expenses_accounts_change));
-	setAccountChangeColor(expensesItem, expenses_accounts_change, true);
-	assetsItem->setText(VALUE_COLUMN, budget->formatMoney(assets_accounts_value) + " ");
-	assetsItem->setText(CHANGE_COLUMN, budget->formatMoney(assets_accounts_change));
-	setAccountChangeColor(assetsItem, assets_accounts_change, false);
-	liabilitiesItem->setText(VALUE_COLUMN, budget->formatMoney(-liabilities_accounts_value) + " ");
-	liabilitiesItem->setText(CHANGE_COLUMN, budget->formatMoney(-liabilities_accounts_change));
-	setAccountChangeColor(liabilitiesItem, -liabilities_accounts_change, true);
+	updateTotalValueDisplay();
 	budgetMonthEdit->blockSignals(true);
 	budgetMonthEdit->setDate(budget->budgetDateToMonth(to_date));
 	budgetMonthEdit->blockSignals(false);
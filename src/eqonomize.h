@@ -41,6 +41,8 @@
 #include <QStyledItemDelegate>
 #include <QTranslator>
 
+#include "account.h"
+
 #ifdef LOAD_EQZICONS_FROM_FILE
 	#ifdef RESOURCES_COMPILED
 		#define LOAD_APP_ICON(x) QIcon(ICON_DIR "/EQZ/apps/64x64/" x ".png")
@@ -147,6 +149,10 @@ class Eqonomize : public QMainWindow {
 		void addScheduledTransactionValue(ScheduledTransaction *strans, bool update_value_display, bool subtract = false);
 		void subtractTransactionValue(Transaction *trans, bool update_value_display);
 		void addTransactionValue(Transaction *trans, const QDate &transdate, bool update_value_display, bool subtract = false, int n = -1, int b_future = -1, const QDate *monthdate = NULL);
+		void addTransactionMonthValue(Transaction *trans, bool subtract = false);
+		void filterAccountsPeriod();
+		void updateAccountValueDisplay(QTreeWidgetItem *i, Account *account);
+		void updateTotalValueDisplay();
 		void appendIncomesAccount(IncomesAccount *account, QTreeWidgetItem *parent_item);
 		void appendExpensesAccount(ExpensesAccount *account, QTreeWidgetItem *parent_item);
 		void assetsAccountItemHiddenOrRemoved(AssetsAccount *account);
@@ -189,10 +195,13 @@ class Eqonomize : public QMainWindow {
 		bool exportAccountsList(QTextStream &outf, int fileformat);
 		bool exportSecuritiesList(QTextStream &outf, int fileformat);
 		void editSecurity(QTreeWidgetItem *i);
+		void updateSecurityToolTips(QTreeWidgetItem *i, Security *security, Currency *cur);
 		void appendSecurity(Security *security);
 		void updateSecurity(Security *security);
 		void updateSecurity(QTreeWidgetItem *i);
 		void updateSecurityAccount(AssetsAccount *account, bool update_display = true);
+		void updateSecurityAccounts(const QList<AssetsAccount*> &accounts);
+		void updateValueDisplay();
 		bool editSecurityTrade(SecurityTrade *ts, QWidget *parent);
 		void editSecurityTrade(SecurityTrade *ts);
 		void setModified(bool has_been_modified = true);
@@ -292,22 +301,29 @@ class Eqonomize : public QMainWindow {
 		double expenses_accounts_value, incomes_accounts_value, assets_accounts_value, liabilities_accounts_value;
 		double expenses_accounts_change, incomes_accounts_change, assets_accounts_change, liabilities_accounts_change;
 		double expenses_budget, expenses_budget_diff, incomes_budget, incomes_budget_diff;
-		QMap<Account*, double> account_value;
-		QMap<Account*, double> account_change;
+		AccountMap<double> account_value;
+		AccountMap<double> account_change;
 		QMap<QString, double> assets_group_value;
 		QMap<QString, double> assets_group_change;
 		QMap<QString, double> liabilities_group_value;
 		QMap<QString, double> liabilities_group_change;
 		QMap<QString, double> tag_value;
 		QMap<QString, double> tag_change;
-		QMap<Account*, QMap<QDate, double> > account_month;
-		QMap<Account*, double> account_month_begincur;
-		QMap<Account*, double> account_month_beginfirst;
-		QMap<Account*, double> account_month_endlast;
-		QMap<Account*, double> account_budget;
-		QMap<Account*, double> account_budget_diff;
-		QMap<Account*, double> account_future_diff;
-		QMap<Account*, double> account_future_diff_change;
+		AccountMonthMap account_month;
+		//changes of account and tag values from recorded transactions, per budget month
+		AccountMonthMap account_month_value, tag_month_value;
+		QHash<QString, int> tag_month_rows;
+		bool b_month_values_valid;
+		AccountMap<double> account_month_begincur;
+		AccountMap<double> account_month_beginfirst;
+		AccountMap<double> account_month_endlast;
+		AccountMap<double> account_budget;
+		AccountMap<double> account_budget_diff;
+		AccountMap<double> account_future_diff;
+		AccountMap<double> account_future_diff_change;
+		//accounts with values changed since the last display update, flushed once per event loop iteration by updateValueDisplay()
+		AccountMap<bool> account_display_dirty;
+		bool b_value_display_queued;
 		QMap<QTreeWidgetItem*, Account*> account_items;
 		QMap<QTreeWidgetItem*, QString> assets_group_items, liabilities_group_items, tag_items;
 		QMap<Account*, QTreeWidgetItem*> item_accounts;
@@ -381,6 +397,7 @@ class Eqonomize : public QMainWindow {
 		void socketReadyRead();
 
 		void reloadBudget();
+		void clearTransactionLists();
 
 		void showOverTimeReport();
 		void showCategoriesComparisonReport();
@@ -535,6 +552,10 @@ class Eqonomize : public QMainWindow {
 
 		void accountsModified();
 		void transactionsModified();
+		void transactionsCleared();
+		void singleTransactionAdded(Transactions*);
+		void singleTransactionModified(Transactions*, Transactions*);
+		void singleTransactionRemoved(Transactions*, Transactions*);
 		void budgetUpdated();
 		void timeToSaveConfig();
 		void tagsModified();
@@ -83,76 +83,158 @@ class LedgerListViewItem : public QTreeWidgetItem, public QObject {
 	protected:
 		Transaction *o_trans;
 		SplitTransaction *o_split;
+		LedgerDialog *dialog;
 	public:
-		LedgerListViewItem(Transaction *trans, SplitTransaction *split, QTreeWidget *parent, QString, QString = QString(), QString = QString(), QString = QString(), QString = QString(), QString = QString(), QString = QString(), QString = QString(), QString = QString(), QString = QString(), QString = QString());
-		void setReconciled(int, int);
-		void updateMark(int);
-		void setColors();
+		LedgerListViewItem(Transaction *trans, SplitTransaction *split, LedgerDialog *parent_dialog, double change = 0.0, int reconciled = -1, bool other_account = false);
+		QVariant data(int column, int role) const;
+		void setReconciled(int);
 		Transaction *transaction() const;
 		SplitTransaction *splitTransaction() const;
+		QDate date() const;
+		qint64 timestamp() const;
+		double balance() const;
 		bool matches(const QString&) const;
-		double d_balance;
+		double d_change;
 		bool b_other_account;
 		int b_reconciled;
+		int i_row;
 };
 
-LedgerListViewItem::LedgerListViewItem(Transaction *trans, SplitTransaction *split, QTreeWidget *parent, QString s1, QString s2, QString s3, QString s4, QString s5, QString s6, QString s7, QString s8, QString s9, QString s10, QString s11) : QTreeWidgetItem(parent), o_trans(trans), o_split(split), b_other_account(false), b_reconciled(-1) {
-	setText(1, s1);
-	setText(2, s2);
-	setText(3, s3);
-	setText(4, s4);
-	setText(5, s5);
-	setText(6, s6);
-	setText(7, s7);
-	setText(9, s8);
-	setText(10, s9);
-	setText(11, s10);
-	setText(8, s11);
-	setTextAlignment(8, Qt::AlignRight | Qt::AlignVCenter);
-	setTextAlignment(9, Qt::AlignRight | Qt::AlignVCenter);
-	setTextAlignment(10, Qt::AlignRight | Qt::AlignVCenter);
-	setTextAlignment(11, Qt::AlignRight | Qt::AlignVCenter);
-	setTextAlignment(0, Qt::AlignCenter | Qt::AlignVCenter);
-	if(parent) {
-		if(!expenseColor.isValid()) expenseColor = createExpenseColor(this, 8);
-		setForeground(8, expenseColor);
-		if(!incomeColor.isValid()) incomeColor = createIncomeColor(this, 9);
-		setForeground(9, incomeColor);
-		setForeground(10, expenseColor);
-	}
-}
-void LedgerListViewItem::setReconciled(int b, int mark) {
-	b_reconciled = b;
-	if(b < 0) {
-		setCheckState(0, Qt::Unchecked);
-	} else if(b) {
-		setCheckState(0, Qt::Checked);
-	} else {
-		setCheckState(0, Qt::Unchecked);
-	}
-	updateMark(mark);
+LedgerListViewItem::LedgerListViewItem(Transaction *trans, SplitTransaction *split, LedgerDialog *parent_dialog, double change, int reconciled, bool other_account) : QTreeWidgetItem(UserType), o_trans(trans), o_split(split), dialog(parent_dialog), d_change(change), b_other_account(other_account), b_reconciled(reconciled), i_row(-1) {
+	if(b_reconciled < 0 && dialog->reconcileButton->isChecked()) setDisabled(true);
 }
-void LedgerListViewItem::updateMark(int mark) {
-	if(mark < -1) return;
-	QBrush br;
-	if(mark == 0 || (mark > 0 && b_reconciled != 0)) {
-		br = treeWidget()->viewport()->palette().alternateBase();
-	} else if(mark > 0) {
-		br = treeWidget()->viewport()->palette().base();
-	}
-	if(background(1) != br) {
-		for(int c = 0; c <= 11; c++) {
-			setBackground(c, br);
+QVariant LedgerListViewItem::data(int column, int role) const {
+	if(role == Qt::DisplayRole) {
+		Currency *cur = dialog->account->currency();
+		if(!o_trans && !o_split) {
+			if(column <= 2 || column == 4 || column == 5) return QString("-");
+			if(column == 3) return LedgerDialog::tr("Opening balance", "Account balance");
+			if(column == 11) return cur->formatValue(dialog->account->initialBalance());
+			return QVariant();
+		}
+		switch(column) {
+			case 1: {return QLocale().toString(date(), QLocale::ShortFormat);}
+			case 11: {return cur->formatValue(balance());}
+		}
+		if(o_split) {
+			double value = d_change;
+			switch(column) {
+				case 2: {
+					if(o_split->type() == SPLIT_TRANSACTION_TYPE_LOAN) return LedgerDialog::tr("Debt Payment");
+					return LedgerDialog::tr("Split Transaction");
+				}
+				case 3: {return o_split->description();}
+				case 4: {
+					if(o_split->type() == SPLIT_TRANSACTION_TYPE_LOAN) return ((DebtPayment*) o_split)->loan()->name();
+					return ((MultiItemTransaction*) o_split)->fromAccountsString();
+				}
+				case 5: {
+					if(o_split->type() == SPLIT_TRANSACTION_TYPE_LOAN) return ((DebtPayment*) o_split)->loan()->maintainer();
+					return o_split->payeeText();
+				}
+				case 6: {return o_split->tagsText();}
+				case 7: {return o_split->comment();}
+				case 9: {if(value >= 0.0) return cur->formatValue(value); break;}
+				case 10: {if(value < 0.0) return cur->formatValue(-value); break;}
+			}
+			return QVariant();
+		}
+		if(o_trans->parentSplit() && o_trans->parentSplit()->type() == SPLIT_TRANSACTION_TYPE_LOAN) {
+			DebtPayment *lsplit = (DebtPayment*) o_trans->parentSplit();
+			if(o_trans->subtype() == TRANSACTION_SUBTYPE_DEBT_REDUCTION) {
+				double value = d_change;
+				switch(column) {
+					case 2: {return LedgerDialog::tr("Debt Payment");}
+					case 3: {return LedgerDialog::tr("Reduction");}
+					case 4: {return o_trans->fromAccount()->name();}
+					case 5: {return lsplit->loan()->maintainer();}
+					case 6: {return o_trans->tagsText(true);}
+					case 7: {return lsplit->comment();}
+					case 9: {if(value >= 0.0) return cur->formatValue(value); break;}
+					case 10: {if(value < 0.0) return cur->formatValue(-value); break;}
+				}
+				return QVariant();
+			}
+			double value = o_trans->value();
+			switch(column) {
+				case 2: {return LedgerDialog::tr("Debt Payment");}
+				case 3: {
+					if(o_trans->subtype() == TRANSACTION_SUBTYPE_DEBT_FEE) return LedgerDialog::tr("Fee");
+					return LedgerDialog::tr("Interest");
+				}
+				case 4: {return o_trans->fromAccount()->name();}
+				case 5: {
+					if(o_trans->subtype() == TRANSACTION_SUBTYPE_DEBT_FEE) return ((DebtFee*) o_trans)->payee();
+					return ((DebtInterest*) o_trans)->payee();
+				}
+				case 6: {return o_trans->tagsText(true);}
+				case 7: {return lsplit->comment();}
+				case 8: {if(b_other_account) return cur->formatValue(value); break;}
+				case 9: {if(b_other_account && value < 0.0) return cur->formatValue(-value); break;}
+				case 10: {if(!b_other_account && value >= 0.0) return cur->formatValue(value); break;}
+			}
+			return QVariant();
+		}
+		double value = d_change;
+		switch(column) {
+			case 2: {
+				if(o_trans->type() == TRANSACTION_TYPE_INCOME) {
+					if(value >= 0.0) return LedgerDialog::tr("Income");
+					return LedgerDialog::tr("Repayment");
+				} else if(o_trans->type() == TRANSACTION_TYPE_EXPENSE) {
+					if(value <= 0.0) return LedgerDialog::tr("Expense");
+					return LedgerDialog::tr("Refund");
+				} else if(o_trans->relatesToAccount(dialog->budget->balancingAccount)) {
+					return LedgerDialog::tr("Account Balance Adjustment");
+				}
+				return LedgerDialog::tr("Transfer");
+			}
+			case 3: {return o_trans->description();}
+			case 4: {
+				if(dialog->account == o_trans->fromAccount()) return o_trans->toAccount()->name();
+				return o_trans->fromAccount()->name();
+			}
+			case 5: {return o_trans->payeeText();}
+			case 6: {return o_trans->tagsText(true);}
+			case 7: {return o_trans->comment();}
+			case 9: {if(value >= 0.0) return cur->formatValue(value); break;}
+			case 10: {if(value < 0.0) return cur->formatValue(-value); break;}
+		}
+		return QVariant();
+	} else if(role == Qt::TextAlignmentRole) {
+		if(column == 0) return (int) (Qt::AlignCenter | Qt::AlignVCenter);
+		if(column >= 8) return (int) (Qt::AlignRight | Qt::AlignVCenter);
+		return QVariant();
+	} else if(role == Qt::ForegroundRole) {
+		if(column == 8 || column == 10) return QBrush(expenseColor);
+		if(column == 9) return QBrush(incomeColor);
+		return QVariant();
+	} else if(role == Qt::BackgroundRole) {
+		if(!dialog->reconcileButton->isChecked()) return QVariant();
+		if(!o_trans && !o_split) return treeWidget()->viewport()->palette().alternateBase();
+		if(b_reconciled != 0 || date() > dialog->reconcileEndEdit->date()) return treeWidget()->viewport()->palette().alternateBase();
+		return treeWidget()->viewport()->palette().base();
+	} else if(role == Qt::CheckStateRole) {
+		if(column != 0) return QVariant();
+		return b_reconciled > 0 ? Qt::Checked : Qt::Unchecked;
+	} else if(role == Qt::DecorationRole) {
+		if(column < 8) return QVariant();
+		SplitTransaction *split = o_split;
+		if(!split && o_trans) split = o_trans->parentSplit();
+		if((!o_trans || o_trans->associatedFile().isEmpty()) && (!split || split->associatedFile().isEmpty())) return QVariant();
+		int icon_column = d_change >= 0.0 ? 9 : 10;
+		if(o_trans && split && split->type() == SPLIT_TRANSACTION_TYPE_LOAN && o_trans->subtype() != TRANSACTION_SUBTYPE_DEBT_REDUCTION) {
+			if(b_other_account) icon_column = 8;
+			else icon_column = o_trans->value() >= 0.0 ? 10 : 9;
 		}
+		if(column != icon_column) return QVariant();
+		return LOAD_ICON_STATUS("mail-attachment");
 	}
-	if(isDisabled() != (mark >= 0 && b_reconciled < 0)) setDisabled(mark >= 0 && b_reconciled < 0);
+	return QTreeWidgetItem::data(column, role);
 }
-void LedgerListViewItem::setColors() { 
-	if(!expenseColor.isValid()) expenseColor = createExpenseColor(this, 8);
-	setForeground(8, expenseColor);
-	if(!incomeColor.isValid()) incomeColor = createIncomeColor(this, 9);
-	setForeground(9, incomeColor);
-	setForeground(10, expenseColor);
+void LedgerListViewItem::setReconciled(int b) {
+	b_reconciled = b;
+	emitDataChanged();
 }
 Transaction *LedgerListViewItem::transaction() const {
 	return o_trans;
@@ -160,6 +242,21 @@ Transaction *LedgerListViewItem::transaction() const {
 SplitTransaction *LedgerListViewItem::splitTransaction() const {
 	return o_split;
 }
+QDate LedgerListViewItem::date() const {
+	if(o_split) return o_split->date();
+	if(o_trans) return o_trans->date();
+	return QDate();
+}
+qint64 LedgerListViewItem::timestamp() const {
+	if(o_split) return o_split->timestamp();
+	if(o_trans && o_trans->parentSplit() && o_trans->parentSplit()->type() == SPLIT_TRANSACTION_TYPE_LOAN) return o_trans->parentSplit()->timestamp();
+	if(o_trans) return o_trans->timestamp();
+	return 0;
+}
+double LedgerListViewItem::balance() const {
+	if(i_row < 0) return dialog->account->initialBalance();
+	return dialog->rowBalance(i_row);
+}
 bool LedgerListViewItem::matches(const QString &str) const {
 	for(int i = 3; i <= 7; i++) {
 		if(!treeWidget()->isColumnHidden(i) && text(i).contains(str, Qt::CaseInsensitive)) return true;
@@ -176,6 +273,7 @@ LedgerDialog::LedgerDialog(AssetsAccount *acc, Budget *budg, Eqonomize *parent,
 	listMenu = NULL;
 	
 	key_event = NULL;
+	b_rows_updated = false;
 	
 	re1 = 0;
 	re2 = 0;
@@ -391,7 +489,11 @@ LedgerDialog::LedgerDialog(AssetsAccount *acc, Budget *budg, Eqonomize *parent,
 	connect(printButton, SIGNAL(clicked()), this, SLOT(printView()));
 	connect(editAccountButton, SIGNAL(clicked()), this, SLOT(editAccount()));
 	connect(accountCombo, SIGNAL(activated(int)), this, SLOT(accountActivated(int)));
-	connect(mainWin, SIGNAL(transactionsModified()), this, SLOT(updateTransactions()));
+	connect(mainWin, SIGNAL(singleTransactionAdded(Transactions*)), this, SLOT(transactionAdded(Transactions*)));
+	connect(mainWin, SIGNAL(singleTransactionModified(Transactions*, Transactions*)), this, SLOT(transactionModified(Transactions*, Transactions*)));
+	connect(mainWin, SIGNAL(singleTransactionRemoved(Transactions*, Transactions*)), this, SLOT(transactionRemoved(Transactions*, Transactions*)));
+	connect(mainWin, SIGNAL(transactionsModified()), this, SLOT(transactionsModified()));
+	connect(mainWin, SIGNAL(transactionsCleared()), this, SLOT(transactionsCleared()));
 	connect(mainWin, SIGNAL(accountsModified()), this, SLOT(updateAccounts()));
 	connect(reconcileButton, SIGNAL(toggled(bool)), this, SLOT(toggleReconciliation(bool)));
 	connect(markReconciledButton, SIGNAL(clicked()), this, SLOT(markAsReconciled()));
@@ -439,53 +541,69 @@ void LedgerDialog::keyPressEvent(QKeyEvent *e) {
 		delete key_event;
 	}
 }
+void LedgerDialog::appendRow(LedgerListViewItem *i) {
+	int index = v_rows.size();
+	if(index % LEDGER_CHECKPOINT_INTERVAL == 0) {
+		v_balance_checkpoints << (index == 0 ? account->initialBalance() : rowBalance(index - 1));
+		v_reconciled_checkpoints << reconciledSum(index);
+	}
+	i->i_row = index;
+	v_rows << i;
+}
+double LedgerDialog::rowBalance(int index) const {
+	int c = index / LEDGER_CHECKPOINT_INTERVAL;
+	double balance = v_balance_checkpoints[c];
+	for(int i = c * LEDGER_CHECKPOINT_INTERVAL; i <= index; i++) balance += v_rows[i]->d_change;
+	return balance;
+}
+double LedgerDialog::reconciledSum(int index) const {
+	int c = index / LEDGER_CHECKPOINT_INTERVAL;
+	if(c >= v_reconciled_checkpoints.size()) c = v_reconciled_checkpoints.size() - 1;
+	if(c < 0) return 0.0;
+	double sum = v_reconciled_checkpoints[c];
+	for(int i = c * LEDGER_CHECKPOINT_INTERVAL; i < index; i++) {
+		if(v_rows[i]->b_reconciled > 0) sum += v_rows[i]->d_change;
+	}
+	return sum;
+}
+void LedgerDialog::addReconciledChange(int index, double change) {
+	for(int c = index / LEDGER_CHECKPOINT_INTERVAL + 1; c < v_reconciled_checkpoints.size(); c++) v_reconciled_checkpoints[c] += change;
+}
+int LedgerDialog::rowIndex(const QDate &date, bool after) const {
+	int low = 0, high = v_rows.size();
+	while(low < high) {
+		int mid = (low + high) / 2;
+		QDate mid_date = v_rows[mid]->date();
+		if(mid_date < date || (after && mid_date == date)) low = mid + 1;
+		else high = mid;
+	}
+	return low;
+}
+void LedgerDialog::setRowReconciled(LedgerListViewItem *i, bool b) {
+	if((i->b_reconciled > 0) == b) return;
+	i->setReconciled(b);
+	if(i->i_row >= 0) addReconciledChange(i->i_row, b ? i->d_change : -i->d_change);
+	QDate date = i->date();
+	if(date <= reconcileEndEdit->date()) {
+		if(date < reconcileStartEdit->date()) d_rec_op += b ? i->d_change : -i->d_change;
+		d_rec_cl += b ? i->d_change : -i->d_change;
+	}
+}
 void LedgerDialog::updateReconciliationStats(bool b_toggled, bool scroll_to, bool update_markers) {
 	if(!account) return;
 	QDate d_start = reconcileStartEdit->date();
 	QDate d_end = reconcileEndEdit->date();
 	if(!d_start.isValid() || !d_end.isValid()) return;
-	double d_rec_ch = 0.0;
-	d_book_op = account->initialBalance();
-	d_book_cl = account->initialBalance();
-	d_rec_op = account->initialBalance();
-	bool b_started = false, b_finished = false;;
-	LedgerListViewItem *i_first = NULL, *i_last = NULL;
-	transactionsView->model()->blockSignals(true);
-	QTreeWidgetItemIterator it(transactionsView, QTreeWidgetItemIterator::All);
-	while(*it) {
-		LedgerListViewItem *i = (LedgerListViewItem*) *it;
-		Transactions *trans = i->transaction();
-		if(i->splitTransaction()) trans = i->splitTransaction();
-		if(!trans) {
-			i->updateMark(0);
-			break;
-		}
-		if(!b_finished && trans->date() < d_start) {
-			d_book_op = i->d_balance;
-			b_finished = true;
-		}
-		if(!b_finished && trans->date() <= d_end) {
-			if(!b_started) {
-				b_started = true;
-				d_book_cl = i->d_balance;
-				i_first = i;
-			}
-			i_last = i;
-			if(update_markers) i->updateMark(1);
-		}
-		if(b_started && trans->isReconciled(account)) {
-			if(b_finished) d_rec_op += trans->accountChange(account);
-			else d_rec_ch += trans->accountChange(account);
-			
-		}
-		if(update_markers && (b_finished || !b_started)) i->updateMark(b_finished ? 2 : 0);
-		++it;
-	}
-	transactionsView->model()->blockSignals(false);
-	transactionsView->dataChanged(QModelIndex(), QModelIndex());
-	if(scroll_to && i_first && i_last) {
-		transactionsView->scrollToItem(i_first);
-		transactionsView->scrollToItem(i_last);
+	int index_start = rowIndex(d_start);
+	int index_end = rowIndex(d_end, true);
+	d_book_op = index_start > 0 ? rowBalance(index_start - 1) : account->initialBalance();
+	d_book_cl = index_end > 0 ? rowBalance(index_end - 1) : account->initialBalance();
+	d_rec_op = account->initialBalance() + reconciledSum(index_start);
+	double d_rec_ch = reconciledSum(index_end) - reconciledSum(index_start);
+	if(update_markers) transactionsView->viewport()->update();
+	if(scroll_to && index_end > index_start) {
+		transactionsView->scrollToItem(v_rows[b_ascending ? index_start : index_end - 1]);
+		transactionsView->scrollToItem(v_rows[b_ascending ? index_end - 1 : index_start]);
 	}
 	if(b_toggled || re1 == 0) {
 		reconcileOpeningEdit->blockSignals(true);
@@ -562,19 +680,17 @@ void LedgerDialog::toggleReconciliation(bool b) {
 	transactionsView->setAlternatingRowColors(!b);
 	reconcileWidget->setVisible(b);
 	markReconciledButton->setVisible(b);
+	transactionsView->model()->blockSignals(true);
+	for(int index = 0; index < transactionsView->topLevelItemCount(); index++) {
+		LedgerListViewItem *i = (LedgerListViewItem*) transactionsView->topLevelItem(index);
+		if(i->b_reconciled < 0) i->setDisabled(b);
+	}
+	transactionsView->model()->blockSignals(false);
 	if(b) {
 		updateReconciliationStats(true, true, true);
 		reconcileStartEdit->setFocus();
 	} else {
-		transactionsView->model()->blockSignals(true);
-		QTreeWidgetItemIterator it(transactionsView, QTreeWidgetItemIterator::All);
-		while(*it) {
-			LedgerListViewItem *i = (LedgerListViewItem*) *it;
-			i->updateMark(-1);
-			++it;
-		}
-		transactionsView->model()->blockSignals(false);
-		transactionsView->dataChanged(QModelIndex(), QModelIndex());
+		transactionsView->viewport()->update();
 	}
 }
 void LedgerDialog::reconcileStartDateChanged(const QDate &date) {
@@ -658,16 +774,7 @@ void LedgerDialog::transactionActivated(QTreeWidgetItem *i, int c) {
 			trans->setReconciled(account, b);
 			trans->setModified();
 			if(trans->isReconciled(account) == b) {
-				if(trans->date() <= reconcileEndEdit->date()) {
-					if(b) {
-						if(trans->date() < reconcileStartEdit->date()) d_rec_op += trans->accountChange(account);
-						d_rec_cl += trans->accountChange(account);
-					} else {
-						if(trans->date() < reconcileStartEdit->date()) d_rec_op -= trans->accountChange(account);
-						d_rec_cl -= trans->accountChange(account);
-					}
-				}
-				li->setReconciled(b, trans->date() > reconcileEndEdit->date() ? 0 : (trans->date() >= reconcileStartEdit->date() ? 1 : 2));
+				setRowReconciled(li, b);
 				updateReconciliationStatLabels();
 				mainWin->setModified(true);
 			}
@@ -687,11 +794,7 @@ void LedgerDialog::reconcileTransactions() {
 				trans->setReconciled(account, true);
 				trans->setModified();
 				if(trans->isReconciled(account)) {
-					if(trans->date() <= reconcileEndEdit->date()) {
-						if(trans->date() < reconcileStartEdit->date()) d_rec_op += trans->accountChange(account);
-						d_rec_cl += trans->accountChange(account);
-					}
-					i->setReconciled(true, trans->date() > reconcileEndEdit->date() ? 0 : (trans->date() >= reconcileStartEdit->date() ? 1 : 2));
+					setRowReconciled(i, true);
 					b = true;
 				}
 			}
@@ -699,42 +802,33 @@ void LedgerDialog::reconcileTransactions() {
 	}
 	transactionsView->model()->blockSignals(false);
 	if(b) {
-		transactionsView->dataChanged(QModelIndex(), QModelIndex());
+		transactionsView->viewport()->update();
 		updateReconciliationStatLabels();
 		mainWin->setModified(true);
 	}
 }
 void LedgerDialog::markAsReconciled() {
-	QTreeWidgetItemIterator it(transactionsView, QTreeWidgetItemIterator::All);
 	QDate d_end = reconcileEndEdit->date();
 	if(!d_end.isValid()) return;
-	bool b_started = false;
 	bool b = false;
+	int index_end = rowIndex(d_end, true);
 	transactionsView->model()->blockSignals(true);
-	while(*it) {
-		LedgerListViewItem *i = (LedgerListViewItem*) *it;
+	for(int index = 0; index < index_end; index++) {
+		LedgerListViewItem *i = v_rows[index];
 		if(i->b_reconciled == 0) {
 			Transactions *trans = i->transaction();
 			if(i->splitTransaction()) trans = i->splitTransaction();
-			if(trans && (b_started || trans->date() <= d_end)) {
-				b_started = true;
-				trans->setReconciled(account, true);
-				trans->setModified();
-				if(trans->isReconciled(account)) {
-					if(trans->date() <= reconcileEndEdit->date()) {
-						if(trans->date() < reconcileStartEdit->date()) d_rec_op += trans->accountChange(account);
-						d_rec_cl += trans->accountChange(account);
-					}
-					i->setReconciled(true, trans->date() > reconcileEndEdit->date() ? 0 : (trans->date() >= reconcileStartEdit->date() ? 1 : 2));
-					b = true;
-				}
+			trans->setReconciled(account, true);
+			trans->setModified();
+			if(trans->isReconciled(account)) {
+				setRowReconciled(i, true);
+				b = true;
 			}
 		}
-		++it;
 	}
 	transactionsView->model()->blockSignals(false);
 	if(b) {
-		transactionsView->dataChanged(QModelIndex(), QModelIndex());
+		transactionsView->viewport()->update();
 		updateReconciliationStatLabels();
 		mainWin->setModified(true);
 	}
@@ -1178,13 +1272,13 @@ void LedgerDialog::transactionSelectionChanged() {
 					quantity++;
 					if(b_continuous) {
 						if(last_date.isValid() && trans->date() != last_date) total_balance += previous_balance * last_date.daysTo(trans->date());
-						previous_balance = i->d_balance;
+						previous_balance = i->balance();
 						last_date = trans->date();
 						if(!first_date.isValid()) first_date = last_date;
 					}
 				}
 			} else {
-				v += i->d_balance;
+				v += i->balance();
 				b_initial = true;
 			}
 		}
@@ -1426,6 +1520,178 @@ void LedgerDialog::edit(QTreeWidgetItem *qwi, int c) {
 		else if(i->transaction()) mainWin->editTransaction(i->transaction(), this);
 	}
 }
+void LedgerDialog::createRows(Transactions *transs, QList<LedgerListViewItem*> &rows) {
+	if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT) {
+		SplitTransaction *split = (SplitTransaction*) transs;
+		if(split->type() == SPLIT_TRANSACTION_TYPE_MULTIPLE_ITEMS && ((MultiItemTransaction*) split)->account() == account) {
+			rows << new LedgerListViewItem(NULL, split, this, split->accountChange(account), split->isReconciled(account));
+		} else if(split->type() == SPLIT_TRANSACTION_TYPE_LOAN) {
+			DebtPayment *lsplit = (DebtPayment*) split;
+			if(lsplit->loan() == account) {
+				Transaction *ltrans = lsplit->paymentTransaction();
+				if(ltrans) rows << new LedgerListViewItem(ltrans, NULL, this, ltrans->toValue(), ltrans->isReconciled(account));
+				ltrans = lsplit->feeTransaction();
+				if(ltrans) {
+					bool to_balance = (ltrans->fromAccount() == account);
+					rows << new LedgerListViewItem(ltrans, NULL, this, to_balance ? -ltrans->value() : 0.0, to_balance ? ltrans->isReconciled(account) : -1, !to_balance);
+				}
+				ltrans = lsplit->interestTransaction();
+				if(ltrans) {
+					bool to_balance = (ltrans->fromAccount() == account);
+					rows << new LedgerListViewItem(ltrans, NULL, this, to_balance ? -ltrans->value() : 0.0, to_balance ? ltrans->isReconciled(account) : -1, !to_balance);
+				}
+			} else if(lsplit->account() == account) {
+				double value = split->accountChange(account);
+				if(value != 0.0) rows << new LedgerListViewItem(NULL, split, this, value, split->isReconciled(account));
+			}
+		}
+	} else if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SINGLE) {
+		Transaction *trans = (Transaction*) transs;
+		if(trans->relatesToAccount(account) && (!trans->parentSplit() || trans->parentSplit()->type() == SPLIT_TRANSACTION_TYPE_MULTIPLE_ACCOUNTS || (trans->parentSplit()->type() == SPLIT_TRANSACTION_TYPE_MULTIPLE_ITEMS && ((MultiItemTransaction*) trans->parentSplit())->account() != account))) {
+			bool b_balancing = trans->type() != TRANSACTION_TYPE_INCOME && trans->type() != TRANSACTION_TYPE_EXPENSE && trans->relatesToAccount(budget->balancingAccount);
+			rows << new LedgerListViewItem(trans, NULL, this, trans->accountChange(account), b_balancing ? -1 : trans->isReconciled(account));
+		}
+	}
+}
+void LedgerDialog::updateStats() {
+	double balance = account->initialBalance();
+	double total_balance = 0.0;
+	double previous_balance = balance;
+	QDate previous_date, first_date;
+	double reductions = 0.0;
+	double expenses = 0.0;
+	int quantity = 0;
+	for(int index = 0; index < v_rows.size(); index++) {
+		LedgerListViewItem *i = v_rows[index];
+		Transaction *trans = i->transaction();
+		if(trans && trans->parentSplit() && trans->parentSplit()->type() == SPLIT_TRANSACTION_TYPE_LOAN) {
+			reductions += i->d_change;
+			if(trans->subtype() != TRANSACTION_SUBTYPE_DEBT_REDUCTION) expenses += trans->value();
+		}
+		if(i->b_other_account) continue;
+		balance += i->d_change;
+		quantity++;
+		QDate date = i->date();
+		if(previous_date.isValid() && date != previous_date) total_balance += previous_balance * previous_date.daysTo(date);
+		previous_balance = balance;
+		previous_date = date;
+		if(!first_date.isValid()) first_date = previous_date;
+	}
+	if(previous_date.isValid() && previous_date < QDate::currentDate()) previous_balance *= previous_date.daysTo(QDate::currentDate());
+	total_balance += previous_balance;
+	if(first_date.isValid() && first_date < QDate::currentDate()) total_balance /= (first_date.daysTo(QDate::currentDate()) + (previous_date == QDate::currentDate() ? 1 : 0));
+	if(account->accountType() == ASSETS_TYPE_LIABILITIES || account->accountType() == ASSETS_TYPE_CREDIT_CARD) {
+		stat_total_text = QString("<div align=\"right\"><b>%1</b> %4 &nbsp; <b>%2</b> %5 &nbsp; <b>%3</b> %6</div>").arg(tr("Current debt:")).arg(tr("Total debt reduction:")).arg(tr("Total interest and fees:")).arg(account->currency()->formatValue(-balance)).arg(account->currency()->formatValue(reductions)).arg(account->currency()->formatValue(expenses));
+	} else {
+		stat_total_text = QString("<div align=\"right\"><b>%1</b> %4 &nbsp; <b>%2</b> %5 &nbsp; <b>%3</b> %6</div>").arg(tr("Current balance:", "Account balance")).arg(tr("Average balance:", "Account balance")).arg(tr("Number of transactions:")).arg(account->currency()->formatValue(balance)).arg(account->currency()->formatValue(total_balance)).arg(budget->formatValue(quantity, 0));
+	}
+	statLabel->setText(stat_total_text);
+}
+void LedgerDialog::updateCheckpoints(int index) {
+	int c = index / LEDGER_CHECKPOINT_INTERVAL;
+	if(c > v_balance_checkpoints.size()) c = v_balance_checkpoints.size();
+	v_balance_checkpoints.resize(c);
+	v_reconciled_checkpoints.resize(c);
+	double balance = (c == 0 ? account->initialBalance() : rowBalance(c * LEDGER_CHECKPOINT_INTERVAL - 1));
+	double reconciled = reconciledSum(c * LEDGER_CHECKPOINT_INTERVAL);
+	for(int i = c * LEDGER_CHECKPOINT_INTERVAL; i < v_rows.size(); i++) {
+		if(i % LEDGER_CHECKPOINT_INTERVAL == 0) {
+			v_balance_checkpoints << balance;
+			v_reconciled_checkpoints << reconciled;
+		}
+		LedgerListViewItem *row = v_rows[i];
+		row->i_row = i;
+		balance += row->d_change;
+		if(row->b_reconciled > 0) reconciled += row->d_change;
+	}
+}
+bool LedgerDialog::updateRows(Transactions *transs, bool removed) {
+	if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SCHEDULE) return true;
+	if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SINGLE && ((Transaction*) transs)->parentSplit()) {
+		transs = ((Transaction*) transs)->parentSplit();
+		removed = false;
+	}
+	SplitTransaction *split = NULL;
+	if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT) {
+		split = (SplitTransaction*) transs;
+		// the parts of a split up transaction are left without notifications
+		if(split->count() == 0) return false;
+	}
+	int index_first = v_rows.size();
+	bool b_selected = false, b_found = false;
+	for(int index = v_rows.size() - 1; index >= 0; index--) {
+		LedgerListViewItem *i = v_rows[index];
+		bool b_match = (i->splitTransaction() == transs || i->transaction() == transs);
+		if(split && !b_match && i->transaction()) {
+			for(int i_part = 0; i_part < split->count(); i_part++) {
+				if(split->at(i_part) == i->transaction()) {
+					b_match = true;
+					break;
+				}
+			}
+		}
+		if(b_match) {
+			if(i->isSelected()) b_selected = true;
+			v_rows.remove(index);
+			delete i;
+			index_first = index;
+			b_found = true;
+		}
+	}
+	// a removed part of a split with a single ledger row, which can no longer be found
+	if(!b_found && removed && !split && transs->relatesToAccount(account) && transs->date() <= QDate::currentDate()) return false;
+	QList<LedgerListViewItem*> rows;
+	if(!removed && transs->date() <= QDate::currentDate()) {
+		createRows(transs, rows);
+		if(split) {
+			for(int index = 0; index < split->count(); index++) createRows(split->at(index), rows);
+		}
+	}
+	if(!rows.isEmpty()) {
+		int index = rowIndex(transs->date(), true);
+		while(index > 0 && v_rows[index - 1]->date() == transs->date() && v_rows[index - 1]->timestamp() > transs->timestamp()) index--;
+		int n_opening = transactionsView->topLevelItemCount() - v_rows.size();
+		QList<QTreeWidgetItem*> items;
+		for(int i = 0; i < rows.size(); i++) {
+			v_rows.insert(index + i, rows[i]);
+			if(b_ascending) items << rows[i];
+			else items.prepend(rows[i]);
+		}
+		transactionsView->insertTopLevelItems(b_ascending ? n_opening + index : v_rows.size() - index - rows.size(), items);
+		if(b_selected) {
+			for(int i = 0; i < rows.size(); i++) rows[i]->setSelected(true);
+		}
+		if(index < index_first) index_first = index;
+	}
+	if(index_first < v_rows.size() || b_found) {
+		updateCheckpoints(index_first);
+		updateStats();
+		if(reconcileButton->isChecked()) updateReconciliationStats();
+		transactionsView->viewport()->update();
+	}
+	return true;
+}
+void LedgerDialog::transactionAdded(Transactions *transs) {
+	b_rows_updated = updateRows(transs, false);
+}
+void LedgerDialog::transactionModified(Transactions *transs, Transactions*) {
+	b_rows_updated = updateRows(transs, false);
+}
+void LedgerDialog::transactionRemoved(Transactions *transs, Transactions*) {
+	b_rows_updated = updateRows(transs, true);
+}
+void LedgerDialog::transactionsModified() {
+	if(b_rows_updated) b_rows_updated = false;
+	else updateTransactions();
+}
+void LedgerDialog::transactionsCleared() {
+	//rows are formatted lazily from the transactions, which are about to be freed
+	transactionsView->clear();
+	v_rows.clear();
+	v_balance_checkpoints.clear();
+	v_reconciled_checkpoints.clear();
+	b_rows_updated = false;
+}
 void LedgerDialog::updateTransactions(bool update_reconciliation_date) {
 	int scroll_h = transactionsView->horizontalScrollBar()->value();
 	int scroll_v = transactionsView->verticalScrollBar()->value();
@@ -1438,22 +1704,16 @@ void LedgerDialog::updateTransactions(bool update_reconciliation_date) {
 		if(!selected_split) selected_transaction = i->transaction();
 	}
 	transactionsView->clear();
-	double balance = account->initialBalance();
-	double total_balance = 0.0;
-	double previous_balance = 0.0;
-	QDate previous_date;
-	double reductions = 0.0;
-	double expenses = 0.0;
-	int quantity = 0;
+	v_rows.clear();
+	v_balance_checkpoints.clear();
+	v_reconciled_checkpoints.clear();
+	if(!expenseColor.isValid()) expenseColor = createExpenseColor(transactionsView->viewport());
+	if(!incomeColor.isValid()) incomeColor = createIncomeColor(transactionsView->viewport());
 	QDate curdate = QDate::currentDate();
 	bool b_reconciling = reconcileButton->isChecked();
+	LedgerListViewItem *i_opening = NULL, *i_selected = NULL;
 	
-	if(balance != 0.0) {
-		LedgerListViewItem *i = new LedgerListViewItem(NULL, NULL, transactionsView, "-", "-", tr("Opening balance", "Account balance"), "-", "-", QString(), QString(), QString(), QString(), account->currency()->formatValue(balance));
-		i->d_balance = balance;
-		previous_balance = balance;
-		i->setReconciled(-1, b_reconciling ? 2 : -2);
-	}
+	if(account->initialBalance() != 0.0) i_opening = new LedgerListViewItem(NULL, NULL, this);
 
 	int trans_index = 0;
 	int split_index = 0;
@@ -1463,192 +1723,9 @@ void LedgerDialog::updateTransactions(bool update_reconciliation_date) {
 	if(split_index < budget->splitTransactions.size()) split = budget->splitTransactions.at(split_index);
 	Transactions *transs = trans;
 	if(!transs || (split && split->date() < trans->date())) transs = split;
-	QVector<SplitTransaction*> splits;
-	bool last_reconciled = true;
-	QDate rec_date, first_date;
+	QList<LedgerListViewItem*> rows;
 	while(transs) {
-		if(transs == split) {
-			if(split->type() == SPLIT_TRANSACTION_TYPE_MULTIPLE_ITEMS && ((MultiItemTransaction*) split)->account() == account) {
-				double value = split->accountChange(account);
-				balance += value;
-				if(previous_date.isValid() && split->date() != previous_date) total_balance += previous_balance * previous_date.daysTo(split->date());
-				previous_balance = balance;
-				previous_date = split->date();
-				if(!first_date.isValid()) first_date = previous_date;
-				LedgerListViewItem *i = new LedgerListViewItem(NULL, split, NULL, QLocale().toString(split->date(), QLocale::ShortFormat), tr("Split Transaction"), split->description(), ((MultiItemTransaction*) split)->fromAccountsString(), split->payeeText(), split->tagsText(), split->comment(), (value >= 0.0) ? account->currency()->formatValue(value) : QString(), (value < 0.0) ? account->currency()->formatValue(-value) : QString(), account->currency()->formatValue(balance));
-				if(b_ascending) transactionsView->addTopLevelItem(i);
-				else transactionsView->insertTopLevelItem(0, i);
-				i->setColors();
-				i->d_balance = balance;
-				i->setReconciled(split->isReconciled(account), b_reconciling ? 2 : -2);
-				if(split->isReconciled(account)) {
-					last_reconciled = true;
-				} else if(last_reconciled) {
-					rec_date = split->date();
-					last_reconciled = false;
-				}
-				quantity++;
-				if(split == selected_split) {
-					i->setSelected(true);
-				}
-				if(!split->associatedFile().isEmpty()) i->setIcon(value >= 0 ? 9 : 10, LOAD_ICON_STATUS("mail-attachment"));
-			} else if(split->type() == SPLIT_TRANSACTION_TYPE_LOAN) {
-				if(((DebtPayment*) split)->loan() == account) {
-					DebtPayment *lsplit = (DebtPayment*) split;
-					Transaction *ltrans = lsplit->paymentTransaction();
-					bool b_tb = false;
-					if(ltrans) {
-						b_tb = true;
-						double value = ltrans->toValue();
-						balance += value;
-						reductions += value;
-						LedgerListViewItem *i = new LedgerListViewItem(ltrans, NULL, NULL, QLocale().toString(split->date(), QLocale::ShortFormat), tr("Debt Payment"), tr("Reduction"), ltrans->fromAccount()->name(), lsplit->loan()->maintainer(), ltrans->tagsText(true), lsplit->comment(), (value >= 0.0) ? account->currency()->formatValue(value) : QString(), value >= 0.0 ? QString() : account->currency()->formatValue(-value), account->currency()->formatValue(balance));
-						if(b_ascending) transactionsView->addTopLevelItem(i);
-						else transactionsView->insertTopLevelItem(0, i);
-						i->setColors();
-						i->d_balance = balance;
-						i->setReconciled(ltrans->isReconciled(account), b_reconciling ? 2 : -2);
-						if(ltrans->isReconciled(account)) {
-							last_reconciled = true;
-						} else if(last_reconciled) {
-							rec_date = ltrans->date();
-							last_reconciled = false;
-						}
-						if(ltrans == selected_transaction) {
-							i->setSelected(true);
-						}
-						quantity++;
-						if(!split->associatedFile().isEmpty()) i->setIcon(value >= 0 ? 9 : 10, LOAD_ICON_STATUS("mail-attachment"));
-					}
-					ltrans = lsplit->feeTransaction();
-					if(ltrans) {
-						double value = ltrans->value();
-						expenses += value;
-						bool to_balance = (ltrans->fromAccount() == account);
-						if(to_balance) {
-							b_tb = true;
-							balance -= value;
-							reductions -= value;
-							quantity++;
-						}
-						LedgerListViewItem *i = new LedgerListViewItem(ltrans, NULL, NULL, QLocale().toString(split->date(), QLocale::ShortFormat), tr("Debt Payment"), tr("Fee"), ltrans->fromAccount()->name(), ((DebtFee*) ltrans)->payee(), ltrans->tagsText(true), lsplit->comment(), (to_balance || value >= 0.0) ? QString() : account->currency()->formatValue(-value), (to_balance && value >= 0.0) ? account->currency()->formatValue(value) : QString(), account->currency()->formatValue(balance), to_balance ? QString() : account->currency()->formatValue(value));
-						if(b_ascending) transactionsView->addTopLevelItem(i);
-						else transactionsView->insertTopLevelItem(0, i);
-						i->setColors();
-						i->d_balance = balance;
-						i->b_other_account = !to_balance;
-						i->setReconciled(to_balance ? ltrans->isReconciled(account) : -1, b_reconciling ? 2 : -2);
-						if(ltrans->isReconciled(account)) {
-							last_reconciled = true;
-						} else if(last_reconciled) {
-							rec_date = ltrans->date();
-							last_reconciled = false;
-						}
-						if(ltrans == selected_transaction) {
-							i->setSelected(true);
-						}
-						if(!split->associatedFile().isEmpty()) i->setIcon(to_balance ? (value >= 0.0 ? 10 : 9) : 8, LOAD_ICON_STATUS("mail-attachment"));
-					}
-					ltrans = lsplit->interestTransaction();
-					if(ltrans) {
-						double value = ltrans->value();
-						expenses += value;
-						bool to_balance = (ltrans->fromAccount() == account);
-						if(to_balance) {
-							b_tb = true;
-							balance -= value;
-							reductions -= value;
-							quantity++;
-						}
-						LedgerListViewItem *i = new LedgerListViewItem(ltrans, NULL, NULL, QLocale().toString(split->date(), QLocale::ShortFormat), tr("Debt Payment"), tr("Interest"), ltrans->fromAccount()->name(), ((DebtInterest*) ltrans)->payee(), ltrans->tagsText(true), lsplit->comment(), (to_balance || value >= 0.0) ? QString() : account->currency()->formatValue(-value), (to_balance && value >= 0.0) ? account->currency()->formatValue(value) : QString(), account->currency()->formatValue(balance), to_balance ? QString() : account->currency()->formatValue(value));
-						if(b_ascending) transactionsView->addTopLevelItem(i);
-						else transactionsView->insertTopLevelItem(0, i);
-						i->setColors();
-						i->d_balance = balance;
-						i->b_other_account = !to_balance;
-						i->setReconciled(to_balance ? ltrans->isReconciled(account) : -1, b_reconciling ? 2 : -2);
-						if(ltrans->isReconciled(account)) {
-							last_reconciled = true;
-						} else if(last_reconciled) {
-							rec_date = ltrans->date();
-							last_reconciled = false;
-						}
-						if(ltrans == selected_transaction) {
-							i->setSelected(true);
-						}
-						if(!split->associatedFile().isEmpty()) i->setIcon(to_balance ? (value >= 0.0 ? 10 : 9) : 8, LOAD_ICON_STATUS("mail-attachment"));
-					}
-					if(b_tb) {
-						if(previous_date.isValid() && lsplit->date() != previous_date) total_balance += previous_balance * previous_date.daysTo(lsplit->date());
-						previous_balance = balance;
-						previous_date = lsplit->date();
-						if(!first_date.isValid()) first_date = previous_date;
-					}
-				} else if(((DebtPayment*) split)->account() == account) {
-					double value = split->accountChange(account);
-					if(value != 0.0) {
-						balance += value;
-						LedgerListViewItem *i = new LedgerListViewItem(NULL, split, NULL, QLocale().toString(split->date(), QLocale::ShortFormat), tr("Debt Payment"), split->description(), ((DebtPayment*) split)->loan()->name(), ((DebtPayment*) split)->loan()->maintainer(), split->tagsText(), split->comment(), (value >= 0.0) ? account->currency()->formatValue(value) : QString(), (value < 0.0) ? account->currency()->formatValue(-value) : QString(), account->currency()->formatValue(balance));
-						if(b_ascending) transactionsView->addTopLevelItem(i);
-						else transactionsView->insertTopLevelItem(0, i);
-						i->setColors();
-						i->d_balance = balance;
-						i->setReconciled(split->isReconciled(account), b_reconciling ? 2 : -2);
-						if(split->isReconciled(account)) {
-							last_reconciled = true;
-						} else if(last_reconciled) {
-							rec_date = split->date();
-							last_reconciled = false;
-						}
-						quantity++;
-						if(split == selected_split) {
-							i->setSelected(true);
-						}
-						if(!split->associatedFile().isEmpty()) i->setIcon(value >= 0 ? 9 : 10, LOAD_ICON_STATUS("mail-attachment"));
-					}
-					if(previous_date.isValid() && split->date() != previous_date) total_balance += previous_balance * previous_date.daysTo(split->date());
-					previous_balance = balance;
-					previous_date = split->date();
-					if(!first_date.isValid()) first_date = previous_date;
-				}
-			}
-		} else if(transs->relatesToAccount(account) && (!trans->parentSplit() || trans->parentSplit()->type() == SPLIT_TRANSACTION_TYPE_MULTIPLE_ACCOUNTS || (trans->parentSplit()->type() == SPLIT_TRANSACTION_TYPE_MULTIPLE_ITEMS && ((MultiItemTransaction*) trans->parentSplit())->account() != account))) {
-			double value = trans->accountChange(account);
-			balance += value;
-			LedgerListViewItem *i = new LedgerListViewItem(trans, NULL, NULL, QLocale().toString(trans->date(), QLocale::ShortFormat), QString(), trans->description(), account == trans->fromAccount() ? trans->toAccount()->name() : trans->fromAccount()->name(), trans->payeeText(), trans->tagsText(true), trans->comment(), (value >= 0.0) ? account->currency()->formatValue(value) : QString(), value >= 0.0 ? QString() : account->currency()->formatValue(-value), account->currency()->formatValue(balance));
-			quantity++;
-			if(b_ascending) transactionsView->addTopLevelItem(i);
-			else transactionsView->insertTopLevelItem(0, i);
-			i->setColors();
-			i->setReconciled(trans->isReconciled(account), b_reconciling ? 2 : -2);
-			if(trans->type() == TRANSACTION_TYPE_INCOME) {
-				if(value >= 0.0) i->setText(2, tr("Income"));
-				else i->setText(2, tr("Repayment"));
-			} else if(trans->type() == TRANSACTION_TYPE_EXPENSE) {
-				if(value <= 0.0) i->setText(2, tr("Expense"));
-				else i->setText(2, tr("Refund"));
-			} else if(trans->relatesToAccount(budget->balancingAccount)) {
-				i->setText(2, tr("Account Balance Adjustment"));
-				i->setReconciled(-1, b_reconciling ? 2 : -2);
-			} else {
-				i->setText(2, tr("Transfer"));
-			}
-			if(trans == selected_transaction) {
-				i->setSelected(true);
-			}
-			i->d_balance = balance;
-			if(trans->isReconciled(account)) {
-				last_reconciled = true;
-			} else if(last_reconciled) {
-				rec_date = trans->date();
-				last_reconciled = false;
-			}
-			if(previous_date.isValid() && trans->date() != previous_date) total_balance += previous_balance * previous_date.daysTo(trans->date());
-			previous_balance = balance;
-			previous_date = trans->date();
-			if(!first_date.isValid()) first_date = previous_date;
-			if(!trans->associatedFile().isEmpty() || (trans->parentSplit() && !trans->parentSplit()->associatedFile().isEmpty())) i->setIcon(value >= 0 ? 9 : 10, LOAD_ICON_STATUS("mail-attachment"));
-		}
+		createRows(transs, rows);
 		if(transs == trans) {
 			++trans_index;
 			trans = NULL;
@@ -1663,16 +1740,37 @@ void LedgerDialog::updateTransactions(bool update_reconciliation_date) {
 		transs = trans;
 		if(!transs || (split && (split->date() < trans->date() || (split->date() == trans->date() && split->timestamp() < trans->timestamp())))) transs = split;
 	}
+	v_rows.reserve(rows.size());
+	bool last_reconciled = true;
+	QDate rec_date;
+	for(int index = 0; index < rows.size(); index++) {
+		LedgerListViewItem *i = rows[index];
+		appendRow(i);
+		Transactions *row_trans = i->transaction();
+		if(i->splitTransaction()) row_trans = i->splitTransaction();
+		if(row_trans->isReconciled(account)) {
+			last_reconciled = true;
+		} else if(last_reconciled) {
+			rec_date = row_trans->date();
+			last_reconciled = false;
+		}
+		if((selected_split && i->splitTransaction() == selected_split) || (selected_transaction && i->transaction() == selected_transaction)) i_selected = i;
+	}
 	
-	if(previous_date.isValid() && previous_date < QDate::currentDate()) previous_balance *= previous_date.daysTo(QDate::currentDate());
-	total_balance += previous_balance;
-	if(first_date.isValid() && first_date < QDate::currentDate()) total_balance /= (first_date.daysTo(QDate::currentDate()) + (previous_date == QDate::currentDate() ? 1 : 0));
-	if(account->accountType() == ASSETS_TYPE_LIABILITIES || account->accountType() == ASSETS_TYPE_CREDIT_CARD) {
-		stat_total_text = QString("<div align=\"right\"><b>%1</b> %4 &nbsp; <b>%2</b> %5 &nbsp; <b>%3</b> %6</div>").arg(tr("Current debt:")).arg(tr("Total debt reduction:")).arg(tr("Total interest and fees:")).arg(account->currency()->formatValue(-balance)).arg(account->currency()->formatValue(reductions)).arg(account->currency()->formatValue(expenses));
+	// items only hold their transaction; text is formatted when a row is painted
+	QList<QTreeWidgetItem*> items;
+	items.reserve(v_rows.size() + 1);
+	if(b_ascending) {
+		if(i_opening) items << i_opening;
+		for(int index = 0; index < v_rows.size(); index++) items << v_rows[index];
 	} else {
-		stat_total_text = QString("<div align=\"right\"><b>%1</b> %4 &nbsp; <b>%2</b> %5 &nbsp; <b>%3</b> %6</div>").arg(tr("Current balance:", "Account balance")).arg(tr("Average balance:", "Account balance")).arg(tr("Number of transactions:")).arg(account->currency()->formatValue(balance)).arg(account->currency()->formatValue(total_balance)).arg(budget->formatValue(quantity, 0));
+		for(int index = v_rows.size() - 1; index >= 0; index--) items << v_rows[index];
+		if(i_opening) items << i_opening;
 	}
-	statLabel->setText(stat_total_text);
+	transactionsView->addTopLevelItems(items);
+	if(i_selected) i_selected->setSelected(true);
+	
+	updateStats();
 	transactionsView->horizontalScrollBar()->setValue(scroll_h);
 	transactionsView->verticalScrollBar()->setValue(scroll_v);
 	if(!rec_date.isValid()) {
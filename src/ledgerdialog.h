@@ -26,6 +26,8 @@
 
 #include <QDialog>
 #include <QDate>
+#include <QList>
+#include <QVector>
 
 class QPushButton;
 class QTreeWidget;
@@ -42,17 +44,23 @@ class EqonomizeValueEdit;
 class Eqonomize;
 class AssetsAccount;
 class Budget;
+class Transactions;
+class LedgerListViewItem;
+
+#define LEDGER_CHECKPOINT_INTERVAL 128
 
 class LedgerDialog : public QDialog {
 	
 	Q_OBJECT
 	
+	friend class LedgerListViewItem;
+	
 	protected:
 
 		AssetsAccount *account;
 		Eqonomize *mainWin;
 		Budget *budget;
-		bool b_extra, b_ascending;
+		bool b_extra, b_ascending, b_rows_updated;
 
 		QString stat_total_text;
 		
@@ -81,6 +89,20 @@ class LedgerDialog : public QDialog {
 		bool exportList(QTextStream &outf, int fileformat, QDate first_date = QDate(), QDate last_date = QDate());
 		void accountChanged();
 		
+		QVector<LedgerListViewItem*> v_rows;
+		QVector<double> v_balance_checkpoints, v_reconciled_checkpoints;
+		
+		void appendRow(LedgerListViewItem*);
+		double rowBalance(int) const;
+		double reconciledSum(int) const;
+		void addReconciledChange(int, double);
+		int rowIndex(const QDate&, bool = false) const;
+		void setRowReconciled(LedgerListViewItem*, bool);
+		void updateCheckpoints(int);
+		void createRows(Transactions*, QList<LedgerListViewItem*>&);
+		bool updateRows(Transactions*, bool);
+		void updateStats();
+		
 		void updateReconciliationStats(bool = false, bool = false, bool = false);
 		void updateReconciliationStatLabels();
 		
@@ -121,6 +143,11 @@ class LedgerDialog : public QDialog {
 		void transactionActivated(QTreeWidgetItem*, int);
 		void transactionSelectionChanged();
 		void updateTransactions(bool = false);
+		void transactionAdded(Transactions*);
+		void transactionModified(Transactions*, Transactions*);
+		void transactionRemoved(Transactions*, Transactions*);
+		void transactionsModified();
+		void transactionsCleared();
 		void updateAccounts();
 		void newExpense();
 		void newIncome();
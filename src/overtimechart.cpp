@@ -83,6 +83,7 @@
 #include "account.h"
 #include "budget.h"
 #include "eqonomizemonthselector.h"
+#include "portfolio.h"
 #include "recurrence.h"
 #include "transaction.h"
 
@@ -2471,11 +2472,11 @@ void OverTimeChart::updateDisplay() {
 			}
 		}
 		if(include) {
-			QDate transdate = strans->firstOccurrence();
+			QVector<QDate> dates = budget->scheduledOccurrences(strans, last_date);
 			QVector<chart_month_info>::iterator cmi_it = monthly_values->begin();
-			do {
-				if(transdate >= first_date) {
-					while(cmi_it->date < transdate) {
+			for(QVector<QDate>::const_iterator it_date = dates.constBegin(); it_date != dates.constEnd() && *it_date <= last_date; ++it_date) {
+				if(*it_date >= first_date) {
+					while(cmi_it->date < *it_date) {
 						++cmi_it;
 					}
 					(*mi) = cmi_it;
@@ -2484,30 +2485,19 @@ void OverTimeChart::updateDisplay() {
 					(*mi)->count += trans->quantity();
 					includes_scheduled = true;
 				}
-				if(strans->recurrence()) {
-					transdate = strans->recurrence()->nextOccurrence(transdate);
-				} else {
-					break;
-				}
-			} while(transdate <= last_date);
+			}
 			if(monthly_values2) {
-				transdate = strans->firstOccurrence();
 				cmi_it = monthly_values2->begin();
-				do {
-					if(transdate >= first_date) {
-						while(cmi_it->date < transdate) {
+				for(QVector<QDate>::const_iterator it_date = dates.constBegin(); it_date != dates.constEnd() && *it_date <= last_date; ++it_date) {
+					if(*it_date >= first_date) {
+						while(cmi_it->date < *it_date) {
 							++cmi_it;
 						}
 						(*mi2) = cmi_it;
 						(*mi2)->value += trans->value(do_convert) * sign * -1;
 						includes_scheduled = true;
 					}
-					if(strans->recurrence()) {
-						transdate = strans->recurrence()->nextOccurrence(transdate);
-					} else {
-						break;
-					}
-				} while(transdate <= last_date);
+				}
 			}
 		}
 		if(tag_index == 0) {
@@ -2617,10 +2607,8 @@ void OverTimeChart::updateDisplay() {
 					} else if(account && account->type() != ACCOUNT_TYPE_ASSETS) {
 						d_budget = ((CategoryAccount*) account)->monthlyBudget(budget->budgetYear((*mi)->date), budget->budgetMonth((*mi)->date), false);
 						if((current_source == 21 || current_source == 22) && account == current_account) {
-							for(int i = 0; i < ((CategoryAccount*) account)->subCategories.size(); i++) {
-								double d_budget2 = (((CategoryAccount*) account)->subCategories[i])->monthlyBudget(budget->budgetYear((*mi)->date), budget->budgetMonth((*mi)->date), false);
-								if(d_budget2 >= 0.0) d_budget -= d_budget2;
-							}
+							double d_budget2 = ((CategoryAccount*) account)->subCategoriesMonthlyBudget(QDate(budget->budgetYear((*mi)->date), budget->budgetMonth((*mi)->date), 1));
+							if(d_budget2 >= 0.0) d_budget -= d_budget2;
 						}
 					}
 					if(d_budget >= 0.0 && d_budget > (*mi)->value) {
@@ -2786,18 +2774,24 @@ void OverTimeChart::updateDisplay() {
 				}
 			}
 		}
+		QMap<AssetsAccount*, QList<Security*> > account_securities;
 		for(SecurityList<Security*>::const_iterator it = budget->securities.constBegin(); it != budget->securities.constEnd(); ++it) {
 			Security *sec = *it;
-			AssetsAccount *ass = sec->account();
-			if(!current_assets || ass == current_assets) {
-				QVector<chart_month_info>::iterator it_b = monthly_cats[ass].begin();
-				QVector<chart_month_info>::iterator it_e = monthly_cats[ass].end();
-				while(it_b != it_e) {
-					if(current_assets) it_b->value += sec->value(it_b->date, -1);
-					else it_b->value += ass->currency()->convertTo(sec->value(it_b->date, -1), budget->defaultCurrency(), it_b->date);
-					it_b++;
-				}
-			}
+			if(!current_assets || sec->account() == current_assets) account_securities[sec->account()] << sec;
+		}
+		Portfolio portfolio(budget);
+		for(QMap<AssetsAccount*, QList<Security*> >::const_iterator it = account_securities.constBegin(); it != account_securities.constEnd(); ++it) {
+			AssetsAccount *ass = it.key();
+			QVector<chart_month_info> &cmis = monthly_cats[ass];
+			QVector<QDate> dates;
+			dates.reserve(cmis.count());
+			for(QVector<chart_month_info>::const_iterator it_b = cmis.constBegin(); it_b != cmis.constEnd(); ++it_b) dates << it_b->date;
+			portfolio.setDates(dates);
+			portfolio.calculate(it.value(), -1);
+			QVector<double> values;
+			if(current_assets) portfolio.totalValue(values);
+			else portfolio.totalValue(values, budget->defaultCurrency());
+			for(int i = 0; i < cmis.count(); i++) cmis[i].value += values[i];
 		}
 		if(current_source > 50) {
 			for(AccountList<AssetsAccount*>::const_iterator it = budget->assetsAccounts.constBegin(); it != budget->assetsAccounts.constEnd(); ++it) {
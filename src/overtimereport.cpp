@@ -59,6 +59,7 @@
 
 #include "account.h"
 #include "budget.h"
+#include "portfolio.h"
 #include "recurrence.h"
 #include "transaction.h"
 
@@ -1423,22 +1424,29 @@ void OverTimeReport::updateDisplay() {
 					total_value += current_assets->currency()->convertTo(current_assets->initialBalance(false), currency, start_date);
 				}
 			}
+			QList<Security*> securities;
+			for(SecurityList<Security*>::const_iterator it_s = budget->securities.constBegin(); it_s != budget->securities.constEnd(); ++it_s) {
+				if((*it_s)->account()->accountType() == ASSETS_TYPE_SECURITIES && account_list.contains((*it_s)->account())) securities << *it_s;
+			}
+			QVector<double> securities_value;
+			if(!securities.isEmpty()) {
+				QVector<QDate> dates;
+				dates.reserve(monthly_values.count());
+				for(QVector<month_info>::const_iterator it_b = monthly_values.constBegin(); it_b != monthly_values.constEnd(); ++it_b) dates << it_b->date;
+				Portfolio portfolio(budget);
+				portfolio.setDates(dates);
+				portfolio.calculate(securities, -1);
+				portfolio.totalValue(securities_value, currency);
+			}
 			QVector<month_info>::iterator it_b = monthly_values.begin();
 			QVector<month_info>::iterator it_e = monthly_values.end();
+			int i = 0;
 			while(it_b != it_e) {
 				total_value += it_b->value;
 				it_b->value = total_value;
-				for(QList<Account*>::const_iterator it = account_list.constBegin(); it != account_list.constEnd(); ++it) {
-					AssetsAccount *current_assets = (AssetsAccount*) *it;
-					if(current_assets->accountType() == ASSETS_TYPE_SECURITIES) {
-						for(SecurityList<Security*>::const_iterator it_s = budget->securities.constBegin(); it_s != budget->securities.constEnd(); ++it_s) {
-							if((*it_s)->account() == current_assets) {
-								it_b->value += current_assets->currency()->convertTo((*it_s)->value(it_b->date, -1), currency, it_b->date);
-							}
-						}
-					}
-				}
+				if(!securities_value.isEmpty()) it_b->value += securities_value[i];
 				it_b++;
+				i++;
 			}
 		} else if(type == 5) {
 			double total_value = 0.0, total_expense = 0.0;
@@ -1456,15 +1464,15 @@ void OverTimeReport::updateDisplay() {
 				it_b->expense = total_expense;
 				it_b++;
 			}
-			for(SecurityList<Security*>::const_iterator it = budget->securities.constBegin(); it != budget->securities.constEnd(); ++it) {
-				Security *sec = *it;
-				it_b = monthly_values.begin();
-				it_e = monthly_values.end();
-				while(it_b != it_e) {
-					it_b->value += sec->currency()->convertTo(sec->value(it_b->date, -1), budget->defaultCurrency(), it_b->date);
-					it_b++;
-				}
-			}
+			QVector<QDate> dates;
+			dates.reserve(monthly_values.count());
+			for(it_b = monthly_values.begin(); it_b != it_e; ++it_b) dates << it_b->date;
+			Portfolio portfolio(budget);
+			portfolio.setDates(dates);
+			portfolio.calculate(budget->securities, -1);
+			QVector<double> values;
+			portfolio.totalValue(values, budget->defaultCurrency());
+			for(int i = 0; i < monthly_values.count(); i++) monthly_values[i].value += values[i];
 		}
 	}
 	QStringList tags;
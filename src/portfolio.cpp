@@ -0,0 +1,262 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Hanna Knutsson                                  *
+ *   hanna.knutsson@protonmail.com                                         *
+ *                                                                         *
+ *   This file is part of Eqonomize!.                                      *
+ *                                                                         *
+ *   Eqonomize! is free software: you can redistribute it and/or modify    *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Eqonomize! is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Eqonomize!. If not, see <http://www.gnu.org/licenses/>.    *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <QHash>
+#include <QtConcurrentMap>
+
+#include "budget.h"
+#include "security.h"
+#include "portfolio.h"
+
+#include <algorithm>
+
+static bool portfolio_event_less_than(const PortfolioEvent &e1, const PortfolioEvent &e2) {
+	return e1.date < e2.date;
+}
+
+static void add_portfolio_event(QVector<PortfolioEvent> &events, const QDate &date, double shares, double cost, double dividend, Currency *ev_cur, Currency *sec_cur, bool convert_at_date) {
+	PortfolioEvent ev;
+	ev.date = date;
+	ev.shares = shares;
+	ev.currency = NULL;
+	if(ev_cur != sec_cur) {
+		if(convert_at_date) {
+			cost = ev_cur->convertTo(cost, sec_cur, date);
+			dividend = ev_cur->convertTo(dividend, sec_cur, date);
+		} else {
+			ev.currency = ev_cur;
+		}
+	}
+	ev.cost = cost;
+	ev.dividend = dividend;
+	events << ev;
+}
+static void add_scheduled_portfolio_events(QVector<PortfolioEvent> &events, ScheduledTransaction *strans, const QDate &last_date, double shares, double cost, double dividend) {
+	PortfolioEvent ev;
+	ev.shares = shares;
+	ev.cost = cost;
+	ev.dividend = dividend;
+	ev.currency = NULL;
+	QVector<QDate> dates = strans->budget()->scheduledOccurrences(strans, last_date);
+	for(QVector<QDate>::const_iterator it = dates.constBegin(); it != dates.constEnd() && *it <= last_date; ++it) {
+		ev.date = *it;
+		events << ev;
+	}
+}
+
+static void calculate_portfolio_security(PortfolioSecurity &ps, const QVector<QDate> &dates, const QDate &curdate, int estimate) {
+	Security *sec = ps.security;
+	int n = dates.count();
+	ps.shares.fill(0.0, n);
+	ps.value.fill(0.0, n);
+	ps.cost.fill(0.0, n);
+	ps.profit.fill(0.0, n);
+	if(n == 0) return;
+	Currency *cur = sec->currency();
+	bool at_date = sec->budget()->defaultTransactionConversionRateDate() == TRANSACTION_CONVERSION_RATE_AT_DATE;
+	const QDate &last_date = dates.last();
+	QVector<PortfolioEvent> &events = ps.events;
+	for(SecurityTransactionList<SecurityTransaction*>::const_iterator it = sec->transactions.constBegin(); it != sec->transactions.constEnd(); ++it) {
+		SecurityTransaction *trans = *it;
+		if(trans->date() > last_date) break;
+		if(trans->type() == TRANSACTION_TYPE_SECURITY_BUY) add_portfolio_event(events, trans->date(), trans->shares(), trans->value(), 0.0, trans->currency(), cur, at_date);
+		else add_portfolio_event(events, trans->date(), -trans->shares(), -trans->value(), 0.0, trans->currency(), cur, at_date);
+	}
+	for(TradedSharesList<SecurityTrade*>::const_iterator it = sec->tradedShares.constBegin(); it != sec->tradedShares.constEnd(); ++it) {
+		SecurityTrade *ts = *it;
+		if(ts->date > last_date) break;
+		double v = ts->from_shares * ts->from_security->getQuotation(ts->date);
+		if(ts->from_security == sec) add_portfolio_event(events, ts->date, -ts->from_shares, -v, 0.0, ts->from_security->currency(), cur, at_date);
+		else add_portfolio_event(events, ts->date, ts->to_shares, v, 0.0, ts->from_security->currency(), cur, at_date);
+	}
+	for(SecurityTransactionList<ReinvestedDividend*>::const_iterator it = sec->reinvestedDividends.constBegin(); it != sec->reinvestedDividends.constEnd(); ++it) {
+		ReinvestedDividend *rediv = *it;
+		if(rediv->date() > last_date) break;
+		add_portfolio_event(events, rediv->date(), rediv->shares(), 0.0, 0.0, cur, cur, at_date);
+	}
+	for(SecurityTransactionList<Income*>::const_iterator it = sec->dividends.constBegin(); it != sec->dividends.constEnd(); ++it) {
+		Income *trans = *it;
+		if(trans->date() > last_date) break;
+		add_portfolio_event(events, trans->date(), 0.0, 0.0, trans->income(), trans->currency(), cur, at_date);
+	}
+	std::stable_sort(events.begin(), events.end(), portfolio_event_less_than);
+
+	double shares = sec->initialShares(), cost = 0.0, dividends = 0.0;
+	const QMap<QDate, double> &quotations = sec->quotations;
+	if(!quotations.isEmpty()) cost = shares * quotations.constBegin().value();
+	QVector<double> quotes, expected_quotes;
+	sec->getQuotations(dates, quotes);
+	//as in Security::value(), interpolate only between the first and last quotation
+	int i_first = n, i_last = n;
+	if(estimate < 0 && quotations.count() >= 2) {
+		i_first = std::upper_bound(dates.constBegin(), dates.constEnd(), quotations.firstKey()) - dates.constBegin();
+		i_last = std::lower_bound(dates.constBegin(), dates.constEnd(), quotations.lastKey()) - dates.constBegin();
+		if(i_first < i_last) sec->expectedQuotations(dates.mid(i_first, i_last - i_first), expected_quotes);
+	}
+	QHash<Currency*, double> foreign_cost, foreign_dividends;
+	int i_ev = 0;
+	for(int i = 0; i < n; i++) {
+		const QDate &date = dates[i];
+		while(i_ev < events.count() && events[i_ev].date <= date) {
+			const PortfolioEvent &ev = events[i_ev];
+			shares += ev.shares;
+			if(ev.currency) {
+				foreign_cost[ev.currency] += ev.cost;
+				foreign_dividends[ev.currency] += ev.dividend;
+			} else {
+				cost += ev.cost;
+				dividends += ev.dividend;
+			}
+			i_ev++;
+		}
+		double c = cost, d = dividends;
+		for(QHash<Currency*, double>::const_iterator it = foreign_cost.constBegin(); it != foreign_cost.constEnd(); ++it) {
+			c += it.key()->convertTo(it.value(), cur, date);
+		}
+		for(QHash<Currency*, double>::const_iterator it = foreign_dividends.constBegin(); it != foreign_dividends.constEnd(); ++it) {
+			d += it.key()->convertTo(it.value(), cur, date);
+		}
+		ps.cost[i] = c;
+		//estimated future values are calculated afterwards, in Portfolio::calculate()
+		if(estimate > 0 && date > curdate) continue;
+		ps.shares[i] = shares;
+		if(i >= i_first && i < i_last) ps.value[i] = shares * expected_quotes[i - i_first];
+		else ps.value[i] = shares * quotes[i];
+		//profit from the same (possibly interpolated) value
+		ps.profit[i] = ps.value[i] - c + d;
+	}
+	events.clear();
+}
+
+struct PortfolioJob {
+	const QVector<QDate> *dates;
+	QDate curdate;
+	int estimate;
+	PortfolioJob(const QVector<QDate> *job_dates, const QDate &job_curdate, int job_estimate) : dates(job_dates), curdate(job_curdate), estimate(job_estimate) {}
+	void operator()(PortfolioSecurity &ps) const {
+		calculate_portfolio_security(ps, *dates, curdate, estimate);
+	}
+};
+
+Portfolio::Portfolio(Budget *parent_budget) : o_budget(parent_budget) {}
+Portfolio::~Portfolio() {}
+
+void Portfolio::setDates(const QVector<QDate> &new_dates) {
+	d_dates = new_dates;
+	v_securities.clear();
+}
+const QVector<QDate> &Portfolio::dates() const {return d_dates;}
+
+void Portfolio::calculate(const QList<Security*> &securities, int estimate, bool no_scheduled_shares) {
+	v_securities.clear();
+	v_securities.resize(securities.count());
+	for(int i = 0; i < securities.count(); i++) {
+		PortfolioSecurity &ps = v_securities[i];
+		Security *sec = securities[i];
+		ps.security = sec;
+		if(no_scheduled_shares || d_dates.isEmpty()) continue;
+		//occurrences are expanded here, since recurrences are not safe to use from several threads
+		const QDate &last_date = d_dates.last();
+		Currency *cur = sec->currency();
+		for(ScheduledSecurityTransactionList<ScheduledTransaction*>::const_iterator it = sec->scheduledTransactions.constBegin(); it != sec->scheduledTransactions.constEnd(); ++it) {
+			ScheduledTransaction *strans = *it;
+			if(strans->date() > last_date) break;
+			double v = strans->value();
+			if(cur != strans->currency()) v = strans->currency()->convertTo(v, cur);
+			double s = ((SecurityTransaction*) strans->transaction())->shares();
+			if(strans->transactiontype() == TRANSACTION_TYPE_SECURITY_BUY) add_scheduled_portfolio_events(ps.events, strans, last_date, s, v, 0.0);
+			else add_scheduled_portfolio_events(ps.events, strans, last_date, -s, -v, 0.0);
+		}
+		for(ScheduledSecurityTransactionList<ScheduledTransaction*>::const_iterator it = sec->scheduledReinvestedDividends.constBegin(); it != sec->scheduledReinvestedDividends.constEnd(); ++it) {
+			ScheduledTransaction *strans = *it;
+			if(strans->date() > last_date) break;
+			add_scheduled_portfolio_events(ps.events, strans, last_date, ((ReinvestedDividend*) strans->transaction())->shares(), 0.0, 0.0);
+		}
+		for(ScheduledSecurityTransactionList<ScheduledTransaction*>::const_iterator it = sec->scheduledDividends.constBegin(); it != sec->scheduledDividends.constEnd(); ++it) {
+			ScheduledTransaction *strans = *it;
+			if(strans->date() > last_date) break;
+			double v = strans->value();
+			if(cur != strans->currency()) v = strans->currency()->convertTo(v, cur);
+			add_scheduled_portfolio_events(ps.events, strans, last_date, 0.0, 0.0, v);
+		}
+	}
+	QDate curdate = QDate::currentDate();
+	PortfolioJob job(&d_dates, curdate, estimate);
+	if(v_securities.count() > 1) QtConcurrent::blockingMap(v_securities, job);
+	else if(v_securities.count() == 1) job(v_securities[0]);
+	//estimates fill caches in the securities and use the budget calendar, which are not safe to use from several threads
+	if(estimate > 0) {
+		int i_future = std::upper_bound(d_dates.constBegin(), d_dates.constEnd(), curdate) - d_dates.constBegin();
+		for(int i_sec = 0; i_sec < v_securities.count(); i_sec++) {
+			PortfolioSecurity &ps = v_securities[i_sec];
+			Security *sec = ps.security;
+			for(int i = i_future; i < d_dates.count(); i++) {
+				const QDate &date = d_dates[i];
+				ps.shares[i] = sec->shares(date, true, no_scheduled_shares);
+				ps.value[i] = sec->value(date, estimate, no_scheduled_shares);
+				ps.profit[i] = sec->profit(date, true, no_scheduled_shares);
+			}
+		}
+	}
+}
+void Portfolio::clear() {
+	v_securities.clear();
+}
+
+const QVector<PortfolioSecurity> &Portfolio::securities() const {return v_securities;}
+const PortfolioSecurity *Portfolio::security(const Security *sec) const {
+	for(QVector<PortfolioSecurity>::const_iterator it = v_securities.constBegin(); it != v_securities.constEnd(); ++it) {
+		if(it->security == sec) return &(*it);
+	}
+	return NULL;
+}
+
+void Portfolio::total(QVector<double> &values, QVector<double> PortfolioSecurity::*field, Currency *cur) const {
+	int n = d_dates.count();
+	values.fill(0.0, n);
+	QHash<Currency*, QVector<double> > currency_totals;
+	for(QVector<PortfolioSecurity>::const_iterator it = v_securities.constBegin(); it != v_securities.constEnd(); ++it) {
+		const QVector<double> &v = (*it).*field;
+		Currency *sec_cur = it->security->currency();
+		if(!cur || sec_cur == cur) {
+			for(int i = 0; i < n; i++) values[i] += v[i];
+		} else {
+			QVector<double> &cv = currency_totals[sec_cur];
+			if(cv.isEmpty()) cv.fill(0.0, n);
+			for(int i = 0; i < n; i++) cv[i] += v[i];
+		}
+	}
+	for(QHash<Currency*, QVector<double> >::const_iterator it = currency_totals.constBegin(); it != currency_totals.constEnd(); ++it) {
+		for(int i = 0; i < n; i++) values[i] += it.key()->convertTo(it.value()[i], cur, d_dates[i]);
+	}
+}
+void Portfolio::totalValue(QVector<double> &values, Currency *cur) const {
+	total(values, &PortfolioSecurity::value, cur);
+}
+void Portfolio::totalCost(QVector<double> &values, Currency *cur) const {
+	total(values, &PortfolioSecurity::cost, cur);
+}
+void Portfolio::totalProfit(QVector<double> &values, Currency *cur) const {
+	total(values, &PortfolioSecurity::profit, cur);
+}
@@ -0,0 +1,78 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Hanna Knutsson                                  *
+ *   hanna.knutsson@protonmail.com                                         *
+ *                                                                         *
+ *   This file is part of Eqonomize!.                                      *
+ *                                                                         *
+ *   Eqonomize! is free software: you can redistribute it and/or modify    *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Eqonomize! is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Eqonomize!. If not, see <http://www.gnu.org/licenses/>.    *
+ ***************************************************************************/
+
+#ifndef PORTFOLIO_H
+#define PORTFOLIO_H
+
+#include <QDate>
+#include <QList>
+#include <QVector>
+
+class Budget;
+class Currency;
+class Security;
+
+struct PortfolioEvent {
+	QDate date;
+	double shares, cost, dividend;
+	//currency of cost and dividend if they should be converted at the valuation date, otherwise NULL (security currency)
+	Currency *currency;
+};
+
+struct PortfolioSecurity {
+	Security *security;
+	QVector<PortfolioEvent> events;
+	QVector<double> shares, value, cost, profit;
+};
+
+class Portfolio {
+
+	protected:
+
+		Budget *o_budget;
+		QVector<QDate> d_dates;
+		QVector<PortfolioSecurity> v_securities;
+
+		void total(QVector<double> &values, QVector<double> PortfolioSecurity::*field, Currency *cur) const;
+
+	public:
+
+		Portfolio(Budget *parent_budget);
+		~Portfolio();
+
+		//dates must be sorted in ascending order
+		void setDates(const QVector<QDate> &new_dates);
+		const QVector<QDate> &dates() const;
+
+		//estimate as in Security::value(); values are calculated in the currency of each security
+		void calculate(const QList<Security*> &securities, int estimate = 0, bool no_scheduled_shares = false);
+		void clear();
+
+		const QVector<PortfolioSecurity> &securities() const;
+		const PortfolioSecurity *security(const Security *sec) const;
+
+		//sum of all securities, converted to cur (if not NULL) once per date and currency
+		void totalValue(QVector<double> &values, Currency *cur = NULL) const;
+		void totalCost(QVector<double> &values, Currency *cur = NULL) const;
+		void totalProfit(QVector<double> &values, Currency *cur = NULL) const;
+
+};
+
+#endif
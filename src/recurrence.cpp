@@ -29,6 +29,8 @@
 #include "budget.h"
 #include "recurrence.h"
 
+#include <algorithm>
+
 int months_between_dates(const QDate &date1, const QDate &date2) {	
 	if(date1.year() == date2.year()) {
 		return date2.month() - date1.month();
@@ -78,15 +80,21 @@ int get_day_in_month(int year, int month, int week, int day_of_week) {
 	return get_day_in_month(date, week, day_of_week);
 }
 
+int last_recurrence_revision = 0;
+
 Recurrence::Recurrence(Budget *parent_budget) : o_budget(parent_budget) {
 	i_count = -1;
+	i_revision = ++last_recurrence_revision;
 }
 Recurrence::Recurrence(Budget *parent_budget, QXmlStreamReader *xml, bool *valid) : o_budget(parent_budget) {
+	i_revision = ++last_recurrence_revision;
 	QXmlStreamAttributes attr = xml->attributes();
 	readAttributes(&attr, valid);
 	readElements(xml, valid);
 }
-Recurrence::Recurrence(const Recurrence *rec) : o_budget(rec->budget()), d_startdate(rec->startDate()), d_enddate(rec->endDate()), i_count(rec->fixedOccurrenceCount()), exceptions(rec->exceptions) {}
+Recurrence::Recurrence(const Recurrence *rec) : o_budget(rec->budget()), d_startdate(rec->startDate()), d_enddate(rec->endDate()), i_count(rec->fixedOccurrenceCount()), exceptions(rec->exceptions) {
+	i_revision = ++last_recurrence_revision;
+}
 Recurrence::~Recurrence() {}
 
 void Recurrence::readAttributes(QXmlStreamAttributes *attr, bool *valid) {
@@ -115,6 +123,8 @@ bool Recurrence::readElements(QXmlStreamReader *xml, bool *valid) {
 		if(!readElement(xml, valid)) xml->skipCurrentElement();
 	}
 	std::sort(exceptions.begin(), exceptions.end());
+	exceptions.erase(std::unique(exceptions.begin(), exceptions.end()), exceptions.end());
+	modified();
 	return true;
 }
 
@@ -137,6 +147,7 @@ void Recurrence::writeElements(QXmlStreamWriter *xml) {
 }
 
 void Recurrence::updateDates() {
+	modified();
 	if(!d_startdate.isValid()) return;
 	if(!d_enddate.isNull() && i_count <= 0) {
 		d_enddate =  prevOccurrence(d_enddate, true);
@@ -187,17 +198,61 @@ const QDate &Recurrence::firstOccurrence() const {
 const QDate &Recurrence::lastOccurrence() const {
 	return d_enddate;
 }
+QVector<QDate> Recurrence::occurrences(const QDate &first_date, const QDate &last_date) const {
+	if(d_occurrences_first.isValid() && first_date >= d_occurrences_first && last_date <= d_occurrences_last) {
+		QVector<QDate>::const_iterator it_first = std::lower_bound(v_occurrences.constBegin(), v_occurrences.constEnd(), first_date);
+		QVector<QDate>::const_iterator it_last = std::upper_bound(it_first, v_occurrences.constEnd(), last_date);
+		return v_occurrences.mid(it_first - v_occurrences.constBegin(), it_last - it_first);
+	}
+	clearOccurrenceCache();
+	QVector<QDate> dates;
+	if(!first_date.isValid() || !last_date.isValid() || first_date > last_date) return dates;
+	for(QDate date = nextOccurrence(first_date, true); !date.isNull() && date <= last_date; date = nextOccurrence(date)) {
+		dates << date;
+	}
+	v_occurrences = dates;
+	d_occurrences_first = first_date;
+	d_occurrences_last = last_date;
+	return dates;
+}
+bool Recurrence::cachedNextOccurrence(const QDate &date, bool include_equals, QDate &next_date) const {
+	if(!d_occurrences_first.isValid() || date < d_occurrences_first || date > d_occurrences_last) return false;
+	QVector<QDate>::const_iterator it = include_equals ? std::lower_bound(v_occurrences.constBegin(), v_occurrences.constEnd(), date) : std::upper_bound(v_occurrences.constBegin(), v_occurrences.constEnd(), date);
+	if(it == v_occurrences.constEnd()) return false;
+	next_date = *it;
+	return true;
+}
+bool Recurrence::cachedPrevOccurrence(const QDate &date, bool include_equals, QDate &prev_date) const {
+	if(!d_occurrences_first.isValid() || date < d_occurrences_first || date > d_occurrences_last) return false;
+	QVector<QDate>::const_iterator it = include_equals ? std::upper_bound(v_occurrences.constBegin(), v_occurrences.constEnd(), date) : std::lower_bound(v_occurrences.constBegin(), v_occurrences.constEnd(), date);
+	if(it == v_occurrences.constBegin()) return false;
+	prev_date = *(it - 1);
+	return true;
+}
+void Recurrence::clearOccurrenceCache() const {
+	v_occurrences.clear();
+	d_occurrences_first = QDate();
+	d_occurrences_last = QDate();
+}
+void Recurrence::modified() {
+	clearOccurrenceCache();
+	i_revision = ++last_recurrence_revision;
+}
+int Recurrence::revision() const {
+	return i_revision;
+}
 int Recurrence::countOccurrences(const QDate &startdate, const QDate &enddate) const {	
 	if(enddate < d_startdate) return 0;
 	if(!d_enddate.isNull() && startdate > d_enddate) return 0;
 	if(i_count > 0 && startdate <= d_startdate && enddate <= d_enddate) return i_count;
-	QDate date1 = nextOccurrence(startdate, true);
-	if(date1.isNull() || date1 > enddate) return 0;
-	int n = 0;
-	do {
-		n++;
-		date1 = nextOccurrence(date1);
-	} while(!date1.isNull() && date1 <= enddate);
+	QDate date1 = startdate, date2 = enddate;
+	if(date1 < d_startdate) date1 = d_startdate;
+	if(!d_enddate.isNull() && date2 > d_enddate) date2 = d_enddate;
+	if(date1 > date2) return 0;
+	int n = occurrencesUntil(date2) - occurrencesUntil(date1.addDays(-1));
+	for(QVector<QDate>::const_iterator it = std::lower_bound(exceptions.constBegin(), exceptions.constEnd(), date1); it != exceptions.constEnd() && *it <= date2; ++it) {
+		if(occurrencesUntil(*it) != occurrencesUntil(it->addDays(-1))) n--;
+	}
 	return n;
 }
 int Recurrence::countOccurrences(const QDate &enddate) const {
@@ -214,6 +269,7 @@ const QDate &Recurrence::startDate() const {
 	return d_startdate;
 }
 void Recurrence::setEndDate(const QDate &new_end_date) {
+	modified();
 	i_count = -1;	
 	d_enddate = new_end_date;
 	if(!new_end_date.isNull()) {
@@ -233,6 +289,7 @@ void Recurrence::setEndDate(const QDate &new_end_date) {
 	}
 }
 void Recurrence::setStartDate(const QDate &new_start_date) {
+	modified();
 	d_startdate = new_start_date;
 	bool set_end_date = false;
 	if(!d_enddate.isNull() && d_startdate > d_enddate) {
@@ -260,6 +317,7 @@ int Recurrence::fixedOccurrenceCount() const {
 	return i_count;
 }
 void Recurrence::setFixedOccurrenceCount(int new_count) {
+	modified();
 	if(new_count <= 0) {
 		i_count = -1;
 		setEndDate(d_enddate);
@@ -281,7 +339,10 @@ void Recurrence::setFixedOccurrenceCount(int new_count) {
 	}
 }
 void Recurrence::addException(const QDate &date) {
-	if(hasException(date) || !date.isValid()) return;
+	if(!date.isValid()) return;
+	QVector<QDate>::iterator it = std::lower_bound(exceptions.begin(), exceptions.end(), date);
+	if(it != exceptions.end() && *it == date) return;
+	modified();
 	if(date == d_startdate) {
 		d_startdate =  nextOccurrence(d_startdate);
 		if(d_startdate.isNull()) d_enddate = QDate();
@@ -292,33 +353,26 @@ void Recurrence::addException(const QDate &date) {
 		if(d_enddate.isNull()) d_startdate = QDate();
 		return;
 	}
-	exceptions.append(date);
-	std::sort(exceptions.begin(), exceptions.end());
+	exceptions.insert(it, date);
 }
 int Recurrence::findException(const QDate &date) const {
-	for(QVector<QDate>::size_type i = 0; i < exceptions.count(); i++) {
-		if(exceptions[i] == date) {
-			return (int) i;
-		}
-		if(exceptions[i] > date) break;
-	}
+	QVector<QDate>::const_iterator it = std::lower_bound(exceptions.constBegin(), exceptions.constEnd(), date);
+	if(it != exceptions.constEnd() && *it == date) return (int) (it - exceptions.constBegin());
 	return -1;
 }
 bool Recurrence::hasException(const QDate &date) const {
 	return findException(date) >= 0;
 }
 bool Recurrence::removeException(const QDate &date) {
-	for(QVector<QDate>::iterator it = exceptions.begin(); it != exceptions.end(); ++it) {
-		if(*it == date) {
-			exceptions.erase(it);
-			return true;
-		}
-		if(*it > date) break;
-	}
-	return false;
+	QVector<QDate>::iterator it = std::lower_bound(exceptions.begin(), exceptions.end(), date);
+	if(it == exceptions.end() || *it != date) return false;
+	exceptions.erase(it);
+	modified();
+	return true;
 }
 void Recurrence::clearExceptions() {
 	exceptions.clear();
+	modified();
 }
 Budget *Recurrence::budget() const {return o_budget;}
 
@@ -348,7 +402,13 @@ void DailyRecurrence::writeAttributes(QXmlStreamAttributes *attr) {
 	attr->append("frequency", QString::number(i_frequency));
 }
 
+int DailyRecurrence::occurrencesUntil(const QDate &date) const {
+	if(date < startDate()) return 0;
+	return startDate().daysTo(date) / i_frequency + 1;
+}
 QDate DailyRecurrence::nextOccurrence(const QDate &date, bool include_equals) const {	
+	QDate cached_date;
+	if(cachedNextOccurrence(date, include_equals, cached_date)) return cached_date;
 	if(include_equals) {
 		if(date == startDate()) return date;
 	}
@@ -368,6 +428,8 @@ QDate DailyRecurrence::nextOccurrence(const QDate &date, bool include_equals) co
 }
 
 QDate DailyRecurrence::prevOccurrence(const QDate &date, bool include_equals) const {	
+	QDate cached_date;
+	if(cachedPrevOccurrence(date, include_equals, cached_date)) return cached_date;
 	if(!include_equals) {
 		if(!endDate().isNull() && date > endDate()) return lastOccurrence();
 	}
@@ -466,7 +528,27 @@ void WeeklyRecurrence::writeAttributes(QXmlStreamAttributes *attr) {
 	attr->append("days", days);
 }
 
+int count_days_of_week(const bool *daysofweek, int frequency, const QDate &week_start, const QDate &date) {
+	int days = week_start.daysTo(date);
+	int weeks = days / 7, n_week = 0, n_rem = 0;
+	for(int i = 0; i < 7; i++) {
+		if(daysofweek[i]) {
+			n_week++;
+			if(i <= days % 7) n_rem++;
+		}
+	}
+	int n = ((weeks + frequency - 1) / frequency) * n_week;
+	if(weeks % frequency == 0) n += n_rem;
+	return n;
+}
+int WeeklyRecurrence::occurrencesUntil(const QDate &date) const {
+	if(date < startDate()) return 0;
+	QDate week_start = startDate().addDays(1 - startDate().dayOfWeek());
+	return count_days_of_week(b_daysofweek, i_frequency, week_start, date) - count_days_of_week(b_daysofweek, i_frequency, week_start, startDate()) + 1;
+}
 QDate WeeklyRecurrence::nextOccurrence(const QDate &date, bool include_equals) const {	
+	QDate cached_date;
+	if(cachedNextOccurrence(date, include_equals, cached_date)) return cached_date;
 	if(!include_equals) {
 		if(date < startDate()) return firstOccurrence();
 	} else {
@@ -475,7 +557,7 @@ QDate WeeklyRecurrence::nextOccurrence(const QDate &date, bool include_equals) c
 	QDate nextdate = date;
 	if(!include_equals) nextdate = nextdate.addDays(1);
 	if(!endDate().isNull() && nextdate > endDate()) return QDate();
-	if(i_frequency != 1 && (nextdate.year() != startDate().year() || nextdate.weekNumber() != startDate().weekNumber())) {
+	if(i_frequency != 1) {
 		int i = weeks_between_dates(startDate(), nextdate) % i_frequency;
 		if(i != 0) {
 			nextdate = nextdate.addDays((i_frequency - i) * 7 - (nextdate.dayOfWeek() - 1));
@@ -507,6 +589,8 @@ QDate WeeklyRecurrence::nextOccurrence(const QDate &date, bool include_equals) c
 }
 
 QDate WeeklyRecurrence::prevOccurrence(const QDate &date, bool include_equals) const {	
+	QDate cached_date;
+	if(cachedPrevOccurrence(date, include_equals, cached_date)) return cached_date;
 	if(!include_equals) {
 		if(!endDate().isNull() && date > endDate()) return lastOccurrence();
 	}
@@ -514,33 +598,32 @@ QDate WeeklyRecurrence::prevOccurrence(const QDate &date, bool include_equals) c
 	if(!include_equals) prevdate = prevdate.addDays(-1);
 	if(prevdate < startDate()) return QDate();
 	if(prevdate == startDate()) return startDate();
-	if(i_frequency != 1 && (prevdate.year() != startDate().year() || prevdate.weekNumber() != startDate().weekNumber())) {
+	if(i_frequency != 1) {
 		int i = weeks_between_dates(startDate(), prevdate) % i_frequency;
 		if(i != 0) {
 			prevdate = prevdate.addDays(-(i * 7) + 7 - prevdate.dayOfWeek());
 		}
 	}
 	int dow_s = startDate().dayOfWeek();
-	bool s_week = prevdate.year() == startDate().year() && prevdate.weekNumber() == startDate().weekNumber();
+	bool s_week = (weeks_between_dates(startDate(), prevdate) == 0);
 	int dow = prevdate.dayOfWeek();
 	int i = dow;
-	for(; i <= 7; i++) {
+	for(; i >= 1; i--) {
 		if(b_daysofweek[i - 1] || (s_week && dow_s == i)) {
 			break;
 		}
 	}
-	if(i > 7) {
-		for(i = 1; i <= 7; i++) {
+	if(i < 1) {
+		s_week = (weeks_between_dates(startDate(), prevdate) == i_frequency);
+		for(i = 7; i >= 1; i--) {
 			if(b_daysofweek[i - 1] || (s_week && dow_s == i)) {
 				break;
 			}
 		}
-		if(i > 7) return QDate();
-	}
-	if(i > dow) {
-		prevdate = prevdate.addDays(-(i_frequency * 7) + dow - i);
+		if(i < 1) return QDate();
+		prevdate = prevdate.addDays(-(i_frequency * 7) + i - dow);
 	} else if(i < dow) {
-		prevdate = prevdate.addDays(dow - i);
+		prevdate = prevdate.addDays(i - dow);
 	}
 	if(prevdate < startDate()) return QDate();
 	if(hasException(prevdate)) return prevOccurrence(prevdate);
@@ -615,7 +698,65 @@ void MonthlyRecurrence::writeAttributes(QXmlStreamAttributes *attr) {
 	}
 }
 
+QDate MonthlyRecurrence::periodOccurrence(int period) const {
+	QDate month;
+	month.setDate(startDate().year(), startDate().month(), 1);
+	month = month.addMonths(period * i_frequency);
+	int day = i_day;
+	if(i_dayofweek > 0) day = get_day_in_month(month, i_week, i_dayofweek);
+	else if(i_day < 1) day = month.daysInMonth() + i_day;
+	QDate date;
+	date.setDate(month.year(), month.month(), day);
+	int wday = date.dayOfWeek();
+	if(wh_weekendhandling == WEEKEND_HANDLING_BEFORE) {
+		if(wday == 6) day -= 1;
+		else if(wday == 7) day -= 2;
+	} else if(wh_weekendhandling == WEEKEND_HANDLING_AFTER) {
+		if(wday == 6) day += 2;
+		else if(wday == 7) day += 1;
+	} else if(wh_weekendhandling == WEEKEND_HANDLING_NEAREST) {
+		if(wday == 6) day -= 1;
+		else if(wday == 7) day += 1;
+	}
+	if(day <= 0 && (wh_weekendhandling == WEEKEND_HANDLING_BEFORE || (wh_weekendhandling == WEEKEND_HANDLING_NEAREST && wday == 6))) {
+		month = month.addMonths(-1);
+		day += month.daysInMonth();
+	} else if(day > month.daysInMonth() && (wh_weekendhandling == WEEKEND_HANDLING_AFTER || (wh_weekendhandling == WEEKEND_HANDLING_NEAREST && wday == 7))) {
+		day -= month.daysInMonth();
+		month = month.addMonths(1);
+	}
+	if(day <= 0 || day > month.daysInMonth()) return QDate();
+	date.setDate(month.year(), month.month(), day);
+	return date;
+}
+bool MonthlyRecurrence::hasRegularPeriods() const {
+	//the day exists in every month
+	if(i_dayofweek > 0) return i_week >= -3 && i_week <= 4;
+	return i_day >= -27 && i_day <= 28;
+}
+int MonthlyRecurrence::occurrencesUntil(const QDate &date) const {
+	if(date < startDate()) return 0;
+	int periods = (months_between_dates(startDate(), date) + 1) / i_frequency;
+	int n = 0;
+	if(hasRegularPeriods()) {
+		while(periods > 0 && periodOccurrence(periods) > date) periods--;
+		n = periods;
+		if(n > 0 && periodOccurrence(1) <= startDate()) n--;
+	} else {
+		QDate last = startDate();
+		for(int i = 1; i <= periods; i++) {
+			QDate next = periodOccurrence(i);
+			if(!next.isNull() && next > last && next <= date) {
+				n++;
+				last = next;
+			}
+		}
+	}
+	return n + 1;
+}
 QDate MonthlyRecurrence::nextOccurrence(const QDate &date, bool include_equals) const {	
+	QDate cached_date;
+	if(cachedNextOccurrence(date, include_equals, cached_date)) return cached_date;
 	if(!include_equals) {
 		if(date < startDate()) return firstOccurrence();
 	} else {
@@ -744,6 +885,8 @@ QDate MonthlyRecurrence::nextOccurrence(const QDate &date, bool include_equals)
 }
 
 QDate MonthlyRecurrence::prevOccurrence(const QDate &date, bool include_equals) const {	
+	QDate cached_date;
+	if(cachedPrevOccurrence(date, include_equals, cached_date)) return cached_date;
 	if(!include_equals) {
 		if(!endDate().isNull() && date > endDate()) return lastOccurrence();
 	}
@@ -958,7 +1101,44 @@ void YearlyRecurrence::writeAttributes(QXmlStreamAttributes *attr) {
 		attr->append("weekendhandling", QString::number(wh_weekendhandling));
 	}
 }
+QDate YearlyRecurrence::periodOccurrence(int period) const {
+	int year = startDate().year() + period * i_frequency;
+	QDate date;
+	if(i_dayofyear > 0) {
+		date.setDate(year, 1, 1);
+		if(i_dayofyear > date.daysInYear()) return QDate();
+		return date.addDays(i_dayofyear - 1);
+	}
+	int day = i_dayofmonth;
+	if(i_dayofweek > 0) day = get_day_in_month(year, i_month, i_week, i_dayofweek);
+	date.setDate(year, i_month, day);
+	return date;
+}
+bool YearlyRecurrence::hasRegularPeriods() const {
+	//the day exists in every year
+	if(i_dayofyear > 0) return i_dayofyear <= 365;
+	if(i_dayofweek > 0) return i_week >= -3 && i_week <= 4;
+	QDate date;
+	date.setDate(2001, i_month, 1);
+	return i_dayofmonth >= 1 && i_dayofmonth <= date.daysInMonth();
+}
+int YearlyRecurrence::occurrencesUntil(const QDate &date) const {
+	if(date < startDate()) return 0;
+	int periods = (date.year() - startDate().year()) / i_frequency;
+	if(hasRegularPeriods()) {
+		if(periods > 0 && periodOccurrence(periods) > date) periods--;
+		return periods + 1;
+	}
+	int n = 1;
+	for(int i = 1; i <= periods; i++) {
+		QDate next = periodOccurrence(i);
+		if(!next.isNull() && next <= date) n++;
+	}
+	return n;
+}
 QDate YearlyRecurrence::nextOccurrence(const QDate &date, bool include_equals) const {
+	QDate cached_date;
+	if(cachedNextOccurrence(date, include_equals, cached_date)) return cached_date;
 	if(!include_equals) {
 		if(date < startDate()) return firstOccurrence();
 	} else {
@@ -1020,6 +1200,8 @@ QDate YearlyRecurrence::nextOccurrence(const QDate &date, bool include_equals) c
 }
 
 QDate YearlyRecurrence::prevOccurrence(const QDate &date, bool include_equals) const {	
+	QDate cached_date;
+	if(cachedPrevOccurrence(date, include_equals, cached_date)) return cached_date;
 	if(!include_equals) {
 		if(!endDate().isNull() && date > endDate()) return lastOccurrence();
 	}
@@ -45,6 +45,19 @@ class Recurrence {
 		Budget *o_budget;
 		QDate d_startdate, d_enddate;
 		int i_count;
+		int i_revision;
+
+		//occurrences in the most recently queried window (see occurrences()), used by nextOccurrence() and prevOccurrence()
+		mutable QVector<QDate> v_occurrences;
+		mutable QDate d_occurrences_first, d_occurrences_last;
+
+		//number of occurrences from the start date up to and including date, not taking exceptions and end date into account
+		virtual int occurrencesUntil(const QDate &date) const = 0;
+		bool cachedNextOccurrence(const QDate &date, bool include_equals, QDate &next_date) const;
+		bool cachedPrevOccurrence(const QDate &date, bool include_equals, QDate &prev_date) const;
+		void clearOccurrenceCache() const;
+		//called when the occurrences might have changed
+		void modified();
 
 	public:
 
@@ -67,6 +80,8 @@ class Recurrence {
 		virtual QDate prevOccurrence(const QDate &date, bool include_equals = false) const = 0;
 		const QDate &firstOccurrence() const;
 		const QDate &lastOccurrence() const;
+		//returns all occurrences from first_date to last_date and caches them for following nextOccurrence()/prevOccurrence() calls (not thread-safe)
+		QVector<QDate> occurrences(const QDate &first_date, const QDate &last_date) const;
 		int countOccurrences(const QDate &startdate, const QDate &enddate) const;
 		int countOccurrences(const QDate &enddate) const;
 		bool removeOccurrence(const QDate &date);
@@ -83,6 +98,8 @@ class Recurrence {
 		bool removeException(const QDate &date);
 		void clearExceptions();
 		Budget *budget() const;
+		//changed by every modification that might affect the occurrences; unique among all recurrences
+		int revision() const;
 
 		QVector<QDate> exceptions;
 
@@ -94,6 +111,8 @@ class DailyRecurrence : public Recurrence {
 
 		int i_frequency;
 
+		int occurrencesUntil(const QDate &date) const;
+
 	public:
 
 		DailyRecurrence(Budget *parent_budget);
@@ -120,6 +139,8 @@ class WeeklyRecurrence : public Recurrence {
 		int i_frequency;
 		bool b_daysofweek[7];
 
+		int occurrencesUntil(const QDate &date) const;
+
 	public:
 
 		WeeklyRecurrence(Budget *parent_budget);
@@ -157,6 +178,10 @@ class MonthlyRecurrence : public Recurrence {
 		int i_dayofweek;
 		WeekendHandling wh_weekendhandling;
 
+		QDate periodOccurrence(int period) const;
+		bool hasRegularPeriods() const;
+		int occurrencesUntil(const QDate &date) const;
+
 	public:
 
 		MonthlyRecurrence(Budget *parent_budget);
@@ -193,6 +218,10 @@ class YearlyRecurrence : public Recurrence {
 		int i_dayofyear;
 		WeekendHandling wh_weekendhandling;
 
+		QDate periodOccurrence(int period) const;
+		bool hasRegularPeriods() const;
+		int occurrencesUntil(const QDate &date) const;
+
 	public:
 
 		YearlyRecurrence(Budget *parent_budget);
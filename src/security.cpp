@@ -31,6 +31,7 @@
 #include "recurrence.h"
 #include "security.h"
 
+#include <algorithm>
 #include <cmath>
 
 void Security::init() {
@@ -41,6 +42,8 @@ void Security::init() {
 	tradedShares.setAutoDelete(false);
 	reinvestedDividends.setAutoDelete(false);
 	scheduledReinvestedDividends.setAutoDelete(false);
+	b_cash_flows_valid = false;
+	b_ledger_valid = false;
 }
 Security::Security(Budget *parent_budget, AssetsAccount *parent_account, SecurityType initial_type, double initial_shares, int initial_decimals, int initial_quotation_decimals, QString initial_name, QString initial_description) : o_budget(parent_budget), i_id(parent_budget->getNewId()), i_first_revision(parent_budget->revision()), i_last_revision(parent_budget->revision()), o_account(parent_account), st_type(initial_type), d_initial_shares(initial_shares), i_decimals(initial_decimals), i_quotation_decimals(initial_quotation_decimals), s_name(initial_name.trimmed()), s_description(initial_description) {
 	init();
@@ -51,7 +54,7 @@ Security::Security(Budget *parent_budget, QXmlStreamReader *xml, bool *valid) :
 	readAttributes(&attr, valid);
 	readElements(xml, valid);
 }
-Security::Security(Budget *parent_budget) : o_budget(parent_budget), i_id(parent_budget->getNewId()), i_first_revision(parent_budget->revision()), i_last_revision(parent_budget->revision()) {}
+Security::Security(Budget *parent_budget) : o_budget(parent_budget), i_id(parent_budget->getNewId()), i_first_revision(parent_budget->revision()), i_last_revision(parent_budget->revision()) {init();}
 Security::Security() : o_budget(NULL), i_id(0), i_first_revision(1), i_last_revision(1), o_account(NULL), st_type(SECURITY_TYPE_STOCK), d_initial_shares(0.0), i_decimals(-1), i_quotation_decimals(-1) {init();}
 Security::Security(const Security *security) : o_budget(security->budget()), i_id(security->id()), i_first_revision(security->firstRevision()), i_last_revision(security->lastRevision()), o_account(security->account()), st_type(security->type()), d_initial_shares(security->initialShares()), i_decimals(security->decimals()), i_quotation_decimals(security->quotationDecimals()), s_name(security->name()), s_description(security->description()) {init();}
 Security::~Security() {}
@@ -67,6 +70,7 @@ void Security::set(const Security *security) {
 	i_decimals = security->decimals();
 	quotations = security->quotations;
 	quotations_auto = security->quotations_auto;
+	quotationsModified();
 }
 void Security::setMergeQuotes(const Security *security) {
 	i_id = security->id();
@@ -86,6 +90,7 @@ void Security::mergeQuotes(const Security *security, bool keep) {
 	for(QMap<QDate, bool>::const_iterator it = security->quotations_auto.begin(); it != security->quotations_auto.end(); ++it) {
 		if(!keep || !quotations_auto.contains(it.key())) quotations_auto[it.key()] = it.value();
 	}
+	quotationsModified();
 }
 
 void Security::readAttributes(QXmlStreamAttributes *attr, bool *valid) {
@@ -122,6 +127,7 @@ bool Security::readElement(QXmlStreamReader *xml, bool*) {
 		QDate date = QDate::fromString(attr.value("date").toString(), Qt::ISODate);
 		quotations[date] = attr.value("value").toDouble();
 		quotations_auto[date] = attr.value("auto").toInt();
+		quotationsModified();
 	}
 	return false;
 }
@@ -194,40 +200,72 @@ void Security::setQuotation(const QDate &date, double value, bool auto_added) {
 	if(!auto_added) {
 		quotations[date] = value;
 		quotations_auto[date] = false;
+		quotationsModified();
 	} else if(!quotations.count(date) || quotations_auto[date]) {
 		quotations[date] = value;
 		quotations_auto[date] = true;
+		quotationsModified();
 	}
 }
 void Security::removeQuotation(const QDate &date, bool auto_added) {
 	if(quotations.count(date) && (!auto_added || quotations_auto[date])) {
 		quotations.remove(date);
 		quotations_auto.remove(date);
+		quotationsModified();
 	}
 }
 void Security::clearQuotations() {
 	quotations.clear();
 	quotations_auto.clear();
+	quotationsModified();
+}
+void Security::quotationsModified() {
+	d_eq_cache_from = QDate();
+	d_eq_cache_to = QDate();
+	transactionsModified();
+	//trades are valued using the quotation of the security the shares were traded from
+	for(TradedSharesList<SecurityTrade*>::const_iterator it = tradedShares.constBegin(); it != tradedShares.constEnd(); ++it) {
+		if((*it)->from_security == this && (*it)->to_security != this) (*it)->to_security->transactionsModified();
+	}
+}
+void Security::transactionsModified() {
+	b_cash_flows_valid = false;
+	v_cash_flows.clear();
+	v_cash_flow_shares.clear();
+	mwr_cache.clear();
+	twr_cache.clear();
+	b_ledger_valid = false;
+	v_ledger.clear();
 }
 double Security::getQuotation(const QDate &date, QDate *actual_date) const {
-	if(quotations.contains(date)) {
-		if(actual_date) *actual_date = date;
-		return quotations[date];
+	QMap<QDate, double>::const_iterator it_begin = quotations.constBegin();
+	if(it_begin == quotations.constEnd()) {
+		if(actual_date) *actual_date = QDate();
+		return 0.0;
 	}
-	QMap<QDate, double>::const_iterator it_begin = quotations.begin();
-	QMap<QDate, double>::const_iterator it = quotations.end();
-	if(it != it_begin) {
-		--it;
-		while(true) {
-			if(it.key() <= date || it == it_begin) {
-				if(actual_date) *actual_date = it.key();
-				return it.value();
-			}
-			--it;
+	//first quotation after date; the preceding quotation (if any) is the one in effect
+	QMap<QDate, double>::const_iterator it = quotations.upperBound(date);
+	if(it != it_begin) --it;
+	if(actual_date) *actual_date = it.key();
+	return it.value();
+}
+void Security::getQuotations(const QVector<QDate> &dates, QVector<double> &values) const {
+	values.resize(dates.count());
+	QMap<QDate, double>::const_iterator it = quotations.constBegin();
+	QMap<QDate, double>::const_iterator it_end = quotations.constEnd();
+	if(it == it_end) {
+		values.fill(0.0);
+		return;
+	}
+	QMap<QDate, double>::const_iterator it_next = it;
+	++it_next;
+	for(int i = 0; i < dates.count(); i++) {
+		while(it_next != it_end && it_next.key() <= dates[i]) {
+			it = it_next;
+			++it_next;
 		}
+		values[i] = it.value();
 	}
-	if(actual_date) *actual_date = QDate();
-	return 0.0;
 }
 bool Security::hasQuotation(const QDate &date) const {
 	return quotations.contains(date);
@@ -337,6 +375,21 @@ double Security::value(const QDate &date, int estimate, bool no_scheduled_shares
 }
 double Security::cost(const QDate &date, bool no_scheduled_shares, Currency *cur) {
 	if(!cur) cur = currency();
+	double c;
+	bool at_date = (budget()->defaultTransactionConversionRateDate() == TRANSACTION_CONVERSION_RATE_AT_DATE);
+	costLedger();
+	if((cur == currency() || cur == budget()->defaultCurrency()) && (at_date || !b_ledger_foreign)) {
+		const SecurityLedgerEntry &e = ledgerEntry(date);
+		if(cur == currency()) c = e.cost;
+		else if(at_date) c = e.default_cost;
+		else c = currency()->convertTo(e.cost, cur, date);
+	} else {
+		c = scannedCost(date, cur);
+	}
+	if(!no_scheduled_shares) c += scheduledCost(date, cur);
+	return c;
+}
+double Security::scannedCost(const QDate &date, Currency *cur) {
 	double c = d_initial_shares;
 	QMap<QDate, double>::const_iterator it_q = quotations.begin();
 	if(it_q == quotations.end()) {
@@ -379,19 +432,21 @@ double Security::cost(const QDate &date, bool no_scheduled_shares, Currency *cur
 		if(ts->from_security == this) c -= v;
 		else c += v;
 	}
-	if(!no_scheduled_shares) {
-		for(ScheduledSecurityTransactionList<ScheduledTransaction*>::const_iterator it = scheduledTransactions.constBegin(); it != scheduledTransactions.constEnd(); ++it) {
-			ScheduledTransaction *strans = *it;
-			if(strans->date() > date) break;
-			int n = strans->recurrence()->countOccurrences(date);
-			if(n > 0) {
-				double v = strans->value();
-				if(cur != strans->currency()) {
-					v = strans->currency()->convertTo(v, cur);
-				}
-				if(strans->transactiontype() == TRANSACTION_TYPE_SECURITY_BUY) c += v * n;
-				else c -= v * n;
+	return c;
+}
+double Security::scheduledCost(const QDate &date, Currency *cur) {
+	double c = 0.0;
+	for(ScheduledSecurityTransactionList<ScheduledTransaction*>::const_iterator it = scheduledTransactions.constBegin(); it != scheduledTransactions.constEnd(); ++it) {
+		ScheduledTransaction *strans = *it;
+		if(strans->date() > date) break;
+		int n = strans->recurrence()->countOccurrences(date);
+		if(n > 0) {
+			double v = strans->value();
+			if(cur != strans->currency()) {
+				v = strans->currency()->convertTo(v, cur);
 			}
+			if(strans->transactiontype() == TRANSACTION_TYPE_SECURITY_BUY) c += v * n;
+			else c -= v * n;
 		}
 	}
 	return c;
@@ -539,13 +594,13 @@ double Security::yearlyRate() {
 	}
 	for(SecurityTransactionList<Income*>::const_iterator it = dividends.constBegin(); it != dividends.constEnd(); ++it) {
 		Income *trans = *it;
-		double s = shares(trans->date());
+		double s = cachedShares(trans->date());
 		if(s > 0.0) q2 += trans->income() / s;
 	}
 	double shares_change = 0.0;
 	for(SecurityTransactionList<ReinvestedDividend*>::const_iterator it = reinvestedDividends.constBegin(); it != reinvestedDividends.constEnd(); ++it) {
 		ReinvestedDividend *rediv = *it;
-		double s = shares(rediv->date());
+		double s = cachedShares(rediv->date());
 		if(s > 0.0) shares_change += rediv->shares() / (s - rediv->shares());
 	}
 	if(date1 == date2) return 0.0;
@@ -576,14 +631,14 @@ double Security::yearlyRate(const QDate &date) {
 	for(SecurityTransactionList<Income*>::const_iterator it = dividends.constBegin(); it != dividends.constEnd(); ++it) {
 		Income *trans = *it;
 		if(trans->date() > date2) break;
-		double s = shares(trans->date());
+		double s = cachedShares(trans->date());
 		if(s > 0.0) q2 += trans->income() / s;
 	}
 	double shares_change = 0.0;
 	for(SecurityTransactionList<ReinvestedDividend*>::const_iterator it = reinvestedDividends.constBegin(); it != reinvestedDividends.constEnd(); ++it) {
 		ReinvestedDividend *rediv = *it;
 		if(rediv->date() > date2) break;
-		double s = shares(rediv->date());
+		double s = cachedShares(rediv->date());
 		if(s > 0.0) shares_change += rediv->shares() / (s - rediv->shares());
 	}
 	double change = q2 / q1 + shares_change;
@@ -632,7 +687,7 @@ double Security::yearlyRate(const QDate &date1, const QDate &date2) {
 		Income *trans = *it;
 		if(trans->date() > date2) break;
 		if(trans->date() >= date1) {
-			double s = shares(trans->date());
+			double s = cachedShares(trans->date());
 			if(s > 0.0) q2 += trans->income() / s;
 		}
 	}
@@ -641,45 +696,361 @@ double Security::yearlyRate(const QDate &date1, const QDate &date2) {
 		ReinvestedDividend *rediv = *it;
 		if(rediv->date() > date2) break;
 		if(rediv->date() >= date1) {
-			double s = shares(rediv->date());
+			double s = cachedShares(rediv->date());
 			if(s > 0.0) shares_change += rediv->shares() / (s - rediv->shares());
 		}
 	}
 	double change = q2 / q1 + shares_change;
 	return pow(change, 1 / o_budget->yearsBetweenDates(date1, date2, false)) - 1;
 }
+static double interpolate_quotation(const QDate &date1, double q1, const QDate &date2, double q2, const QDate &date) {
+	if(q1 == q2) return q2;
+	double days = date1.daysTo(date), days2 = date1.daysTo(date2);
+	return q1 * pow(q2 / q1, days / days2);
+}
 double Security::expectedQuotation(const QDate &date) {
-	if(quotations.contains(date)) {
-		return quotations[date];
-	}
-	QMap<QDate, double>::const_iterator it_begin = quotations.begin();
-	QMap<QDate, double>::const_iterator it = quotations.end();
+	const QMap<QDate, double> &q = quotations;
+	QMap<QDate, double>::const_iterator it_begin = q.constBegin();
+	QMap<QDate, double>::const_iterator it = q.constEnd();
 	if(it == it_begin) return 0.0;
 	--it;
 	if(it == it_begin) return it_begin.value();
-	if(date < it_begin.key()) {		
+	if(date < it_begin.key()) {
 		int days = date.daysTo(it_begin.key());
 		double q2 = expectedQuotation(it_begin.key().addDays(days));
 		return it_begin.value() * (it_begin.value() / q2);
 	}
-	if(it.key() < date) {		
+	if(it.key() < date) {
 		int days = it.key().daysTo(date);
 		double q1 = expectedQuotation(it.key().addDays(-days));
 		return it.value() * (it.value() / q1);
 	}
-	--it;
-	while(true) {
-		if(it.key() < date) {
-			it_begin = it;
-			++it;
-			double days = it_begin.key().daysTo(date), days2 = it_begin.key().daysTo(it.key());
-			if(it.value() == it_begin.value()) return it.value();
-			double rate = it.value() / it_begin.value();
-			return it_begin.value() * pow(rate, days / days2);
+	//consecutive calls usually ask for dates between the same two quotations
+	if(d_eq_cache_from.isValid() && date >= d_eq_cache_from && date < d_eq_cache_to) {
+		return interpolate_quotation(d_eq_cache_from, d_eq_cache_from_value, d_eq_cache_to, d_eq_cache_to_value, date);
+	}
+	it = q.lowerBound(date);
+	if(it.key() == date) return it.value();
+	QMap<QDate, double>::const_iterator it_prev = it;
+	--it_prev;
+	d_eq_cache_from = it_prev.key();
+	d_eq_cache_from_value = it_prev.value();
+	d_eq_cache_to = it.key();
+	d_eq_cache_to_value = it.value();
+	return interpolate_quotation(it_prev.key(), it_prev.value(), it.key(), it.value(), date);
+}
+void Security::expectedQuotations(const QVector<QDate> &dates, QVector<double> &values) {
+	values.resize(dates.count());
+	const QMap<QDate, double> &q = quotations;
+	QMap<QDate, double>::const_iterator it_begin = q.constBegin();
+	QMap<QDate, double>::const_iterator it_end = q.constEnd();
+	if(it_begin == it_end) {
+		values.fill(0.0);
+		return;
+	}
+	QMap<QDate, double>::const_iterator it_last = it_end;
+	--it_last;
+	QMap<QDate, double>::const_iterator it = it_begin;
+	QMap<QDate, double>::const_iterator it_next = it;
+	++it_next;
+	for(int i = 0; i < dates.count(); i++) {
+		const QDate &date = dates[i];
+		if(it_begin == it_last || date < it_begin.key() || date > it_last.key()) {
+			values[i] = expectedQuotation(date);
+			continue;
+		}
+		while(it_next != it_end && it_next.key() <= date) {
+			it = it_next;
+			++it_next;
+		}
+		if(it.key() == date || it_next == it_end) values[i] = it.value();
+		else values[i] = interpolate_quotation(it.key(), it.value(), it_next.key(), it_next.value(), date);
+	}
+}
+
+static bool cash_flow_less_than(const SecurityCashFlow &cf1, const SecurityCashFlow &cf2) {
+	return cf1.date < cf2.date;
+}
+static bool date_cash_flow_less_than(const QDate &date, const SecurityCashFlow &cf) {
+	return date < cf.date;
+}
+static void add_cash_flow(QVector<SecurityCashFlow> &flows, const QDate &date, double shares, double value, Currency *from_cur, Currency *to_cur) {
+	SecurityCashFlow cf;
+	cf.date = date;
+	cf.shares = shares;
+	cf.value = value;
+	if(value != 0.0 && from_cur != to_cur) cf.value = from_cur->convertTo(value, to_cur, date);
+	flows << cf;
+}
+const QVector<SecurityCashFlow> &Security::cashFlows() {
+	if(b_cash_flows_valid) return v_cash_flows;
+	v_cash_flows.clear();
+	Currency *cur = currency();
+	for(SecurityTransactionList<SecurityTransaction*>::const_iterator it = transactions.constBegin(); it != transactions.constEnd(); ++it) {
+		SecurityTransaction *trans = *it;
+		if(trans->type() == TRANSACTION_TYPE_SECURITY_BUY) add_cash_flow(v_cash_flows, trans->date(), trans->shares(), trans->value(), trans->currency(), cur);
+		else add_cash_flow(v_cash_flows, trans->date(), -trans->shares(), -trans->value(), trans->currency(), cur);
+	}
+	for(TradedSharesList<SecurityTrade*>::const_iterator it = tradedShares.constBegin(); it != tradedShares.constEnd(); ++it) {
+		SecurityTrade *ts = *it;
+		double v = ts->from_shares * ts->from_security->getQuotation(ts->date);
+		if(ts->from_security == this) add_cash_flow(v_cash_flows, ts->date, -ts->from_shares, -v, ts->from_security->currency(), cur);
+		else add_cash_flow(v_cash_flows, ts->date, ts->to_shares, v, ts->from_security->currency(), cur);
+	}
+	for(SecurityTransactionList<ReinvestedDividend*>::const_iterator it = reinvestedDividends.constBegin(); it != reinvestedDividends.constEnd(); ++it) {
+		ReinvestedDividend *rediv = *it;
+		add_cash_flow(v_cash_flows, rediv->date(), rediv->shares(), 0.0, cur, cur);
+	}
+	for(SecurityTransactionList<Income*>::const_iterator it = dividends.constBegin(); it != dividends.constEnd(); ++it) {
+		Income *trans = *it;
+		add_cash_flow(v_cash_flows, trans->date(), 0.0, -trans->income(), trans->currency(), cur);
+	}
+	std::stable_sort(v_cash_flows.begin(), v_cash_flows.end(), cash_flow_less_than);
+	v_cash_flow_shares.resize(v_cash_flows.count());
+	double n = d_initial_shares;
+	for(int i = 0; i < v_cash_flows.count(); i++) {
+		n += v_cash_flows[i].shares;
+		v_cash_flow_shares[i] = n;
+	}
+	b_cash_flows_valid = true;
+	return v_cash_flows;
+}
+struct SecurityLedgerItem {
+	QDate date;
+	double shares, value;
+	bool dividend;
+	Currency *currency;
+};
+static bool ledger_item_less_than(const SecurityLedgerItem &i1, const SecurityLedgerItem &i2) {
+	return i1.date < i2.date;
+}
+static bool date_ledger_entry_less_than(const QDate &date, const SecurityLedgerEntry &e) {
+	return date < e.date;
+}
+static void add_ledger_item(QVector<SecurityLedgerItem> &items, const QDate &date, double shares, double value, bool dividend, Currency *cur) {
+	SecurityLedgerItem item;
+	item.date = date;
+	item.shares = shares;
+	item.value = value;
+	item.dividend = dividend;
+	item.currency = cur;
+	items << item;
+}
+const QVector<SecurityLedgerEntry> &Security::costLedger() {
+	Currency *cur = currency(), *dcur = budget()->defaultCurrency();
+	if(b_ledger_valid && o_ledger_currency == cur && o_ledger_default_currency == dcur) return v_ledger;
+	v_ledger.clear();
+	b_ledger_foreign = false;
+	o_ledger_currency = cur;
+	o_ledger_default_currency = dcur;
+	QVector<SecurityLedgerItem> items;
+	for(SecurityTransactionList<SecurityTransaction*>::const_iterator it = transactions.constBegin(); it != transactions.constEnd(); ++it) {
+		SecurityTransaction *trans = *it;
+		if(trans->type() == TRANSACTION_TYPE_SECURITY_BUY) add_ledger_item(items, trans->date(), trans->shares(), trans->value(), false, trans->currency());
+		else add_ledger_item(items, trans->date(), -trans->shares(), -trans->value(), false, trans->currency());
+	}
+	for(TradedSharesList<SecurityTrade*>::const_iterator it = tradedShares.constBegin(); it != tradedShares.constEnd(); ++it) {
+		SecurityTrade *ts = *it;
+		double v = ts->from_shares * ts->from_security->getQuotation(ts->date);
+		if(ts->from_security == this) add_ledger_item(items, ts->date, -ts->from_shares, -v, false, ts->from_security->currency());
+		else add_ledger_item(items, ts->date, ts->to_shares, v, false, ts->from_security->currency());
+	}
+	for(SecurityTransactionList<ReinvestedDividend*>::const_iterator it = reinvestedDividends.constBegin(); it != reinvestedDividends.constEnd(); ++it) {
+		ReinvestedDividend *rediv = *it;
+		add_ledger_item(items, rediv->date(), rediv->shares(), 0.0, false, cur);
+	}
+	for(SecurityTransactionList<Income*>::const_iterator it = dividends.constBegin(); it != dividends.constEnd(); ++it) {
+		Income *trans = *it;
+		add_ledger_item(items, trans->date(), 0.0, trans->income(), true, trans->currency());
+	}
+	std::stable_sort(items.begin(), items.end(), ledger_item_less_than);
+	SecurityLedgerEntry e;
+	e.shares = d_initial_shares;
+	e.cost = 0.0;
+	e.default_cost = 0.0;
+	e.realized = 0.0;
+	e.default_realized = 0.0;
+	QMap<QDate, double>::const_iterator it_q = quotations.constBegin();
+	if(it_q != quotations.constEnd()) {
+		e.cost = d_initial_shares * it_q.value();
+		e.default_cost = (cur == dcur ? e.cost : cur->convertTo(e.cost, dcur, it_q.key()));
+	}
+	e.basis = e.cost;
+	e_ledger_initial = e;
+	for(int i = 0; i < items.count(); i++) {
+		const SecurityLedgerItem &item = items[i];
+		double v = item.value, v_default = item.value;
+		if(item.currency != cur) {
+			b_ledger_foreign = true;
+			v = item.currency->convertTo(item.value, cur, item.date);
+		}
+		if(item.currency != dcur) v_default = item.currency->convertTo(item.value, dcur, item.date);
+		if(item.dividend) {
+			e.realized += v;
+			e.default_realized += v_default;
+		} else if(item.shares < 0.0) {
+			double sold_basis = 0.0;
+			if(e.shares > 0.0) sold_basis = (e.basis / e.shares) * -item.shares;
+			e.realized += -v - sold_basis;
+			e.default_realized += -v_default - (cur == dcur ? sold_basis : cur->convertTo(sold_basis, dcur, item.date));
+			e.basis -= sold_basis;
+			e.shares += item.shares;
+			e.cost += v;
+			e.default_cost += v_default;
+		} else {
+			e.shares += item.shares;
+			e.basis += v;
+			e.cost += v;
+			e.default_cost += v_default;
+		}
+		if(i + 1 == items.count() || items[i + 1].date != item.date) {
+			e.date = item.date;
+			v_ledger << e;
+		}
+	}
+	b_ledger_valid = true;
+	return v_ledger;
+}
+const SecurityLedgerEntry &Security::ledgerEntry(const QDate &date) {
+	const QVector<SecurityLedgerEntry> &ledger = costLedger();
+	int i = std::upper_bound(ledger.constBegin(), ledger.constEnd(), date, date_ledger_entry_less_than) - ledger.constBegin();
+	if(i == 0) return e_ledger_initial;
+	return ledger[i - 1];
+}
+double Security::realizedProfit(const QDate &date, Currency *cur) {
+	if(!cur) cur = currency();
+	const SecurityLedgerEntry &e = ledgerEntry(date);
+	if(cur == currency()) return e.realized;
+	if(cur == budget()->defaultCurrency()) return e.default_realized;
+	return currency()->convertTo(e.realized, cur, date);
+}
+double Security::unrealizedProfit(const QDate &date, Currency *cur) {
+	if(!cur) cur = currency();
+	const SecurityLedgerEntry &e = ledgerEntry(date);
+	double p = e.shares * getQuotation(date) - e.basis;
+	if(cur != currency()) p = currency()->convertTo(p, cur, date);
+	return p;
+}
+double Security::historicalShares(const QDate &date) {
+	const QVector<SecurityCashFlow> &flows = cashFlows();
+	int i = std::upper_bound(flows.constBegin(), flows.constEnd(), date, date_cash_flow_less_than) - flows.constBegin();
+	if(i == 0) return d_initial_shares;
+	return v_cash_flow_shares[i - 1];
+}
+double Security::cachedShares(const QDate &date) {
+	double n = historicalShares(date);
+	for(ScheduledSecurityTransactionList<ScheduledTransaction*>::const_iterator it = scheduledTransactions.constBegin(); it != scheduledTransactions.constEnd(); ++it) {
+		ScheduledTransaction *strans = *it;
+		if(strans->date() > date) break;
+		int no = strans->recurrence()->countOccurrences(date);
+		if(no > 0) {
+			if(strans->transactiontype() == TRANSACTION_TYPE_SECURITY_BUY) n += ((SecurityTransaction*) strans->transaction())->shares() * no;
+			else n -= ((SecurityTransaction*) strans->transaction())->shares() * no;
 		}
-		if(it == it_begin) break;
-		--it;
 	}
-	return 0.0;
+	for(ScheduledSecurityTransactionList<ScheduledTransaction*>::const_iterator it = scheduledReinvestedDividends.constBegin(); it != scheduledReinvestedDividends.constEnd(); ++it) {
+		ScheduledTransaction *strans = *it;
+		if(strans->date() > date) break;
+		int no = strans->recurrence()->countOccurrences(date);
+		if(no > 0) n += ((ReinvestedDividend*) strans->transaction())->shares() * no;
+	}
+	return n;
 }
 
+/* Finds r where sum(amounts[i] * (1 + r)^-years[i]) = 0, using Newton's method, falling back to bisection whenever a step leaves the bracket */
+static double solve_rate(const QVector<double> &amounts, const QVector<double> &years) {
+	double lo = -0.9999, hi = 1.0;
+	double f_lo = 0.0, f_hi = 0.0;
+	for(int i = 0; i < amounts.count(); i++) {
+		f_lo += amounts[i] * pow(1.0 + lo, -years[i]);
+		f_hi += amounts[i] * pow(1.0 + hi, -years[i]);
+	}
+	while((f_lo < 0.0) == (f_hi < 0.0)) {
+		if(hi > 1.0e6) return 0.0;
+		hi *= 10.0;
+		f_hi = 0.0;
+		for(int i = 0; i < amounts.count(); i++) f_hi += amounts[i] * pow(1.0 + hi, -years[i]);
+	}
+	double r = 0.05;
+	if(r <= lo || r >= hi) r = (lo + hi) / 2.0;
+	for(int n = 0; n < 100; n++) {
+		double f = 0.0, df = 0.0;
+		for(int i = 0; i < amounts.count(); i++) {
+			double d = pow(1.0 + r, -years[i]);
+			f += amounts[i] * d;
+			df -= years[i] * amounts[i] * d / (1.0 + r);
+		}
+		if(fabs(f) < 1.0e-9) return r;
+		if((f < 0.0) == (f_lo < 0.0)) {
+			lo = r;
+			f_lo = f;
+		} else {
+			hi = r;
+		}
+		double r_new = r;
+		if(df != 0.0) r_new = r - f / df;
+		if(df == 0.0 || r_new <= lo || r_new >= hi) r_new = (lo + hi) / 2.0;
+		if(fabs(r_new - r) < 1.0e-12) return r_new;
+		r = r_new;
+	}
+	return r;
+}
+double Security::moneyWeightedRate(const QDate &date_from, const QDate &date_to) {
+	QDate date1 = date_from, date2 = date_to;
+	QDate curdate = QDate::currentDate();
+	if(date2 > curdate) date2 = curdate;
+	if(date1 >= date2) return 0.0;
+	QPair<QDate, QDate> key(date1, date2);
+	if(mwr_cache.contains(key)) return mwr_cache[key];
+	const QVector<SecurityCashFlow> &flows = cashFlows();
+	QVector<double> amounts, years;
+	double v1 = historicalShares(date1) * getQuotation(date1);
+	if(v1 != 0.0) {
+		amounts << -v1;
+		years << 0.0;
+	}
+	int i = std::upper_bound(flows.constBegin(), flows.constEnd(), date1, date_cash_flow_less_than) - flows.constBegin();
+	for(; i < flows.count() && flows[i].date <= date2; i++) {
+		if(flows[i].value == 0.0) continue;
+		amounts << -flows[i].value;
+		years << o_budget->yearsBetweenDates(date1, flows[i].date, false);
+	}
+	double v2 = historicalShares(date2) * getQuotation(date2);
+	if(v2 != 0.0) {
+		amounts << v2;
+		years << o_budget->yearsBetweenDates(date1, date2, false);
+	}
+	double rate = 0.0;
+	if(amounts.count() >= 2) rate = solve_rate(amounts, years);
+	mwr_cache[key] = rate;
+	return rate;
+}
+double Security::timeWeightedRate(const QDate &date_from, const QDate &date_to) {
+	QDate date1 = date_from, date2 = date_to;
+	QDate curdate = QDate::currentDate();
+	if(date2 > curdate) date2 = curdate;
+	if(date1 >= date2) return 0.0;
+	QPair<QDate, QDate> key(date1, date2);
+	if(twr_cache.contains(key)) return twr_cache[key];
+	const QVector<SecurityCashFlow> &flows = cashFlows();
+	int i = std::upper_bound(flows.constBegin(), flows.constEnd(), date1, date_cash_flow_less_than) - flows.constBegin();
+	double v_start = historicalShares(date1) * getQuotation(date1);
+	double growth = 1.0;
+	while(i < flows.count() && flows[i].date <= date2) {
+		const QDate &date = flows[i].date;
+		double shares_before = (i == 0 ? d_initial_shares : v_cash_flow_shares[i - 1]);
+		double quote = getQuotation(date);
+		double v_end = shares_before * quote;
+		//dividends paid out are part of the return of the sub-period that ends with them
+		for(; i < flows.count() && flows[i].date == date; i++) {
+			if(flows[i].shares == 0.0 && flows[i].value < 0.0) v_end -= flows[i].value;
+		}
+		if(v_start > 0.0) growth *= v_end / v_start;
+		v_start = v_cash_flow_shares[i - 1] * quote;
+	}
+	if(v_start > 0.0) growth *= historicalShares(date2) * getQuotation(date2) / v_start;
+	double rate = -1.0;
+	if(growth > 0.0) rate = pow(growth, 1 / o_budget->yearsBetweenDates(date1, date2, false)) - 1.0;
+	twr_cache[key] = rate;
+	return rate;
+}
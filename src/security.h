@@ -24,7 +24,9 @@
 #include <qstring.h>
 #include <qdatetime.h>
 #include <qmap.h>
+#include <QPair>
 #include <QList>
+#include <QVector>
 
 #include "transaction.h"
 #include "eqonomizelist.h"
@@ -85,6 +87,20 @@ template<class type> class TradedSharesList : public EqonomizeList<type> {
 		}
 };
 
+struct SecurityCashFlow {
+	QDate date;
+	//change in number of shares
+	double shares;
+	//money invested (positive) or received from sales and dividends (negative), in the security currency
+	double value;
+};
+
+struct SecurityLedgerEntry {
+	QDate date;
+	//state after all changes at date; cost and basis (average cost of current shares) are in the security currency, default_cost and default_realized are converted to the default currency at the date of each change
+	double shares, cost, default_cost, basis, realized, default_realized;
+};
+
 class Security {
 
 	protected:
@@ -105,7 +121,25 @@ class Security {
 		QString s_name;
 		QString s_description;
 
+		mutable QDate d_eq_cache_from, d_eq_cache_to;
+		mutable double d_eq_cache_from_value, d_eq_cache_to_value;
+
+		bool b_cash_flows_valid;
+		QVector<SecurityCashFlow> v_cash_flows;
+		QVector<double> v_cash_flow_shares;
+		QMap<QPair<QDate, QDate>, double> mwr_cache, twr_cache;
+
+		bool b_ledger_valid, b_ledger_foreign;
+		Currency *o_ledger_currency, *o_ledger_default_currency;
+		SecurityLedgerEntry e_ledger_initial;
+		QVector<SecurityLedgerEntry> v_ledger;
+
 		void init();
+		void quotationsModified();
+		double historicalShares(const QDate &date);
+		double cachedShares(const QDate &date);
+		double scheduledCost(const QDate &date, Currency *cur);
+		double scannedCost(const QDate &date, Currency *cur);
 
 	public:
 
@@ -147,6 +181,8 @@ class Security {
 		void removeQuotation(const QDate &date, bool auto_added = false);
 		void clearQuotations();
 		double getQuotation(const QDate &date, QDate *actual_date = NULL) const;
+		//dates must be sorted in ascending order
+		void getQuotations(const QVector<QDate> &dates, QVector<double> &values) const;
 		AssetsAccount *account() const;
 		Currency *currency() const;
 		int decimals() const;
@@ -165,10 +201,24 @@ class Security {
 		double profit(Currency *cur = NULL);
 		double profit(const QDate &date, bool estimate = false, bool no_scheduled_shares = false, Currency *cur = NULL);
 		double profit(const QDate &date1, const QDate &date2, bool estimate = false, bool no_scheduled_shares = false, Currency *cur = NULL);
+		//profit from sales (using average cost) and dividends, and change in value of current shares, excluding scheduled transactions
+		double realizedProfit(const QDate &date, Currency *cur = NULL);
+		double unrealizedProfit(const QDate &date, Currency *cur = NULL);
+		//cost, shares and average cost after each date with buys, sells, trades and dividends
+		const QVector<SecurityLedgerEntry> &costLedger();
+		const SecurityLedgerEntry &ledgerEntry(const QDate &date);
 		double yearlyRate();
 		double yearlyRate(const QDate &date);
 		double yearlyRate(const QDate &date_from, const QDate &date_to);
 		double expectedQuotation(const QDate &date);
+		//buys, sells, trades, dividends and reinvested dividends (not scheduled transactions) sorted by date; cached until transactionsModified() is called
+		const QVector<SecurityCashFlow> &cashFlows();
+		//annual money-weighted (internal rate of return) and time-weighted return; dates after the current date are not supported
+		double moneyWeightedRate(const QDate &date_from, const QDate &date_to);
+		double timeWeightedRate(const QDate &date_from, const QDate &date_to);
+		void transactionsModified();
+		//dates must be sorted in ascending order
+		void expectedQuotations(const QVector<QDate> &dates, QVector<double> &values);
 
 		QMap<QDate, double> quotations;
 		QMap<QDate, bool> quotations_auto;
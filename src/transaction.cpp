@@ -1489,7 +1489,10 @@ Transactions *ScheduledTransaction::transaction() const {
 	return o_trans;
 }
 void ScheduledTransaction::setTransaction(Transactions *trans, bool delete_old) {
-	if(o_trans && delete_old) delete o_trans;
+	if(o_trans && delete_old) {
+		o_budget->scheduledTransactionTransactionRemoved(this);
+		delete o_trans;
+	}
 	o_trans = trans;
 	if(o_rec && o_trans) {
 		o_trans->setDate(o_rec->startDate());
@@ -39,7 +39,6 @@
 #include <QAction>
 #include <QDateEdit>
 #include <QCompleter>
-#include <QStandardItemModel>
 #include <QStringList>
 #include <QKeyEvent>
 #include <QMessageBox>
@@ -51,6 +50,7 @@
 #include <QInputDialog>
 
 #include "budget.h"
+#include "completionmodel.h"
 #include "accountcombobox.h"
 #include "editaccountdialogs.h"
 #include "eqonomizevalueedit.h"
@@ -460,7 +460,11 @@ TransactionEditWidget::TransactionEditWidget(bool auto_edit, bool extra_paramete
 			editLayout->addWidget(new QLabel(tr("Description:", "Transaction description property (transaction title/generic article name)"), this), TEROWCOL(i, 0));			
 			descriptionEdit = new QLineEdit(this);
 			descriptionEdit->setCompleter(new QCompleter(this));
-			descriptionEdit->completer()->setModel(new QStandardItemModel(this));
+			CompletionModel *descriptionModel = new CompletionModel(budget, this);
+			if(transtype == TRANSACTION_TYPE_EXPENSE) descriptionModel->addSource(COMPLETION_SOURCE_EXPENSES, COMPLETION_FIELD_DESCRIPTION, false);
+			else if(transtype == TRANSACTION_TYPE_INCOME) descriptionModel->addSource(COMPLETION_SOURCE_INCOMES, COMPLETION_FIELD_DESCRIPTION);
+			else if(transtype == TRANSACTION_TYPE_TRANSFER) descriptionModel->addSource(COMPLETION_SOURCE_TRANSFERS, COMPLETION_FIELD_DESCRIPTION);
+			descriptionEdit->completer()->setModel(descriptionModel);
 			descriptionEdit->completer()->setModelSorting(QCompleter::CaseInsensitivelySortedModel);
 			descriptionEdit->setToolTip(tr("Transaction title/generic article name"));
 			editLayout->addWidget(descriptionEdit, TEROWCOL(i, 1));
@@ -692,7 +696,10 @@ TransactionEditWidget::TransactionEditWidget(bool auto_edit, bool extra_paramete
 	}
 	if(payeeEdit) {
 		payeeEdit->setCompleter(new QCompleter(this));
-		payeeEdit->completer()->setModel(new QStandardItemModel(this));
+		CompletionModel *payeeModel = new CompletionModel(budget, this);
+		if(transtype == TRANSACTION_TYPE_EXPENSE) payeeModel->addSource(COMPLETION_SOURCE_EXPENSES, COMPLETION_FIELD_PAYEE, false);
+		else if(transtype == TRANSACTION_TYPE_INCOME) payeeModel->addSource(COMPLETION_SOURCE_INCOMES, COMPLETION_FIELD_PAYEE);
+		payeeEdit->completer()->setModel(payeeModel);
 		payeeEdit->completer()->setModelSorting(QCompleter::CaseInsensitivelySortedModel);
 		payeeEdit->completer()->setCaseSensitivity(Qt::CaseInsensitive);
 	}
@@ -1242,13 +1249,15 @@ void TransactionEditWidget::payeeChanged(const QString&) {
 }
 void TransactionEditWidget::setDefaultValue() {
 	if(descriptionEdit && description_changed && !descriptionEdit->text().isEmpty() && valueEdit && valueEdit->value() == 0.0) {
-		Transaction *trans = NULL;
-		if(default_values.contains(descriptionEdit->text().toLower())) trans = default_values[descriptionEdit->text().toLower()];
+		int source = completion_source(transtype);
+		if(source < 0) return;
+		Account *account = NULL;
+		Transaction *trans = budget->completionIndex().predictTransaction(source, COMPLETION_FIELD_DESCRIPTION, descriptionEdit->text(), &account);
 		if(trans) {
 			if(trans->parentSplit() && trans->parentSplit()->type() == SPLIT_TRANSACTION_TYPE_MULTIPLE_ACCOUNTS) valueEdit->setValue(trans->parentSplit()->value());
 			else valueEdit->setValue(trans->value());
-			if(toCombo) toCombo->setCurrentAccount(trans->toAccount());
-			if(fromCombo) fromCombo->setCurrentAccount(trans->fromAccount());
+			if(toCombo) toCombo->setCurrentAccount(transtype == TRANSACTION_TYPE_INCOME ? account : trans->toAccount());
+			if(fromCombo) fromCombo->setCurrentAccount(transtype == TRANSACTION_TYPE_INCOME ? trans->fromAccount() : account);
 			if(quantityEdit) {
 				if(trans->quantity() <= 0.0) quantityEdit->setValue(1.0);
 				else quantityEdit->setValue(trans->quantity());
@@ -1260,13 +1269,15 @@ void TransactionEditWidget::setDefaultValue() {
 }
 void TransactionEditWidget::setDefaultValueFromPayee() {
 	if(payeeEdit && payee_changed && !payeeEdit->text().isEmpty() && valueEdit && valueEdit->value() == 0.0 && descriptionEdit && descriptionEdit->text().isEmpty()) {
-		Transaction *trans = NULL;
-		if(default_payee_values.contains(payeeEdit->text().toLower())) trans = default_payee_values[payeeEdit->text().toLower()];
+		int source = completion_source(transtype);
+		if(source < 0) return;
+		Account *account = NULL;
+		Transaction *trans = budget->completionIndex().predictTransaction(source, COMPLETION_FIELD_PAYEE, payeeEdit->text(), &account);
 		if(trans) {
 			if(trans->parentSplit() && trans->parentSplit()->type() == SPLIT_TRANSACTION_TYPE_MULTIPLE_ACCOUNTS) valueEdit->setValue(trans->parentSplit()->value());
 			else valueEdit->setValue(trans->value());
-			if(toCombo) toCombo->setCurrentAccount(trans->toAccount());
-			if(fromCombo) fromCombo->setCurrentAccount(trans->fromAccount());
+			if(toCombo) toCombo->setCurrentAccount(transtype == TRANSACTION_TYPE_INCOME ? account : trans->toAccount());
+			if(fromCombo) fromCombo->setCurrentAccount(transtype == TRANSACTION_TYPE_INCOME ? trans->fromAccount() : account);
 			if(quantityEdit) {
 				if(trans->quantity() <= 0.0) quantityEdit->setValue(1.0);
 				else quantityEdit->setValue(trans->quantity());
@@ -1280,14 +1291,15 @@ void TransactionEditWidget::setDefaultValueFromPayee() {
 }
 void TransactionEditWidget::setDefaultValueFromCategory() {
 	if(((transtype == TRANSACTION_TYPE_INCOME && fromCombo) || (transtype == TRANSACTION_TYPE_EXPENSE && toCombo)) && valueEdit && valueEdit->value() == 0.0 && descriptionEdit && descriptionEdit->text().isEmpty()) {
+		Account *account = NULL;
 		Transaction *trans = NULL;
-		if(transtype == TRANSACTION_TYPE_INCOME && default_category_values.contains(fromAccount())) trans = default_category_values[fromAccount()];
-		else if(transtype == TRANSACTION_TYPE_EXPENSE && default_category_values.contains(toAccount())) trans = default_category_values[toAccount()];
+		if(transtype == TRANSACTION_TYPE_INCOME) trans = budget->completionIndex().predictTransaction(COMPLETION_SOURCE_INCOMES, fromAccount(), &account);
+		else trans = budget->completionIndex().predictTransaction(COMPLETION_SOURCE_EXPENSES, toAccount(), &account);
 		if(trans) {
 			if(trans->parentSplit() && trans->parentSplit()->type() == SPLIT_TRANSACTION_TYPE_MULTIPLE_ACCOUNTS) valueEdit->setValue(trans->parentSplit()->value());
 			else valueEdit->setValue(trans->value());
-			if(toCombo && transtype == TRANSACTION_TYPE_INCOME) toCombo->setCurrentAccount(trans->toAccount());
-			if(fromCombo && transtype == TRANSACTION_TYPE_EXPENSE) fromCombo->setCurrentAccount(trans->fromAccount());
+			if(toCombo && transtype == TRANSACTION_TYPE_INCOME) toCombo->setCurrentAccount(account);
+			if(fromCombo && transtype == TRANSACTION_TYPE_EXPENSE) fromCombo->setCurrentAccount(account);
 			if(quantityEdit) {
 				if(trans->quantity() <= 0.0) quantityEdit->setValue(1.0);
 				else quantityEdit->setValue(trans->quantity());
@@ -1321,50 +1333,9 @@ void TransactionEditWidget::updateAccounts(Account *exclude_account, Currency *f
 	updateFromAccounts(exclude_account, force_currency, set_default);
 	if(fromCombo) fromCombo->setCurrentAccount(afrom);
 }
-void TransactionEditWidget::transactionAdded(Transaction *trans) {
-	if(descriptionEdit && trans->type() == transtype && (transtype != TRANSACTION_TYPE_INCOME || !((Income*) trans)->security()) && trans->subtype() != TRANSACTION_SUBTYPE_DEBT_FEE && trans->subtype() != TRANSACTION_SUBTYPE_DEBT_INTEREST) {
-		if(!trans->description().isEmpty()) {
-			if(!default_values.contains(trans->description().toLower())) {
-				QList<QStandardItem*> row;
-				row << new QStandardItem(trans->description());
-				row << new QStandardItem(trans->description().toLower());
-				((QStandardItemModel*) descriptionEdit->completer()->model())->appendRow(row);
-				((QStandardItemModel*) descriptionEdit->completer()->model())->sort(1);
-			}
-			default_values[trans->description().toLower()] = trans;
-		}
-		if(payeeEdit && transtype == TRANSACTION_TYPE_EXPENSE && !((Expense*) trans)->payee().isEmpty()) {
-			if(!default_payee_values.contains(((Expense*) trans)->payee().toLower())) {
-				QList<QStandardItem*> row;
-				row << new QStandardItem(((Expense*) trans)->payee());
-				row << new QStandardItem(((Expense*) trans)->payee().toLower());
-				((QStandardItemModel*) payeeEdit->completer()->model())->appendRow(row);
-				((QStandardItemModel*) payeeEdit->completer()->model())->sort(1);
-			}
-			default_payee_values[((Expense*) trans)->payee().toLower()] = trans;
-		} else if(payeeEdit && transtype == TRANSACTION_TYPE_INCOME && !((Income*) trans)->security() && !((Income*) trans)->payer().isEmpty()) {
-			if(!default_payee_values.contains(((Income*) trans)->payer().toLower())) {
-				QList<QStandardItem*> row;
-				row << new QStandardItem(((Income*) trans)->payer());
-				row << new QStandardItem(((Income*) trans)->payer().toLower());
-				((QStandardItemModel*) payeeEdit->completer()->model())->appendRow(row);
-				((QStandardItemModel*) payeeEdit->completer()->model())->sort(1);
-			}
-			default_payee_values[((Income*) trans)->payer().toLower()] = trans;
-		}
-		if(transtype == TRANSACTION_TYPE_INCOME && fromCombo) {
-			default_category_values[trans->fromAccount()] = trans;
-		} else if(transtype == TRANSACTION_TYPE_EXPENSE && toCombo) {
-			default_category_values[trans->toAccount()] = trans;
-		}
-	}
-}
 void TransactionEditWidget::tagsModified() {
 	if(tagButton) tagButton->updateTags();
 }
-void TransactionEditWidget::transactionModified(Transaction *trans) {
-	transactionAdded(trans);
-}
 bool TransactionEditWidget::checkAccounts() {
 	switch(transtype) {
 		case TRANSACTION_TYPE_TRANSFER: {
@@ -1670,177 +1641,6 @@ Transaction *TransactionEditWidget::createTransaction() {
 	if(tagButton) tagButton->modifyTransaction(trans);
 	return trans;
 }
-void TransactionEditWidget::transactionRemoved(Transaction *trans) {
-	if(descriptionEdit && trans->type() == transtype && !trans->description().isEmpty() && default_values.contains(trans->description().toLower()) && default_values[trans->description().toLower()] == trans) {
-		QString lower_description = trans->description().toLower();
-		default_values[trans->description().toLower()] = NULL;
-		switch(transtype) {
-			case TRANSACTION_TYPE_EXPENSE: {
-				for(TransactionList<Expense*>::const_iterator it = budget->expenses.constEnd(); it != budget->expenses.constBegin();) {
-					--it;
-					Expense *expense = *it;
-					if(expense != trans && expense->description().toLower() == lower_description && expense->subtype() != TRANSACTION_SUBTYPE_DEBT_FEE && expense->subtype() != TRANSACTION_SUBTYPE_DEBT_INTEREST) {
-						default_values[lower_description] = expense;
-						break;
-					}
-				}
-				break;
-			}
-			case TRANSACTION_TYPE_INCOME: {
-				for(TransactionList<Income*>::const_iterator it = budget->incomes.constEnd(); it != budget->incomes.constBegin();) {
-					--it;
-					Income *income = *it;
-					if(income != trans && !income->security() && income->description().toLower() == lower_description) {
-						default_values[lower_description] = income;
-						break;
-					}
-				}
-				break;
-			}
-			case TRANSACTION_TYPE_TRANSFER: {
-				for(TransactionList<Transfer*>::const_iterator it = budget->transfers.constEnd(); it != budget->transfers.constBegin();) {
-					--it;
-					Transfer *transfer = *it;
-					if(transfer != trans && transfer->description().toLower() == lower_description) {
-						default_values[lower_description] = transfer;
-						break;
-					}
-				}
-				break;
-			}
-			default: {}
-		}
-	}
-	if(payeeEdit && transtype == TRANSACTION_TYPE_INCOME && trans->type() == transtype && !((Income*) trans)->payer().isEmpty() && default_payee_values.contains(((Income*) trans)->payer().toLower()) && default_payee_values[((Income*) trans)->payer().toLower()] == trans) {
-		default_payee_values[((Income*) trans)->payer().toLower()] = NULL;
-		QString lower_payee = ((Income*) trans)->payer().toLower();
-		for(TransactionList<Income*>::const_iterator it = budget->incomes.constEnd(); it != budget->incomes.constBegin();) {
-			--it;
-			Income *income = *it;
-			if(income != trans && !income->security()  && income->payer().toLower() == lower_payee) {
-				default_payee_values[lower_payee] = income;
-				break;
-			}
-		}
-	}
-	if(payeeEdit && transtype == TRANSACTION_TYPE_EXPENSE && trans->type() == transtype && !((Expense*) trans)->payee().isEmpty() && default_payee_values.contains(((Expense*) trans)->payee().toLower()) && default_payee_values[((Expense*) trans)->payee().toLower()] == trans) {
-		default_payee_values[((Expense*) trans)->payee().toLower()] = NULL;
-		QString lower_payee = ((Expense*) trans)->payee().toLower();
-		for(TransactionList<Expense*>::const_iterator it = budget->expenses.constEnd(); it != budget->expenses.constBegin();) {
-			--it;
-			Expense *expense = *it;
-			if(expense != trans && expense->payee().toLower() == lower_payee && expense->subtype() != TRANSACTION_SUBTYPE_DEBT_FEE && expense->subtype() != TRANSACTION_SUBTYPE_DEBT_INTEREST) {
-				default_payee_values[lower_payee] = expense;
-				break;
-			}
-		}
-	}
-	if(transtype == TRANSACTION_TYPE_INCOME && fromCombo && trans->type() == transtype && default_category_values.contains(trans->fromAccount()) && default_category_values[trans->fromAccount()] == trans) {
-		bool category_found = false;
-		Account *cat = trans->fromAccount();
-		for(TransactionList<Income*>::const_iterator it = budget->incomes.constEnd(); it != budget->incomes.constBegin();) {
-			--it;
-			Income *income = *it;
-			if(income != trans && !income->security()  && income->fromAccount() == cat) {
-				default_category_values[cat] = income;
-				category_found = true;
-				break;
-			}
-		}
-		if(!category_found) default_category_values.remove(cat);
-	} else if(transtype == TRANSACTION_TYPE_EXPENSE && toCombo && trans->type() == transtype && default_category_values.contains(trans->toAccount()) && default_category_values[trans->toAccount()] == trans) {
-		bool category_found = false;
-		Account *cat = trans->toAccount();
-		for(TransactionList<Expense*>::const_iterator it = budget->expenses.constEnd(); it != budget->expenses.constBegin();) {
-			--it;
-			Expense *expense = *it;
-			if(expense != trans && expense->toAccount() == cat && expense->subtype() != TRANSACTION_SUBTYPE_DEBT_FEE && expense->subtype() != TRANSACTION_SUBTYPE_DEBT_INTEREST) {
-				default_category_values[cat] = expense;
-				category_found = true;
-				break;
-			}
-		}
-		if(!category_found) default_category_values.remove(cat);
-	}
-}
-void TransactionEditWidget::transactionsReset() {
-	if(descriptionEdit) ((QStandardItemModel*) descriptionEdit->completer()->model())->clear();
-	if(payeeEdit) ((QStandardItemModel*) payeeEdit->completer()->model())->clear();
-	default_values.clear();
-	default_payee_values.clear();
-	default_category_values.clear();
-	switch(transtype) {
-		case TRANSACTION_TYPE_EXPENSE: {
-			for(TransactionList<Expense*>::const_iterator it = budget->expenses.constEnd(); it != budget->expenses.constBegin();) {
-				--it;
-				Expense *expense = *it;
-				if(expense->subtype() != TRANSACTION_SUBTYPE_DEBT_FEE && expense->subtype() != TRANSACTION_SUBTYPE_DEBT_INTEREST) {
-					if(descriptionEdit && !expense->description().isEmpty() && !default_values.contains(expense->description().toLower())) {
-						QList<QStandardItem*> row;
-						row << new QStandardItem(expense->description());
-						row << new QStandardItem(expense->description().toLower());
-						((QStandardItemModel*) descriptionEdit->completer()->model())->appendRow(row);
-						default_values[expense->description().toLower()] = expense;
-					}
-					if(payeeEdit && !expense->payee().isEmpty() && !default_payee_values.contains(expense->payee().toLower())) {
-						QList<QStandardItem*> row;
-						row << new QStandardItem(expense->payee());
-						row << new QStandardItem(expense->payee().toLower());
-						((QStandardItemModel*) payeeEdit->completer()->model())->appendRow(row);
-						default_payee_values[expense->payee().toLower()] = expense;
-					}
-					if(toCombo && !default_category_values.contains(expense->category())) {
-						default_category_values[expense->category()] = expense;
-					}
-				}
-			}
-			break;
-		}
-		case TRANSACTION_TYPE_INCOME: {
-			for(TransactionList<Income*>::const_iterator it = budget->incomes.constEnd(); it != budget->incomes.constBegin();) {
-				--it;
-				Income *income = *it;
-				if(!income->security()) {
-					if(descriptionEdit && !income->description().isEmpty() && !default_values.contains(income->description().toLower())) {
-						QList<QStandardItem*> row;
-						row << new QStandardItem(income->description());
-						row << new QStandardItem(income->description().toLower());
-						((QStandardItemModel*) descriptionEdit->completer()->model())->appendRow(row);
-						default_values[income->description().toLower()] = income;
-					}
-					if(payeeEdit && !income->payer().isEmpty() && !default_payee_values.contains(income->payer().toLower())) {
-						QList<QStandardItem*> row;
-						row << new QStandardItem(income->payer());
-						row << new QStandardItem(income->payer().toLower());
-						((QStandardItemModel*) payeeEdit->completer()->model())->appendRow(row);
-						default_payee_values[income->payer().toLower()] = income;
-					}
-					if(fromCombo && !default_category_values.contains(income->category())) {
-						default_category_values[income->category()] = income;
-					}
-				}
-			}
-			break;
-		}
-		case TRANSACTION_TYPE_TRANSFER: {
-			for(TransactionList<Transfer*>::const_iterator it = budget->transfers.constEnd(); it != budget->transfers.constBegin();) {
-				--it;
-				Transfer *transfer = *it;
-				if(descriptionEdit && !transfer->description().isEmpty() && !default_values.contains(transfer->description().toLower())) {
-					QList<QStandardItem*> row;
-					row << new QStandardItem(transfer->description());
-					row << new QStandardItem(transfer->description().toLower());
-					((QStandardItemModel*) descriptionEdit->completer()->model())->appendRow(row);
-					default_values[transfer->description().toLower()] = transfer;
-				}
-			}
-			break;
-		}
-		default: {}
-	}
-	if(descriptionEdit) ((QStandardItemModel*) descriptionEdit->completer()->model())->sort(1);
-	if(payeeEdit) ((QStandardItemModel*) payeeEdit->completer()->model())->sort(1);
-}
 void TransactionEditWidget::newTag() {
 	QString new_tag = tagButton->createTag();
 	if(!new_tag.isEmpty()) emit tagAdded(new_tag);
@@ -2098,7 +1898,6 @@ TransactionEditDialog::TransactionEditDialog(bool extra_parameters, int transact
 	}
 	editWidget = new TransactionEditWidget(false, extra_parameters, transaction_type, split_currency, transfer_to, security, security_value_type, select_security, budg, this, allow_account_creation, multiaccount, withloan);
 	box1->addWidget(editWidget);
-	editWidget->transactionsReset();
 	
 	QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
 	buttonBox->button(QDialogButtonBox::Ok)->setShortcut(Qt::CTRL | Qt::Key_Return);
@@ -2136,6 +1935,16 @@ MultipleTransactionsEditDialog::MultipleTransactionsEditDialog(bool extra_parame
 	editLayout->addWidget(descriptionButton, 0, 0);
 	descriptionEdit = new QLineEdit(this);
 	descriptionEdit->setEnabled(false);
+	if(transtype == TRANSACTION_TYPE_EXPENSE || transtype == TRANSACTION_TYPE_INCOME || transtype == TRANSACTION_TYPE_TRANSFER) {
+		descriptionEdit->setCompleter(new QCompleter(this));
+		CompletionModel *descriptionModel = new CompletionModel(budget, this);
+		if(transtype == TRANSACTION_TYPE_EXPENSE) descriptionModel->addSource(COMPLETION_SOURCE_EXPENSES, COMPLETION_FIELD_DESCRIPTION, false);
+		else if(transtype == TRANSACTION_TYPE_INCOME) descriptionModel->addSource(COMPLETION_SOURCE_INCOMES, COMPLETION_FIELD_DESCRIPTION);
+		else descriptionModel->addSource(COMPLETION_SOURCE_TRANSFERS, COMPLETION_FIELD_DESCRIPTION);
+		descriptionEdit->completer()->setModel(descriptionModel);
+		descriptionEdit->completer()->setModelSorting(QCompleter::CaseInsensitivelySortedModel);
+		descriptionEdit->completer()->setCaseSensitivity(Qt::CaseInsensitive);
+	}
 	editLayout->addWidget(descriptionEdit, 0, 1);
 
 	valueButton = NULL;
@@ -2181,6 +1990,13 @@ MultipleTransactionsEditDialog::MultipleTransactionsEditDialog(bool extra_parame
 		editLayout->addWidget(payeeButton, 4, 0);
 		payeeEdit = new QLineEdit(this);
 		payeeEdit->setEnabled(false);
+		payeeEdit->setCompleter(new QCompleter(this));
+		CompletionModel *payeeModel = new CompletionModel(budget, this);
+		if(transtype == TRANSACTION_TYPE_EXPENSE) payeeModel->addSource(COMPLETION_SOURCE_EXPENSES, COMPLETION_FIELD_PAYEE, false);
+		else payeeModel->addSource(COMPLETION_SOURCE_INCOMES, COMPLETION_FIELD_PAYEE);
+		payeeEdit->completer()->setModel(payeeModel);
+		payeeEdit->completer()->setModelSorting(QCompleter::CaseInsensitivelySortedModel);
+		payeeEdit->completer()->setCaseSensitivity(Qt::CaseInsensitive);
 		editLayout->addWidget(payeeEdit, 4, 1);
 		connect(payeeButton, SIGNAL(toggled(bool)), payeeEdit, SLOT(setEnabled(bool)));
 	}
@@ -75,7 +75,6 @@ class TransactionEditWidget : public QWidget {
 		void updateFromAccounts(Account *exclude_account = NULL, Currency *force_currency = NULL, bool set_default = false);
 		void updateToAccounts(Account *exclude_account = NULL, Currency *force_currency = NULL, bool set_default = false);
 		void updateAccounts(Account *exclude_account = NULL, Currency *force_currency = NULL, bool set_default = false);
-		void transactionsReset();
 		void setDefaultFromAccount();
 		void setDefaultToAccount();
 		void setDefaultAccounts();
@@ -85,9 +84,6 @@ class TransactionEditWidget : public QWidget {
 		void focusFirst();
 		bool firstHasFocus() const;
 		QHBoxLayout *bottomLayout();
-		void transactionRemoved(Transaction *trans);
-		void transactionAdded(Transaction *trans);
-		void transactionModified(Transaction *trans);
 		void tagsModified();
 		bool modifyTransaction(Transaction *trans);
 		Transaction *createTransaction();
@@ -112,9 +108,6 @@ class TransactionEditWidget : public QWidget {
 
 	protected:
 
-		QHash<QString, Transaction*> default_values;
-		QHash<QString, Transaction*> default_payee_values;
-		QHash<Account*, Transaction*> default_category_values;
 		int transtype;
 		bool description_changed, payee_changed;
 		Budget *budget;
@@ -0,0 +1,275 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Hanna Knutsson                                  *
+ *   hanna.knutsson@protonmail.com                                         *
+ *                                                                         *
+ *   This file is part of Eqonomize!.                                      *
+ *                                                                         *
+ *   Eqonomize! is free software: you can redistribute it and/or modify    *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Eqonomize! is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Eqonomize!. If not, see <http://www.gnu.org/licenses/>.    *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "transactionfilter.h"
+
+#include "account.h"
+#include "transaction.h"
+#include "transactiontextindex.h"
+
+//str must already be case folded
+bool contains_folded(const QString &text, const QString &str) {
+	for(int i = 0; i + str.length() <= text.length(); i++) {
+		int i2 = 0;
+		while(i2 < str.length() && text[i + i2].toCaseFolded() == str[i2]) i2++;
+		if(i2 == str.length()) return true;
+	}
+	return false;
+}
+bool equals_folded(const QString &text, const QString &str) {
+	if(text.length() != str.length()) return false;
+	for(int i = 0; i < str.length(); i++) {
+		if(text[i].toCaseFolded() != str[i]) return false;
+	}
+	return true;
+}
+
+TransactionFilter::TransactionFilter() : transtype(-1), b_extra(false), b_exclude(false), b_exact(false), b_exclude_subs(false), from_account(NULL), to_account(NULL), b_match_tags(false), b_description_is_tag(false), b_min(false), b_max(false), min_value(0.0), max_value(0.0), text_index(NULL), text_index_revision(0), b_text_candidates(false) {}
+bool TransactionFilter::filterTransaction(Transactions *transs, bool checkdate) const {
+	Transaction *trans = NULL;
+	MultiAccountTransaction *split = NULL;
+	switch(transs->generaltype()) {
+		case GENERAL_TRANSACTION_TYPE_SINGLE: {
+			trans = (Transaction*) transs; 
+			if(trans->parentSplit() && trans->parentSplit()->type() == SPLIT_TRANSACTION_TYPE_MULTIPLE_ACCOUNTS) return true;
+			if(trans->subtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND && trans->value() == 0.0) return true;
+			break;
+		}
+		case GENERAL_TRANSACTION_TYPE_SPLIT: {
+			if(((SplitTransaction*) transs)->type() != SPLIT_TRANSACTION_TYPE_MULTIPLE_ACCOUNTS) return true;
+			split = (MultiAccountTransaction*) transs; 
+			break;
+		}
+		case GENERAL_TRANSACTION_TYPE_SCHEDULE: {return filterTransaction(((ScheduledTransaction*) transs)->transaction(), checkdate);}
+	}
+	if(trans) {
+		if(trans->type() == TRANSACTION_TYPE_SECURITY_BUY || trans->type() == TRANSACTION_TYPE_SECURITY_SELL) {
+			if(transtype == TRANSACTION_TYPE_TRANSFER && ((SecurityTransaction*) trans)->account()->type() != ACCOUNT_TYPE_ASSETS) return true;
+			if(transtype == TRANSACTION_TYPE_EXPENSE && ((SecurityTransaction*) trans)->account()->type() != ACCOUNT_TYPE_EXPENSES) return true;
+			if(transtype == TRANSACTION_TYPE_INCOME && ((SecurityTransaction*) trans)->account()->type() != ACCOUNT_TYPE_INCOMES) return true;
+		} else if(trans->type() != transtype) {
+			return true;
+		}
+	} else {
+		if(split->transactiontype() != transtype) return true;
+		if(split->count() == 0) return true;
+		trans = split->at(0);
+	}
+	//false if the text index shows that no text field can contain the description
+	bool b_text_match = !b_text_candidates || text_index->revision() != text_index_revision || !text_index->contains(transs) || text_candidates.contains(transs);
+	if(!b_exclude) {
+		Account *account = to_account;
+		if(account && account != trans->toAccount() && (b_exclude_subs || account != trans->toAccount()->topAccount())) {
+			if(split) {
+				bool b = false;
+				for(int split_i = 1; split_i < split->count(); split_i++) {
+					if(account == split->at(split_i)->toAccount() || (!b_exclude_subs && account == split->at(split_i)->toAccount()->topAccount())) {
+						b = true;
+						break;
+					}
+				}
+				if(!b) return true;
+			} else {
+				return true;
+			}
+		}
+		account = from_account;
+		if(account && account != trans->fromAccount() && (b_exclude_subs || account != trans->fromAccount()->topAccount())) {
+			if(split) {
+				bool b = false;
+				for(int split_i = 1; split_i < split->count(); split_i++) {
+					if(account == split->at(split_i)->fromAccount() || (!b_exclude_subs && account == split->at(split_i)->fromAccount()->topAccount())) {
+						b = true;
+						break;
+					}
+				}
+				if(!b) return true;
+			} else {
+				return true;
+			}
+		}
+		if(!tag.isEmpty() && !transs->hasTag(tag, true)) return true;
+		if(!description.isEmpty() && !b_text_match) return true;
+		if(b_exact && !description.isEmpty()) {
+			bool b = !equals_folded(transs->description(), description_folded) && (!b_match_tags || !transs->hasTag(description, true, true));
+			if(b_extra && b && transtype == TRANSACTION_TYPE_EXPENSE) {
+				b = !equals_folded(((Expense*) trans)->payee(), description_folded);
+				if(b && split) {
+					for(int split_i = 1; split_i < split->count(); split_i++) {
+						if(equals_folded(((Expense*) split->at(split_i))->payee(), description_folded)) {
+							b = false;
+							break;
+						}
+					}
+				}
+			}
+			if(b_extra && b && transtype == TRANSACTION_TYPE_INCOME) {
+				b = !equals_folded(((Income*) trans)->payer(), description_folded);
+				if(b && split) {
+					for(int split_i = 1; split_i < split->count(); split_i++) {
+						if(equals_folded(((Income*) split->at(split_i))->payer(), description_folded)) {
+							b = false;
+							break;
+						}
+					}
+					if(!b) return true;
+				} else {
+					return true;
+				}
+			}
+			if(b) return true;
+		} else if(!description.isEmpty()) {
+			bool b = !contains_folded(transs->description(), description_folded) && !contains_folded(transs->comment(), description_folded) && (!b_match_tags || !transs->hasTag(description, true, true));
+			if(b_extra && b && transtype == TRANSACTION_TYPE_EXPENSE) {
+				b = !contains_folded(((Expense*) trans)->payee(), description_folded);
+				if(b && split) {
+					for(int split_i = 1; split_i < split->count(); split_i++) {
+						if(contains_folded(((Expense*) split->at(split_i))->payee(), description_folded)) {
+							b = false;
+							break;
+						}
+					}
+				}
+			}
+			if(b_extra && b && transtype == TRANSACTION_TYPE_INCOME) {
+				b = !contains_folded(((Income*) trans)->payer(), description_folded);
+				if(b && split) {
+					for(int split_i = 1; split_i < split->count(); split_i++) {
+						if(contains_folded(((Income*) split->at(split_i))->payer(), description_folded)) {
+							b = false;
+							break;
+						}
+					}
+				}
+			}
+			if(b) return true;
+		}
+	} else {
+		Account *account = to_account;
+		if(account && (account == trans->toAccount() || (!b_exclude_subs && account == trans->toAccount()->topAccount()))) {
+			if(!split || transtype != TRANSACTION_TYPE_INCOME || !split->account()) return true;
+		}
+		account = from_account;
+		if(account && (account == trans->fromAccount() || (!b_exclude_subs && account == trans->fromAccount()->topAccount()))) {
+			if(!split || transtype != TRANSACTION_TYPE_EXPENSE || !split->account()) return true;
+		}
+		if(!tag.isEmpty() && transs->hasTag(tag, true)) return true;
+		bool b_description = !description.isEmpty() && b_text_match;
+		if(b_exact && b_description) {
+			if((equals_folded(transs->description(), description_folded) || (b_match_tags && transs->hasTag(description, true, true)))) {
+				return true;
+			}
+			if(b_extra && transtype == TRANSACTION_TYPE_EXPENSE && equals_folded(((Expense*) trans)->payee(), description_folded)) {
+				if(split) {
+					bool b = false;
+					for(int split_i = 1; split_i < split->count(); split_i++) {
+						if(!equals_folded(((Expense*) split->at(split_i))->payee(), description_folded)) {
+							b = true;
+							break;
+						}
+					}
+					if(!b) return true;
+				} else {
+					return true;
+				}
+			}
+			if(b_extra && transtype == TRANSACTION_TYPE_INCOME && equals_folded(((Income*) trans)->payer(), description_folded)) {
+				if(split) {
+					bool b = false;
+					for(int split_i = 1; split_i < split->count(); split_i++) {
+						if(!equals_folded(((Income*) split->at(split_i))->payer(), description_folded)) {
+							b = true;
+							break;
+						}
+					}
+					if(!b) return true;
+				} else {
+					return true;
+				}
+			}
+		} else if(b_description) {
+			if(!description.isEmpty() && (contains_folded(transs->description(), description_folded) || (b_match_tags && transs->hasTag(description, true, true)))) {
+				return true;
+			}
+			if(b_extra && transtype == TRANSACTION_TYPE_EXPENSE && contains_folded(((Expense*) trans)->payee(), description_folded)) {
+				if(split) {
+					bool b = false;
+					for(int split_i = 1; split_i < split->count(); split_i++) {
+						if(!contains_folded(((Expense*) split->at(split_i))->payee(), description_folded)) {
+							b = true;
+							break;
+						}
+					}
+					if(!b) return true;
+				} else {
+					return true;
+				}
+				return true;
+			}
+			if(b_extra && transtype == TRANSACTION_TYPE_INCOME  && contains_folded(((Income*) trans)->payer(), description_folded)) {
+				if(split) {
+					bool b = false;
+					for(int split_i = 1; split_i < split->count(); split_i++) {
+						if(!contains_folded(((Income*) split->at(split_i))->payer(), description_folded)) {
+							b = true;
+							break;
+						}
+					}
+					if(!b) return true;
+				} else {
+					return true;
+				}
+			}
+		}
+	}
+	if(b_min && transs->value(true) < min_value) {
+		return true;
+	}
+	if(b_max && transs->value(true) > max_value) {
+		return true;
+	}
+	if(checkdate && !from_date.isNull() && transs->date() < from_date) {
+		return true;
+	}
+	if(checkdate && transs->date() > to_date) {
+		return true;
+	}
+	return false;
+}
+bool TransactionFilter::isNarrowerThan(const TransactionFilter &f) const {
+	if(transtype != f.transtype || b_extra != f.b_extra || b_exclude != f.b_exclude || b_exact != f.b_exact || b_exclude_subs != f.b_exclude_subs || b_match_tags != f.b_match_tags) return false;
+	if(f.from_account && from_account != f.from_account) return false;
+	if(f.to_account && to_account != f.to_account) return false;
+	if(!f.tag.isEmpty() && tag != f.tag) return false;
+	if(!f.description.isEmpty() && description != f.description) {
+		if(b_exclude || b_exact) return false;
+		//a longer search string only matches a subset, except for tags, which must match exactly
+		if(b_description_is_tag || !description.contains(f.description, Qt::CaseInsensitive)) return false;
+	}
+	if(f.b_min && (!b_min || min_value < f.min_value)) return false;
+	if(f.b_max && (!b_max || max_value > f.max_value)) return false;
+	if(!f.from_date.isNull() && (from_date.isNull() || from_date < f.from_date)) return false;
+	if(to_date > f.to_date) return false;
+	return true;
+}
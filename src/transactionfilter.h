@@ -0,0 +1,72 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Hanna Knutsson                                  *
+ *   hanna.knutsson@protonmail.com                                         *
+ *                                                                         *
+ *   This file is part of Eqonomize!.                                      *
+ *                                                                         *
+ *   Eqonomize! is free software: you can redistribute it and/or modify    *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Eqonomize! is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Eqonomize!. If not, see <http://www.gnu.org/licenses/>.    *
+ ***************************************************************************/
+
+#ifndef TRANSACTION_FILTER_H
+#define TRANSACTION_FILTER_H
+
+#include <QDate>
+#include <QSet>
+#include <QString>
+
+class Account;
+class Transactions;
+class TransactionTextIndex;
+
+//filter settings resolved from TransactionFilterWidget, without references to any widgets; the text candidates refer to the text index of the budget, so the filter must be evaluated in the GUI thread
+class TransactionFilter {
+
+	public:
+
+		TransactionFilter();
+
+		//returns true if the transaction should be filtered out (not shown)
+		bool filterTransaction(Transactions *transs, bool checkdate = true) const;
+		//returns true if all transactions accepted by this filter are also accepted by f
+		bool isNarrowerThan(const TransactionFilter &f) const;
+
+		int transtype;
+		bool b_extra;
+		//exclude instead of include matching transactions
+		bool b_exclude;
+		bool b_exact, b_exclude_subs;
+		//NULL matches all accounts
+		Account *from_account, *to_account;
+		//empty matches all tags
+		QString tag;
+		QString description;
+		//case folded description, compared with each text field
+		QString description_folded;
+		//also match description against tags (if no separate tag filter)
+		bool b_match_tags;
+		//the description is equal to an existing tag
+		bool b_description_is_tag;
+		bool b_min, b_max;
+		double min_value, max_value;
+		//null from date if dates should not be limited downwards
+		QDate from_date, to_date;
+		//transactions that might contain the description, valid while the revision of the text index is unchanged
+		const TransactionTextIndex *text_index;
+		int text_index_revision;
+		bool b_text_candidates;
+		QSet<Transactions*> text_candidates;
+
+};
+
+#endif
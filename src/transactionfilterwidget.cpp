@@ -37,13 +37,14 @@
 #include <QDateEdit>
 #include <QLineEdit>
 #include <QCompleter>
-#include <QStandardItemModel>
 #include <QStringList>
 #include <QComboBox>
 #include <QMessageBox>
 
 #include "budget.h"
+#include "completionmodel.h"
 #include "eqonomizevalueedit.h"
+#include "transactionfilter.h"
 #include "transactionfilterwidget.h"
 
 #include <cmath>
@@ -116,7 +117,27 @@ TransactionFilterWidget::TransactionFilterWidget(bool extra_parameters, int tran
 	filterLayout->addWidget(new QLabel(tr("Description:", "Transaction description property (transaction title/generic article name)"), this), 3, 0);
 	descriptionEdit = new QLineEdit(this);
 	descriptionEdit->setCompleter(new QCompleter(this));
-	descriptionEdit->completer()->setModel(new QStandardItemModel(this));
+	CompletionModel *completionModel = new CompletionModel(budget, this);
+	switch(transtype) {
+		case TRANSACTION_TYPE_EXPENSE: {
+			completionModel->addSource(COMPLETION_SOURCE_EXPENSES, COMPLETION_FIELD_DESCRIPTION);
+			if(b_extra) completionModel->addSource(COMPLETION_SOURCE_EXPENSES, COMPLETION_FIELD_PAYEE);
+			completionModel->setIncludeTags(true);
+			break;
+		}
+		case TRANSACTION_TYPE_INCOME: {
+			completionModel->addSource(COMPLETION_SOURCE_INCOMES, COMPLETION_FIELD_DESCRIPTION);
+			if(b_extra) completionModel->addSource(COMPLETION_SOURCE_INCOMES, COMPLETION_FIELD_PAYEE);
+			completionModel->setIncludeTags(true);
+			break;
+		}
+		case TRANSACTION_TYPE_TRANSFER: {
+			completionModel->addSource(COMPLETION_SOURCE_TRANSFERS, COMPLETION_FIELD_DESCRIPTION);
+			break;
+		}
+		default: {}
+	}
+	descriptionEdit->completer()->setModel(completionModel);
 	descriptionEdit->completer()->setModelSorting(QCompleter::CaseInsensitivelySortedModel);
 	descriptionEdit->completer()->setCaseSensitivity(Qt::CaseInsensitive);
 	filterLayout->addWidget(descriptionEdit, 3, 1);
@@ -186,6 +207,9 @@ TransactionFilterWidget::TransactionFilterWidget(bool extra_parameters, int tran
 	connect(maxEdit, SIGNAL(valueChanged(double)), this, SIGNAL(filter()));
 	connect(exactMatchButton, SIGNAL(toggled(bool)), this, SIGNAL(filter()));
 	if(excludeSubsButton) connect(excludeSubsButton, SIGNAL(toggled(bool)), this, SIGNAL(filter()));
+	//connected before any receiver outside the widget, so that the filter is up to date when they are called
+	connect(this, SIGNAL(filter()), this, SLOT(updateFilter()));
+	updateFilter();
 
 }
 
@@ -343,6 +367,8 @@ void TransactionFilterWidget::updateTags() {
 		tagCombo->addItems(budget->tags);
 		tagCombo->setCurrentIndex(0);
 	}
+	if(transtype != TRANSACTION_TYPE_TRANSFER) ((CompletionModel*) descriptionEdit->completer()->model())->refresh();
+	updateFilter();
 }
 void TransactionFilterWidget::updateFromAccounts() {
 	fromCombo->clear();
@@ -373,6 +399,7 @@ void TransactionFilterWidget::updateFromAccounts() {
 		}
 	}
 	fromCombo->setCurrentIndex(0);
+	updateFilter();
 }
 void TransactionFilterWidget::updateToAccounts() {
 	toCombo->clear();
@@ -403,6 +430,7 @@ void TransactionFilterWidget::updateToAccounts() {
 		}
 	}
 	toCombo->setCurrentIndex(0);
+	updateFilter();
 }
 void TransactionFilterWidget::updateAccounts() {
 	updateFromAccounts();
@@ -410,214 +438,41 @@ void TransactionFilterWidget::updateAccounts() {
 	maxEdit->setCurrency(budget->defaultCurrency());
 	minEdit->setCurrency(budget->defaultCurrency());
 }
-bool TransactionFilterWidget::filterTransaction(Transactions *transs, bool checkdate) {
-	Transaction *trans = NULL;
-	MultiAccountTransaction *split = NULL;
-	switch(transs->generaltype()) {
-		case GENERAL_TRANSACTION_TYPE_SINGLE: {
-			trans = (Transaction*) transs; 
-			if(trans->parentSplit() && trans->parentSplit()->type() == SPLIT_TRANSACTION_TYPE_MULTIPLE_ACCOUNTS) return true;
-			if(trans->subtype() == TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND && trans->value() == 0.0) return true;
-			break;
-		}
-		case GENERAL_TRANSACTION_TYPE_SPLIT: {
-			if(((SplitTransaction*) transs)->type() != SPLIT_TRANSACTION_TYPE_MULTIPLE_ACCOUNTS) return true;
-			split = (MultiAccountTransaction*) transs; 
-			break;
-		}
-		case GENERAL_TRANSACTION_TYPE_SCHEDULE: {return filterTransaction(((ScheduledTransaction*) transs)->transaction(), checkdate);}
-	}
-	if(trans) {
-		if(trans->type() == TRANSACTION_TYPE_SECURITY_BUY || trans->type() == TRANSACTION_TYPE_SECURITY_SELL) {
-			if(transtype == TRANSACTION_TYPE_TRANSFER && ((SecurityTransaction*) trans)->account()->type() != ACCOUNT_TYPE_ASSETS) return true;
-			if(transtype == TRANSACTION_TYPE_EXPENSE && ((SecurityTransaction*) trans)->account()->type() != ACCOUNT_TYPE_EXPENSES) return true;
-			if(transtype == TRANSACTION_TYPE_INCOME && ((SecurityTransaction*) trans)->account()->type() != ACCOUNT_TYPE_INCOMES) return true;
-		} else if(trans->type() != transtype) {
-			return true;
-		}
-	} else {
-		if(split->transactiontype() != transtype) return true;
-		if(split->count() == 0) return true;
-		trans = split->at(0);
-	}
-	bool b_exact = exactMatchButton->isChecked();
-	bool b_exclude_subs = excludeSubsButton ? excludeSubsButton->isChecked() : b_exact;
-	if(includeButton->isChecked()) {
-		Account *account = (Account*) toCombo->currentData().value<void*>();
-		if(toCombo->currentIndex() > 0 && account != trans->toAccount() && (b_exclude_subs || account != trans->toAccount()->topAccount())) {
-			if(split) {
-				bool b = false;
-				for(int split_i = 1; split_i < split->count(); split_i++) {
-					if(account == split->at(split_i)->toAccount() || (!b_exclude_subs && account == split->at(split_i)->toAccount()->topAccount())) {
-						b = true;
-						break;
-					}
-				}
-				if(!b) return true;
-			} else {
-				return true;
-			}
-		}
-		account = (Account*) fromCombo->currentData().value<void*>();
-		if(fromCombo->currentIndex() > 0 && account != trans->fromAccount() && (b_exclude_subs || account != trans->fromAccount()->topAccount())) {
-			if(split) {
-				bool b = false;
-				for(int split_i = 1; split_i < split->count(); split_i++) {
-					if(account == split->at(split_i)->fromAccount() || (!b_exclude_subs && account == split->at(split_i)->fromAccount()->topAccount())) {
-						b = true;
-						break;
-					}
-				}
-				if(!b) return true;
-			} else {
-				return true;
-			}
-		}
-		if(tagCombo && tagCombo->currentIndex() > 0 && !transs->hasTag(tagCombo->currentText(), true)) return true;
-		if(b_exact && !descriptionEdit->text().isEmpty()) {
-			bool b = transs->description().compare(descriptionEdit->text(), Qt::CaseInsensitive) != 0 && (tagCombo || !transs->hasTag(descriptionEdit->text(), true, true));
-			if(b_extra && b && transtype == TRANSACTION_TYPE_EXPENSE) {
-				b = ((Expense*) trans)->payee().compare(descriptionEdit->text(), Qt::CaseInsensitive) != 0;
-				if(b && split) {
-					for(int split_i = 1; split_i < split->count(); split_i++) {
-						if(((Expense*) split->at(split_i))->payee().compare(descriptionEdit->text(), Qt::CaseInsensitive) == 0) {
-							b = false;
-							break;
-						}
-					}
-				}
-			}
-			if(b_extra && b && transtype == TRANSACTION_TYPE_INCOME) {
-				b = ((Income*) trans)->payer().compare(descriptionEdit->text(), Qt::CaseInsensitive) != 0;
-				if(b && split) {
-					for(int split_i = 1; split_i < split->count(); split_i++) {
-						if(((Income*) split->at(split_i))->payer().compare(descriptionEdit->text(), Qt::CaseInsensitive) == 0) {
-							b = false;
-							break;
-						}
-					}
-					if(!b) return true;
-				} else {
-					return true;
-				}
-			}
-			if(b) return true;
-		} else if(!descriptionEdit->text().isEmpty()) {
-			bool b = !transs->description().contains(descriptionEdit->text(), Qt::CaseInsensitive) && !transs->comment().contains(descriptionEdit->text(), Qt::CaseInsensitive) && (tagCombo || !transs->hasTag(descriptionEdit->text(), true, true));
-			if(b_extra && b && transtype == TRANSACTION_TYPE_EXPENSE) {
-				b = !((Expense*) trans)->payee().contains(descriptionEdit->text(), Qt::CaseInsensitive);
-				if(b && split) {
-					for(int split_i = 1; split_i < split->count(); split_i++) {
-						if(((Expense*) split->at(split_i))->payee().contains(descriptionEdit->text(), Qt::CaseInsensitive)) {
-							b = false;
-							break;
-						}
-					}
-				}
-			}
-			if(b_extra && b && transtype == TRANSACTION_TYPE_INCOME) {
-				b = !((Income*) trans)->payer().contains(descriptionEdit->text(), Qt::CaseInsensitive);
-				if(b && split) {
-					for(int split_i = 1; split_i < split->count(); split_i++) {
-						if(((Income*) split->at(split_i))->payer().contains(descriptionEdit->text(), Qt::CaseInsensitive)) {
-							b = false;
-							break;
-						}
-					}
-				}
-			}
-			if(b) return true;
-		}
-	} else {
-		Account *account = (Account*) toCombo->currentData().value<void*>();
-		if(toCombo->currentIndex() > 0 && (account == trans->toAccount() || (!b_exclude_subs && account == trans->toAccount()->topAccount()))) {
-			if(!split || transtype != TRANSACTION_TYPE_INCOME || !split->account()) return true;
-		}
-		account = (Account*) fromCombo->currentData().value<void*>();
-		if(fromCombo->currentIndex() > 0 && (account == trans->fromAccount() || (!b_exclude_subs && account == trans->fromAccount()->topAccount()))) {
-			if(!split || transtype != TRANSACTION_TYPE_EXPENSE || !split->account()) return true;
-		}
-		if(tagCombo && tagCombo->currentIndex() > 0 && transs->hasTag(tagCombo->currentText(), true)) return true;
-		if(b_exact && !descriptionEdit->text().isEmpty()) {
-			if((transs->description().compare(descriptionEdit->text(), Qt::CaseInsensitive) == 0 || (!tagCombo && transs->hasTag(descriptionEdit->text(), true, true)))) {
-				return true;
-			}
-			if(b_extra && transtype == TRANSACTION_TYPE_EXPENSE && ((Expense*) trans)->payee().compare(descriptionEdit->text(), Qt::CaseInsensitive) == 0) {
-				if(split) {
-					bool b = false;
-					for(int split_i = 1; split_i < split->count(); split_i++) {
-						if(((Expense*) split->at(split_i))->payee().compare(descriptionEdit->text(), Qt::CaseInsensitive) != 0) {
-							b = true;
-							break;
-						}
-					}
-					if(!b) return true;
-				} else {
-					return true;
-				}
-			}
-			if(b_extra && transtype == TRANSACTION_TYPE_INCOME && ((Income*) trans)->payer().compare(descriptionEdit->text(), Qt::CaseInsensitive) == 0) {
-				if(split) {
-					bool b = false;
-					for(int split_i = 1; split_i < split->count(); split_i++) {
-						if(((Income*) split->at(split_i))->payer().compare(descriptionEdit->text(), Qt::CaseInsensitive) != 0) {
-							b = true;
-							break;
-						}
-					}
-					if(!b) return true;
-				} else {
-					return true;
-				}
-			}
-		} else if(!descriptionEdit->text().isEmpty()) {
-			if(!descriptionEdit->text().isEmpty() && (transs->description().contains(descriptionEdit->text(), Qt::CaseInsensitive) || (!tagCombo && transs->hasTag(descriptionEdit->text(), true, true)))) {
-				return true;
-			}
-			if(b_extra && transtype == TRANSACTION_TYPE_EXPENSE && ((Expense*) trans)->payee().contains(descriptionEdit->text(), Qt::CaseInsensitive)) {
-				if(split) {
-					bool b = false;
-					for(int split_i = 1; split_i < split->count(); split_i++) {
-						if(!((Expense*) split->at(split_i))->payee().contains(descriptionEdit->text(), Qt::CaseInsensitive)) {
-							b = true;
-							break;
-						}
-					}
-					if(!b) return true;
-				} else {
-					return true;
-				}
-				return true;
-			}
-			if(b_extra && transtype == TRANSACTION_TYPE_INCOME  && ((Income*) trans)->payer().contains(descriptionEdit->text(), Qt::CaseInsensitive)) {
-				if(split) {
-					bool b = false;
-					for(int split_i = 1; split_i < split->count(); split_i++) {
-						if(!((Income*) split->at(split_i))->payer().contains(descriptionEdit->text(), Qt::CaseInsensitive)) {
-							b = true;
-							break;
-						}
-					}
-					if(!b) return true;
-				} else {
-					return true;
-				}
-			}
-		}
-	}
-	if(minButton->isChecked() && transs->value(true) < minEdit->value()) {
-		return true;
-	}
-	if(maxButton->isChecked() && transs->value(true) > maxEdit->value()) {
-		return true;
-	}
-	if(checkdate && dateFromButton->isChecked() && transs->date() < from_date) {
-		return true;
+void TransactionFilterWidget::updateFilter() {
+	current_filter.transtype = transtype;
+	current_filter.b_extra = b_extra;
+	current_filter.b_exclude = !includeButton->isChecked();
+	current_filter.b_exact = exactMatchButton->isChecked();
+	current_filter.b_exclude_subs = excludeSubsButton ? excludeSubsButton->isChecked() : current_filter.b_exact;
+	current_filter.to_account = toCombo->currentIndex() > 0 ? (Account*) toCombo->currentData().value<void*>() : NULL;
+	current_filter.from_account = fromCombo->currentIndex() > 0 ? (Account*) fromCombo->currentData().value<void*>() : NULL;
+	current_filter.tag = (tagCombo && tagCombo->currentIndex() > 0) ? tagCombo->currentText() : QString();
+	current_filter.description = descriptionEdit->text();
+	current_filter.description_folded = current_filter.description.toCaseFolded();
+	current_filter.b_match_tags = !tagCombo;
+	current_filter.b_description_is_tag = !tagCombo && budget->tags.contains(current_filter.description, Qt::CaseInsensitive);
+	current_filter.b_min = minButton->isChecked();
+	current_filter.min_value = minEdit->value();
+	current_filter.b_max = maxButton->isChecked();
+	current_filter.max_value = maxEdit->value();
+	current_filter.from_date = dateFromButton->isChecked() ? from_date : QDate();
+	current_filter.to_date = to_date;
+	current_filter.text_candidates.clear();
+	current_filter.b_text_candidates = false;
+	if(!current_filter.description.isEmpty()) {
+		const TransactionTextIndex &index = budget->textIndex();
+		current_filter.text_index = &index;
+		current_filter.text_index_revision = index.revision();
+		current_filter.b_text_candidates = index.findCandidates(current_filter.description, current_filter.text_candidates);
 	}
-	if(checkdate && transs->date() > to_date) {
-		return true;
-	}
-	return false;
+}
+const TransactionFilter &TransactionFilterWidget::transactionFilter() const {
+	return current_filter;
+}
+bool TransactionFilterWidget::filterTransaction(Transactions *transs, bool checkdate) {
+	//refresh text candidates after transactions have been added or modified
+	if(current_filter.b_text_candidates && current_filter.text_index_revision != current_filter.text_index->revision()) updateFilter();
+	return current_filter.filterTransaction(transs, checkdate);
 }
 QDate TransactionFilterWidget::startDate() {
 	if(!dateFromButton->isChecked()) return QDate();
@@ -626,111 +481,6 @@ QDate TransactionFilterWidget::startDate() {
 QDate TransactionFilterWidget::endDate() {
 	return to_date;
 }
-void TransactionFilterWidget::transactionsReset() {
-	((QStandardItemModel*) descriptionEdit->completer()->model())->clear();
-	QStringList descr_list;
-	switch(transtype) {
-		case TRANSACTION_TYPE_EXPENSE: {
-			for(TransactionList<Expense*>::const_iterator it = budget->expenses.constEnd(); it != budget->expenses.constBegin();) {
-				--it;
-				Expense *expense = *it;
-				if(!expense->description().isEmpty() && !descr_list.contains(expense->description(), Qt::CaseInsensitive)) {
-					QList<QStandardItem*> row;
-					row << new QStandardItem(expense->description());
-					row << new QStandardItem(expense->description().toLower());
-					((QStandardItemModel*) descriptionEdit->completer()->model())->appendRow(row);
-					descr_list << expense->description().toLower();
-				}
-				if(b_extra && !expense->payee().isEmpty() && !descr_list.contains(expense->payee(), Qt::CaseInsensitive)) {
-					QList<QStandardItem*> row;
-					row << new QStandardItem(expense->payee());
-					row << new QStandardItem(expense->payee().toLower());
-					((QStandardItemModel*) descriptionEdit->completer()->model())->appendRow(row);
-					descr_list << expense->payee().toLower();
-				}
-			}
-			break;
-		}
-		case TRANSACTION_TYPE_INCOME: {
-			for(TransactionList<Income*>::const_iterator it = budget->incomes.constEnd(); it != budget->incomes.constBegin();) {
-				--it;
-				Income *income = *it;
-				if(!income->security() && !income->description().isEmpty() && !descr_list.contains(income->description(), Qt::CaseInsensitive)) {
-					QList<QStandardItem*> row;
-					row << new QStandardItem(income->description());
-					row << new QStandardItem(income->description().toLower());
-					((QStandardItemModel*) descriptionEdit->completer()->model())->appendRow(row);
-					descr_list << income->description().toLower();
-				}
-				if(b_extra && !income->security() && !income->payer().isEmpty() && !descr_list.contains(income->payer(), Qt::CaseInsensitive)) {
-					QList<QStandardItem*> row;
-					row << new QStandardItem(income->payer());
-					row << new QStandardItem(income->payer().toLower());
-					((QStandardItemModel*) descriptionEdit->completer()->model())->appendRow(row);
-					descr_list << income->payer().toLower();
-				}
-			}
-			break;
-		}
-		case TRANSACTION_TYPE_TRANSFER: {
-			for(TransactionList<Transfer*>::const_iterator it = budget->transfers.constEnd(); it != budget->transfers.constBegin();) {
-				--it;
-				Transfer *transfer = *it;
-				if(!transfer->description().isEmpty() && !descr_list.contains(transfer->description(), Qt::CaseInsensitive)) {
-					QList<QStandardItem*> row;
-					row << new QStandardItem(transfer->description());
-					row << new QStandardItem(transfer->description().toLower());
-					((QStandardItemModel*) descriptionEdit->completer()->model())->appendRow(row);
-					descr_list << transfer->description().toLower();
-				}
-			}
-			break;
-		}
-		default: {}
-	}
-	if(transtype != TRANSACTION_TYPE_TRANSFER) {
-		for(int i = 0; i < budget->tags.count(); i++) {
-			QList<QStandardItem*> row;
-			row << new QStandardItem(budget->tags[i]);
-			row << new QStandardItem(budget->tags[i].toLower());
-			((QStandardItemModel*) descriptionEdit->completer()->model())->appendRow(row);
-		}
-	}
-	((QStandardItemModel*) descriptionEdit->completer()->model())->sort(1);
-}
-void TransactionFilterWidget::transactionAdded(Transaction *trans) {
-	if(descriptionEdit && trans->type() == transtype && (transtype != TRANSACTION_TYPE_INCOME || !((Income*) trans)->security())) {
-		if(!trans->description().isEmpty()) {
-			if(((QStandardItemModel*) descriptionEdit->completer()->model())->findItems(trans->description().toLower(), Qt::MatchExactly, 1).isEmpty()) {
-				QList<QStandardItem*> row;
-				row << new QStandardItem(trans->description());
-				row << new QStandardItem(trans->description().toLower());
-				((QStandardItemModel*) descriptionEdit->completer()->model())->appendRow(row);
-				((QStandardItemModel*) descriptionEdit->completer()->model())->sort(1);
-			}
-		}
-		if(b_extra && transtype == TRANSACTION_TYPE_EXPENSE && !((Expense*) trans)->payee().isEmpty()) {
-			if(((QStandardItemModel*) descriptionEdit->completer()->model())->findItems(((Expense*) trans)->payee().toLower(), Qt::MatchExactly, 1).isEmpty()) {
-				QList<QStandardItem*> row;
-				row << new QStandardItem(((Expense*) trans)->payee());
-				row << new QStandardItem(((Expense*) trans)->payee().toLower());
-				((QStandardItemModel*) descriptionEdit->completer()->model())->appendRow(row);
-				((QStandardItemModel*) descriptionEdit->completer()->model())->sort(1);
-			}
-		} else if(b_extra && transtype == TRANSACTION_TYPE_INCOME && !((Income*) trans)->security() && !((Income*) trans)->payer().isEmpty()) {
-			if(((QStandardItemModel*) descriptionEdit->completer()->model())->findItems(((Income*) trans)->payer().toLower(), Qt::MatchExactly, 1).isEmpty()) {
-				QList<QStandardItem*> row;
-				row << new QStandardItem(((Income*) trans)->payer());
-				row << new QStandardItem(((Income*) trans)->payer().toLower());
-				((QStandardItemModel*) descriptionEdit->completer()->model())->appendRow(row);
-				((QStandardItemModel*) descriptionEdit->completer()->model())->sort(1);
-			}
-		}
-	}
-}
-void TransactionFilterWidget::transactionModified(Transaction *trans) {
-	transactionAdded(trans);
-}
 void TransactionFilterWidget::toChanged(const QDate &date) {
 	bool error = false;
 	if(!date.isValid()) {
@@ -25,6 +25,8 @@
 #include <QWidget>
 #include <QDateTime>
 
+#include "transactionfilter.h"
+
 class QButtonGroup;
 class QCheckBox;
 class QLabel;
@@ -51,12 +53,10 @@ class TransactionFilterWidget : public QWidget {
 		TransactionFilterWidget(bool extra_parameters, int transaction_type, Budget *budg, QWidget *parent = 0);
 		~TransactionFilterWidget();
 		bool filterTransaction(Transactions *transs, bool checkdate = true);
+		const TransactionFilter &transactionFilter() const;
 		void updateFromAccounts();
 		void updateToAccounts();
 		void updateAccounts();
-		void transactionsReset();
-		void transactionAdded(Transaction*);
-		void transactionModified(Transaction*);
 		double countYears();
 		double countMonths();
 		int countDays();
@@ -84,6 +84,7 @@ class TransactionFilterWidget : public QWidget {
 		QCheckBox *exactMatchButton, *excludeSubsButton;
 		QPushButton *clearButton;
 		QButtonGroup *group;
+		TransactionFilter current_filter;
 
 	protected slots:
 
@@ -93,6 +94,7 @@ class TransactionFilterWidget : public QWidget {
 		void checkEnableClear();
 		void onToActivated(int);
 		void onFromActivated(int);
+		void updateFilter();
 
 	signals:
 
@@ -43,6 +43,7 @@
 #include <QTabWidget>
 #include <QMessageBox>
 #include <QSettings>
+#include <QTimer>
 
 #include "budget.h"
 #include "editscheduledtransactiondialog.h"
@@ -74,8 +75,17 @@ class TransactionListViewItem : public QTreeWidgetItem {
 		ScheduledTransaction *o_strans;
 		MultiAccountTransaction *o_split;
 		QDate d_date;
+		const TransactionListWidget *o_list;
+		mutable int i_sort_column, i_sort_generation;
+		mutable double d_sort_value;
+		mutable QCollatorSortKey *o_sort_key;
+		void updateSortKey(int column) const;
 	public:
-		TransactionListViewItem(const QDate &trans_date, Transaction *trans, ScheduledTransaction *strans, MultiAccountTransaction *split, QString, QString = QString(), QString = QString(), QString = QString(), QString = QString(), QString = QString(), QString = QString(), QString = QString());
+		TransactionListViewItem(const QDate &trans_date, Transaction *trans, ScheduledTransaction *strans, MultiAccountTransaction *split, const TransactionListWidget *list);
+		~TransactionListViewItem();
+		QVariant data(int column, int role) const;
+		QString columnText(int column) const;
+		void transactionModified();
 		bool operator<(const QTreeWidgetItem &i_pre) const;
 		Transaction *transaction() const;
 		ScheduledTransaction *scheduledTransaction() const;
@@ -90,8 +100,13 @@ TransactionListWidget::TransactionListWidget(bool extra_parameters, int transact
 	current_quantity = 0.0;
 	
 	key_event = NULL;
+	i_sort_generation = 0;
 
 	selected_trans = NULL;
+	b_listed_filter = false;
+	i_filter_pos = 0;
+	b_filter_queued = false;
+	b_filtering_queue = false;
 
 	listPopupMenu = NULL;
 	headerPopupMenu = NULL;
@@ -211,7 +226,7 @@ TransactionListWidget::TransactionListWidget(bool extra_parameters, int transact
 	connect(editWidget, SIGNAL(addmodify()), this, SLOT(addModifyTransaction()));
 	connect(removeButton, SIGNAL(clicked()), this, SLOT(removeTransaction()));
 	connect(clearButton, SIGNAL(clicked()), this, SLOT(editClear()));
-	connect(filterWidget, SIGNAL(filter()), this, SLOT(filterTransactions()));
+	connect(filterWidget, SIGNAL(filter()), this, SLOT(refilterTransactions()));
 	connect(filterWidget, SIGNAL(toActivated(Account*)), this, SLOT(filterToActivated(Account*)));
 	connect(filterWidget, SIGNAL(fromActivated(Account*)), this, SLOT(filterFromActivated(Account*)));
 	connect(transactionsView, SIGNAL(itemSelectionChanged()), this, SLOT(transactionSelectionChanged()));
@@ -342,6 +357,7 @@ void TransactionListWidget::keyPressEvent(QKeyEvent *e) {
 	}
 }
 void TransactionListWidget::tagsModified() {
+	i_sort_generation++;
 	editWidget->tagsModified();
 	filterWidget->updateTags();
 }
@@ -438,11 +454,14 @@ void TransactionListWidget::sortByCreationTime(bool b) {
 extern QString htmlize_string(QString str);
 
 bool TransactionListWidget::isEmpty() {
+	finishFiltering();
 	return transactionsView->topLevelItemCount() == 0;
 }
 
 bool TransactionListWidget::exportList(QTextStream &outf, int fileformat) {
 
+	finishFiltering();
+
 	switch(fileformat) {
 		case 'h': {
 			outf.setCodec("UTF-8");
@@ -572,11 +591,20 @@ bool TransactionListWidget::exportList(QTextStream &outf, int fileformat) {
 
 }
 void TransactionListWidget::transactionsReset() {
-	filterWidget->transactionsReset();
-	editWidget->transactionsReset();
 	clearTransaction();
 	filterTransactions();
 }
+void TransactionListWidget::budgetCleared() {
+	//the transactions are about to be freed; drop every pointer to them, including the queue of a pending chunk
+	clearTransaction();
+	filter_queue.clear();
+	i_filter_pos = 0;
+	b_listed_filter = false;
+	selected_trans = NULL;
+	transactionsView->clear();
+	current_value = 0.0;
+	current_quantity = 0.0;
+}
 void TransactionListWidget::addTransaction() {
 	Transaction *trans = editWidget->createTransaction();
 	if(!trans) return;
@@ -1391,6 +1419,11 @@ void TransactionListWidget::addModifyTransaction() {
 }
 
 void TransactionListWidget::appendFilterTransaction(Transactions *transs, bool update_total_value, ScheduledTransaction *strans) {
+	if(i_filter_pos < filter_queue.count() && !b_filtering_queue) {
+		//the list is being filtered; queue the transaction unless it has not been tested yet
+		if(filter_queue.indexOf(transs, i_filter_pos) < 0) filter_queue << transs;
+		return;
+	}
 	Transaction *trans = NULL;
 	MultiAccountTransaction *split = NULL;
 	switch(transs->generaltype()) {
@@ -1434,7 +1467,9 @@ void TransactionListWidget::appendFilterTransaction(Transactions *transs, bool u
 			else date = strans->firstOccurrence();
 		} else {
 			if(date.isNull()) date = strans->recurrence()->firstOccurrence();
-			else date = strans->recurrence()->nextOccurrence(date, true);
+			QVector<QDate> dates = strans->recurrence()->occurrences(date, enddate);
+			if(dates.isEmpty()) date = QDate();
+			else date = dates.first();
 		}
 		if(date.isNull() || date > enddate) update_total_value = false;
 	} else {
@@ -1442,12 +1477,9 @@ void TransactionListWidget::appendFilterTransaction(Transactions *transs, bool u
 	}
 	while(!strans || (!date.isNull() && date <= enddate)) {
 
-		QTreeWidgetItem *i = new TransactionListViewItem(date, trans, strans, split, QString(), QString(), transs->valueString());
-		
-		if(strans && strans->recurrence()) i->setText(0, QLocale().toString(date, QLocale::ShortFormat) + "**");
-		else i->setText(0, QLocale().toString(date, QLocale::ShortFormat));
+		//column text is formatted in TransactionListViewItem::data() when the row is displayed
+		QTreeWidgetItem *i = new TransactionListViewItem(date, trans, strans, split, this);
 		transactionsView->insertTopLevelItem(0, i);
-		i->setTextAlignment(2, Qt::AlignRight | Qt::AlignVCenter);
 		
 		if((split && split->cost() > 0.0) || (trans && ((trans->type() == TRANSACTION_TYPE_EXPENSE && trans->value() > 0.0) || (trans->type() == TRANSACTION_TYPE_INCOME && trans->value() < 0.0)))) {
 			if(!expenseColor.isValid()) expenseColor = createExpenseColor(i, 2);
@@ -1478,29 +1510,11 @@ void TransactionListWidget::appendFilterTransaction(Transactions *transs, bool u
 			i->setSelected(true);
 			transactionsView->blockSignals(false);
 		}
-		if(trans && trans->parentSplit()) i->setText(1, trans->description() + "*");
-		else i->setText(1, transs->description());
 		if(trans) {
-			i->setText(from_col, trans->fromAccount()->name());
-			i->setText(to_col, trans->toAccount()->name());
-			if(payee_col >= 0) {
-				if(trans->type() == TRANSACTION_TYPE_EXPENSE) i->setText(payee_col, ((Expense*) trans)->payee());
-				else if(trans->type() == TRANSACTION_TYPE_INCOME) i->setText(payee_col, ((Income*) trans)->payer());
-			}
-			if(trans->parentSplit() && trans->comment().isEmpty()) i->setText(comments_col, trans->parentSplit()->comment());
-			else i->setText(comments_col, trans->comment());
-			if(quantity_col >= 0) i->setText(quantity_col, budget->formatValue(trans->quantity()));
-			if(tags_col >= 0) i->setText(tags_col, trans->tagsText(true));
 			if(!trans->associatedFile().isEmpty() || (trans->parentSplit() && !trans->parentSplit()->associatedFile().isEmpty())) i->setIcon(2, LOAD_ICON_STATUS("mail-attachment"));
 		} else if(split) {
-			i->setText(3, split->category()->name());
-			i->setText(4, split->accountsString());
-			if(payee_col >= 0) i->setText(payee_col, split->payeeText());
-			if(quantity_col >= 0) i->setText(quantity_col, budget->formatValue(split->quantity()));
-			i->setText(comments_col, transs->comment());
-			if(tags_col >= 0) i->setText(tags_col, transs->tagsText());
 			if(!split->associatedFile().isEmpty()) i->setIcon(2, LOAD_ICON_STATUS("mail-attachment"));
-		}		
+		}
 		current_value += transs->value(true);
 		current_quantity += transs->quantity();
 		if(strans && !strans->isOneTimeTransaction()) date = strans->recurrence()->nextOccurrence(date);
@@ -1513,6 +1527,7 @@ void TransactionListWidget::appendFilterTransaction(Transactions *transs, bool u
 }
 
 void TransactionListWidget::onTransactionSplitUp(SplitTransaction *split) {
+	finishFiltering();
 	if(split->type() == SPLIT_TRANSACTION_TYPE_MULTIPLE_ACCOUNTS) {
 		for(int i = 0; i < split->count(); i++) {
 			split->at(i)->setParentSplit(NULL);
@@ -1526,7 +1541,7 @@ void TransactionListWidget::onTransactionSplitUp(SplitTransaction *split) {
 		TransactionListViewItem *i = (TransactionListViewItem*) *it;
 		while(i) {
 			if(i->transaction() && i->transaction()->parentSplit() == split) {
-				i->setText(1, i->transaction()->description());
+				i->transactionModified();
 				if(!split->associatedFile().isEmpty() && i->transaction()->associatedFile().isEmpty()) i->setIcon(2, QIcon());
 			}
 			++it;
@@ -1537,31 +1552,6 @@ void TransactionListWidget::onTransactionSplitUp(SplitTransaction *split) {
 }
 void TransactionListWidget::onTransactionAdded(Transactions *trans) {
 	appendFilterTransaction(trans, true);
-	switch(trans->generaltype()) {
-		case GENERAL_TRANSACTION_TYPE_SINGLE: {
-			filterWidget->transactionAdded((Transaction*) trans);
-			editWidget->transactionAdded((Transaction*) trans);
-			break;
-		}
-		case GENERAL_TRANSACTION_TYPE_SCHEDULE: {
-			ScheduledTransaction *strans = (ScheduledTransaction*) trans;
-			if(strans->transaction()->generaltype() == GENERAL_TRANSACTION_TYPE_SINGLE) {
-				editWidget->transactionAdded((Transaction*) strans->transaction());
-				filterWidget->transactionAdded((Transaction*) strans->transaction());
-			} else if(strans->transaction()->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT) {
-				SplitTransaction *split = (SplitTransaction*) strans->transaction();
-				int n = split->count();
-				for(int split_i = 0; split_i < n; split_i++) {
-					editWidget->transactionAdded(split->at(split_i));
-					filterWidget->transactionAdded(split->at(split_i));
-				}
-			}
-			break;
-		}
-		case GENERAL_TRANSACTION_TYPE_SPLIT: {
-			break;
-		}
-	}
 }
 void TransactionListWidget::onTransactionModified(Transactions *transs, Transactions *oldtranss) {
 	switch(transs->generaltype()) {
@@ -1588,27 +1578,12 @@ void TransactionListWidget::onTransactionModified(Transactions *transs, Transact
 					current_value += trans->value(true);
 					current_quantity += trans->quantity();
 					i->setDate(trans->date());
-					i->setText(0, QLocale().toString(trans->date(), QLocale::ShortFormat));
-					if(trans->parentSplit()) i->setText(1, trans->description() + "*");
-					else i->setText(1, trans->description());
-					i->setText(2, trans->valueString());
-					i->setText(from_col, trans->fromAccount()->name());
-					i->setText(to_col, trans->toAccount()->name());
-					if(payee_col >= 0) {
-						if(trans->type() == TRANSACTION_TYPE_EXPENSE) i->setText(payee_col, ((Expense*) trans)->payee());
-						else if(trans->type() == TRANSACTION_TYPE_INCOME) i->setText(payee_col, ((Income*) trans)->payer());
-					}
-					if(trans->parentSplit() && trans->comment().isEmpty()) i->setText(comments_col, trans->parentSplit()->comment());
-					else i->setText(comments_col, trans->comment());
-					if(tags_col >= 0) i->setText(tags_col, transs->tagsText(true));
-					if(quantity_col >= 0) i->setText(quantity_col, budget->formatValue(transs->quantity()));
+					i->transactionModified();
 					if(!trans->associatedFile().isEmpty() || (trans->parentSplit() && !trans->parentSplit()->associatedFile().isEmpty())) i->setIcon(2, LOAD_ICON_STATUS("mail-attachment"));
 					else i->setIcon(2, QIcon());
 				}
 				updateStatistics();
 			}
-			if(oldtrans->description() != trans->description()) filterWidget->transactionModified(trans);
-			editWidget->transactionModified(trans);
 			break;
 		}
 		case GENERAL_TRANSACTION_TYPE_SCHEDULE: {
@@ -1631,18 +1606,6 @@ void TransactionListWidget::onTransactionModified(Transactions *transs, Transact
 			}
 			appendFilterTransaction(strans, true);
 			updateStatistics();
-			if(strans->transaction()->generaltype() == GENERAL_TRANSACTION_TYPE_SINGLE) {
-				if(oldstrans->transaction()->description() != strans->transaction()->description()) filterWidget->transactionModified((Transaction*) strans->transaction());
-				editWidget->transactionModified((Transaction*) strans->transaction());
-			} else if(strans->transaction()->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT) {
-				SplitTransaction *split = (SplitTransaction*) strans->transaction();
-				bool b_filter = (oldstrans->transaction()->description() != strans->transaction()->description());
-				int n = split->count();
-				for(int split_i = 0; split_i < n; split_i++) {
-					editWidget->transactionModified(split->at(split_i));
-					if(b_filter) filterWidget->transactionModified(split->at(split_i));
-				}
-			}
 			break;
 		}
 		case GENERAL_TRANSACTION_TYPE_SPLIT: {
@@ -1681,15 +1644,7 @@ void TransactionListWidget::onTransactionModified(Transactions *transs, Transact
 					current_value += split->value(true);
 					current_quantity += split->quantity();
 					i->setDate(split->date());
-					i->setText(0, QLocale().toString(split->date(), QLocale::ShortFormat));
-					i->setText(1, split->description() + "*");
-					i->setText(2, split->valueString());
-					i->setText(3, split->category()->name());
-					i->setText(4, split->accountsString());
-					if(payee_col >= 0) i->setText(payee_col, split->payeeText());
-					i->setText(comments_col, split->comment());
-					if(tags_col >= 0) i->setText(tags_col, split->tagsText());
-					if(quantity_col >= 0) i->setText(quantity_col, budget->formatValue(split->quantity()));
+					i->transactionModified();
 					if(!split->associatedFile().isEmpty()) i->setIcon(2, LOAD_ICON_STATUS("mail-attachment"));
 					else i->setIcon(2, QIcon()); 
 				}
@@ -1700,6 +1655,10 @@ void TransactionListWidget::onTransactionModified(Transactions *transs, Transact
 	}
 }
 void TransactionListWidget::onTransactionRemoved(Transactions *transs) {
+	if(i_filter_pos < filter_queue.count()) {
+		int index = filter_queue.indexOf(transs, i_filter_pos);
+		if(index >= 0) filter_queue.remove(index);
+	}
 	switch(transs->generaltype()) {
 		case GENERAL_TRANSACTION_TYPE_SINGLE: {
 			Transaction *trans = (Transaction*) transs;
@@ -1716,7 +1675,6 @@ void TransactionListWidget::onTransactionRemoved(Transactions *transs) {
 				++it;
 				i = (TransactionListViewItem*) *it;
 			}
-			editWidget->transactionRemoved(trans);
 			break;
 		}
 		case GENERAL_TRANSACTION_TYPE_SCHEDULE: {
@@ -1737,15 +1695,6 @@ void TransactionListWidget::onTransactionRemoved(Transactions *transs) {
 				}
 			}
 			updateStatistics();
-			if(strans->transaction()->generaltype() == GENERAL_TRANSACTION_TYPE_SINGLE) {
-				editWidget->transactionRemoved((Transaction*) strans->transaction());
-			} else if(strans->transaction()->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT) {
-				SplitTransaction *split = (SplitTransaction*) strans->transaction();
-				int n = split->count();
-				for(int split_i = 0; split_i < n; split_i++) {
-					editWidget->transactionRemoved(split->at(split_i));
-				}
-			}
 			break;
 		}
 		case GENERAL_TRANSACTION_TYPE_SPLIT: {
@@ -1783,19 +1732,25 @@ void TransactionListWidget::filterTransactions() {
 			else selected_trans = i->transaction();
 		}
 	}*/
+	//sort once when all items have been added, instead of inserting each item in sorted position
+	transactionsView->setSortingEnabled(false);
 	transactionsView->clear();
 	current_value = 0.0;
 	current_quantity = 0.0;
+	b_listed_filter = false;
+	//pointers to the transactions are collected first and tested in chunks, so that the list is populated progressively without blocking the user interface
+	filter_queue.clear();
+	i_filter_pos = 0;
 	switch(transtype) {
 		case TRANSACTION_TYPE_EXPENSE: {
 			for(TransactionList<Expense*>::const_iterator it = budget->expenses.constBegin(); it != budget->expenses.constEnd(); ++it) {
 				Expense *expense = *it;
-				appendFilterTransaction(expense, false);
+				filter_queue << expense;
 			}
 			for(SecurityTransactionList<SecurityTransaction*>::const_iterator it = budget->securityTransactions.constBegin(); it != budget->securityTransactions.constEnd(); ++it) {
 				SecurityTransaction *sectrans = *it;
 				if(sectrans->account()->type() == ACCOUNT_TYPE_EXPENSES) {
-					appendFilterTransaction(sectrans, false);
+					filter_queue << sectrans;
 				}
 			}
 			break;
@@ -1803,12 +1758,12 @@ void TransactionListWidget::filterTransactions() {
 		case TRANSACTION_TYPE_INCOME: {
 			for(TransactionList<Income*>::const_iterator it = budget->incomes.constBegin(); it != budget->incomes.constEnd(); ++it) {
 				Income *income = *it;
-				appendFilterTransaction(income, false);
+				filter_queue << income;
 			}
 			for(SecurityTransactionList<SecurityTransaction*>::const_iterator it = budget->securityTransactions.constBegin(); it != budget->securityTransactions.constEnd(); ++it) {
 				SecurityTransaction *sectrans = *it;
 				if(sectrans->account()->type() == ACCOUNT_TYPE_INCOMES) {
-					appendFilterTransaction(sectrans, false);
+					filter_queue << sectrans;
 				}
 			}
 			break;
@@ -1816,12 +1771,12 @@ void TransactionListWidget::filterTransactions() {
 		default: {
 			for(TransactionList<Transfer*>::const_iterator it = budget->transfers.constBegin(); it != budget->transfers.constEnd(); ++it) {
 				Transfer *transfer = *it;
-				appendFilterTransaction(transfer, false);
+				filter_queue << transfer;
 			}
 			for(SecurityTransactionList<SecurityTransaction*>::const_iterator it = budget->securityTransactions.constBegin(); it != budget->securityTransactions.constEnd(); ++it) {
 				SecurityTransaction *sectrans = *it;
 				if(sectrans->account()->type() == ACCOUNT_TYPE_ASSETS) {
-					appendFilterTransaction(sectrans, false);
+					filter_queue << sectrans;
 				}
 			}
 			break;
@@ -1829,12 +1784,40 @@ void TransactionListWidget::filterTransactions() {
 	}
 	for(ScheduledTransactionList<ScheduledTransaction*>::const_iterator it = budget->scheduledTransactions.constBegin(); it != budget->scheduledTransactions.constEnd(); ++it) {
 		ScheduledTransaction *strans = *it;
-		appendFilterTransaction(strans, false);
+		filter_queue << strans;
 	}
 	for(SplitTransactionList<SplitTransaction*>::const_iterator it = budget->splitTransactions.constBegin(); it != budget->splitTransactions.constEnd(); ++it) {
 		SplitTransaction *split = *it;
-		appendFilterTransaction(split, false);
+		filter_queue << split;
+	}
+	//the first chunk is filtered immediately, the rest when the event loop is idle
+	filterNextTransactions();
+}
+void TransactionListWidget::filterQueuedTransactions() {
+	b_filter_queued = false;
+	filterNextTransactions();
+}
+void TransactionListWidget::filterNextTransactions(bool finish) {
+	if(i_filter_pos >= filter_queue.count()) return;
+	transactionsView->setSortingEnabled(false);
+	int end = filter_queue.count();
+	if(!finish && end > i_filter_pos + 5000) end = i_filter_pos + 5000;
+	b_filtering_queue = true;
+	for(; i_filter_pos < end; i_filter_pos++) {
+		appendFilterTransaction(filter_queue[i_filter_pos], false);
+	}
+	b_filtering_queue = false;
+	if(i_filter_pos < filter_queue.count()) {
+		//the list is sorted once, when the last chunk has been added
+		updateStatistics();
+		if(!b_filter_queued) {
+			b_filter_queued = true;
+			QTimer::singleShot(0, this, SLOT(filterQueuedTransactions()));
+		}
+		return;
 	}
+	filter_queue.clear();
+	i_filter_pos = 0;
 	/*selected_trans = NULL;
 	selection = transactionsView->selectedItems();
 	if(selection.count() == 0) {*/
@@ -1842,6 +1825,42 @@ void TransactionListWidget::filterTransactions() {
 	//}
 	updateStatistics();
 	transactionsView->setSortingEnabled(true);
+	listed_filter = filterWidget->transactionFilter();
+	b_listed_filter = true;
+}
+void TransactionListWidget::finishFiltering() {
+	filterNextTransactions(true);
+}
+void TransactionListWidget::refilterTransactions() {
+	if(!b_listed_filter || !filterWidget->transactionFilter().isNarrowerThan(listed_filter)) {
+		filterTransactions();
+		return;
+	}
+	//the new filter only accepts a subset of the listed transactions, so only the current items need to be tested
+	selected_trans = NULL;
+	QDate startdate = filterWidget->startDate(), enddate = filterWidget->endDate();
+	transactionsView->setSortingEnabled(false);
+	QList<QTreeWidgetItem*> items = transactionsView->invisibleRootItem()->takeChildren();
+	QList<QTreeWidgetItem*> kept_items;
+	for(int index = 0; index < items.count(); index++) {
+		TransactionListViewItem *i = (TransactionListViewItem*) items.at(index);
+		Transactions *transs = i->splitTransaction();
+		if(!transs) transs = i->transaction();
+		bool b_remove = filterWidget->filterTransaction(transs, !i->scheduledTransaction());
+		if(!b_remove && i->scheduledTransaction()) b_remove = (!startdate.isNull() && i->date() < startdate) || i->date() > enddate;
+		if(b_remove) {
+			current_value -= transs->value(true);
+			current_quantity -= transs->quantity();
+			delete i;
+		} else {
+			kept_items << i;
+		}
+	}
+	transactionsView->addTopLevelItems(kept_items);
+	editInfoLabel->setText("");
+	updateStatistics();
+	transactionsView->setSortingEnabled(true);
+	listed_filter = filterWidget->transactionFilter();
 }
 
 void TransactionListWidget::currentTransactionChanged(QTreeWidgetItem *i) {
@@ -2056,15 +2075,81 @@ void TransactionListWidget::currentTabChanged(int index) {
 	else if(index == 1) filterWidget->focusFirst();
 }
 
-TransactionListViewItem::TransactionListViewItem(const QDate &trans_date, Transaction *trans, ScheduledTransaction *strans, MultiAccountTransaction *split, QString s1, QString s2, QString s3, QString s4, QString s5, QString s6, QString s7, QString s8) : QTreeWidgetItem(), o_trans(trans), o_strans(strans), o_split(split), d_date(trans_date) {
-	setText(0, s1);
-	setText(1, s2);
-	setText(2, s3);
-	setText(3, s4);
-	setText(4, s5);
-	setText(5, s6);
-	setText(6, s7);
-	setText(7, s8);
+TransactionListViewItem::TransactionListViewItem(const QDate &trans_date, Transaction *trans, ScheduledTransaction *strans, MultiAccountTransaction *split, const TransactionListWidget *list) : QTreeWidgetItem(), o_trans(trans), o_strans(strans), o_split(split), d_date(trans_date), o_list(list), i_sort_column(-1), i_sort_generation(0), d_sort_value(0.0), o_sort_key(NULL) {
+	setTextAlignment(2, Qt::AlignRight | Qt::AlignVCenter);
+}
+TransactionListViewItem::~TransactionListViewItem() {
+	delete o_sort_key;
+}
+QVariant TransactionListViewItem::data(int column, int role) const {
+	//the text is read from the transaction, which must therefore not be freed while the item exists (see Eqonomize::clearTransactionLists())
+	if(role == Qt::DisplayRole) return columnText(column);
+	return QTreeWidgetItem::data(column, role);
+}
+QString TransactionListViewItem::columnText(int column) const {
+	if(column == 0) {
+		if(o_strans && o_strans->recurrence()) return QLocale().toString(d_date, QLocale::ShortFormat) + "**";
+		return QLocale().toString(d_date, QLocale::ShortFormat);
+	}
+	if(o_trans) {
+		if(column == 1) {
+			if(o_trans->parentSplit()) return o_trans->description() + "*";
+			return o_trans->description();
+		} else if(column == 2) {
+			return o_trans->valueString();
+		} else if(column == o_list->from_col) {
+			return o_trans->fromAccount()->name();
+		} else if(column == o_list->to_col) {
+			return o_trans->toAccount()->name();
+		} else if(column == o_list->payee_col) {
+			if(o_trans->type() == TRANSACTION_TYPE_EXPENSE) return ((Expense*) o_trans)->payee();
+			else if(o_trans->type() == TRANSACTION_TYPE_INCOME) return ((Income*) o_trans)->payer();
+		} else if(column == o_list->comments_col) {
+			if(o_trans->parentSplit() && o_trans->comment().isEmpty()) return o_trans->parentSplit()->comment();
+			return o_trans->comment();
+		} else if(column == o_list->quantity_col) {
+			return o_list->budget->formatValue(o_trans->quantity());
+		} else if(column == o_list->tags_col) {
+			return o_trans->tagsText(true);
+		}
+	} else if(o_split) {
+		if(column == 1) {
+			//"*" marks a part of a split transaction, not the split itself (as when the row was first listed)
+			return o_split->description();
+		} else if(column == 2) {
+			return o_split->valueString();
+		} else if(column == 3) {
+			return o_split->category()->name();
+		} else if(column == 4) {
+			return o_split->accountsString();
+		} else if(column == o_list->payee_col) {
+			return o_split->payeeText();
+		} else if(column == o_list->comments_col) {
+			return o_split->comment();
+		} else if(column == o_list->quantity_col) {
+			return o_list->budget->formatValue(o_split->quantity());
+		} else if(column == o_list->tags_col) {
+			return o_split->tagsText();
+		}
+	}
+	return QString();
+}
+void TransactionListViewItem::transactionModified() {
+	i_sort_column = -1;
+	//notifies the view that the transaction (and thereby the text of each column) has changed
+	emitDataChanged();
+}
+void TransactionListViewItem::updateSortKey(int column) const {
+	if(i_sort_column == column && i_sort_generation == o_list->i_sort_generation) return;
+	i_sort_column = column;
+	i_sort_generation = o_list->i_sort_generation;
+	delete o_sort_key;
+	o_sort_key = NULL;
+	Transactions *transs = o_split;
+	if(!transs) transs = o_trans;
+	if(column == 2) d_sort_value = transs->value(true);
+	else if(column == o_list->quantity_col) d_sort_value = transs->quantity();
+	else o_sort_key = new QCollatorSortKey(o_list->collator.sortKey(columnText(column)));
 }
 bool TransactionListViewItem::operator<(const QTreeWidgetItem &i_pre) const {
 	int col = 0;
@@ -2085,12 +2170,20 @@ bool TransactionListViewItem::operator<(const QTreeWidgetItem &i_pre) const {
 		if((o_strans == NULL) != (i->scheduledTransaction() == NULL)) return o_strans == NULL;
 		if(t1->timestamp() < t2->timestamp()) return true;
 		if(t1->timestamp() > t2->timestamp()) return false;
-	} else if(col == 2) {
-		double d1 = t1->value(true), d2 = t2->value(true);
-		if(d1 < d2) return true;
-		if(d1 > d2) return false;
+		return QTreeWidgetItem::operator<(i_pre);
+	}
+	if(!o_list) return QTreeWidgetItem::operator<(i_pre);
+	// values and collation keys are cached per item, so that a sort does not format and parse text on every comparison
+	updateSortKey(col);
+	i->updateSortKey(col);
+	if(o_sort_key) {
+		int c = o_sort_key->compare(*i->o_sort_key);
+		if(c != 0) return c < 0;
+	} else {
+		if(d_sort_value < i->d_sort_value) return true;
+		if(d_sort_value > i->d_sort_value) return false;
 	}
-	return QTreeWidgetItem::operator<(i_pre);
+	return d_date < i->date();
 }
 Transaction *TransactionListViewItem::transaction() const {
 	return o_trans;
@@ -26,6 +26,10 @@
 #include <QTextStream>
 #include <QWidget>
 #include <QColor>
+#include <QCollator>
+#include <QVector>
+
+#include "transactionfilter.h"
 
 class QLabel;
 class QMenu;
@@ -48,12 +52,15 @@ class TransactionListWidget : public QWidget {
 	
 	Q_OBJECT
 	
+	friend class TransactionListViewItem;
+	
 	public:
 		
 		TransactionListWidget(bool extra_parameters, int transaction_type, Budget *budg, Eqonomize *main_win, QWidget *parent = 0);
 		
 		void useMultipleCurrencies(bool b);
 		void transactionsReset();
+		void budgetCleared();
 		void updateFromAccounts();
 		void updateToAccounts();
 		void updateAccounts();
@@ -87,8 +94,21 @@ class TransactionListWidget : public QWidget {
 		double current_value, current_quantity;
 		Transactions *selected_trans;
 		QColor expenseColor, incomeColor, transferColor;
+		//creates the cached sort keys of text columns; cached keys are discarded when i_sort_generation changes
+		QCollator collator;
+		int i_sort_generation;
 		QAction *ActionSortByCreationTime;
 		QKeyEvent *key_event;
+		//the filter used for the listed transactions
+		TransactionFilter listed_filter;
+		bool b_listed_filter;
+		//transactions waiting to be tested against the filter, starting at i_filter_pos
+		QVector<Transactions*> filter_queue;
+		int i_filter_pos;
+		bool b_filter_queued, b_filtering_queue;
+
+		void filterNextTransactions(bool finish = false);
+		void finishFiltering();
 		
 		void keyPressEvent(QKeyEvent*);
 		
@@ -121,6 +141,8 @@ class TransactionListWidget : public QWidget {
 		void onTransactionModified(Transactions*, Transactions*);
 		void onTransactionRemoved(Transactions*);
 		void filterTransactions();
+		void refilterTransactions();
+		void filterQueuedTransactions();
 		void currentTransactionChanged(QTreeWidgetItem*);
 		void transactionSelectionChanged();
 		void filterToActivated(Account*);
@@ -0,0 +1,156 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Hanna Knutsson                                  *
+ *   hanna.knutsson@protonmail.com                                         *
+ *                                                                         *
+ *   This file is part of Eqonomize!.                                      *
+ *                                                                         *
+ *   Eqonomize! is free software: you can redistribute it and/or modify    *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Eqonomize! is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Eqonomize!. If not, see <http://www.gnu.org/licenses/>.    *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "transactiontextindex.h"
+
+#include "transaction.h"
+
+#include <algorithm>
+
+#define TRIGRAM(s, i) ((quint64) s[i].unicode() << 32 | (quint64) s[i + 1].unicode() << 16 | (quint64) s[i + 2].unicode())
+
+TransactionTextIndex::TransactionTextIndex() : i_removed(0), i_revision(0) {}
+
+void TransactionTextIndex::clear() {
+	v_entries.clear();
+	entry_index.clear();
+	postings.clear();
+	i_removed = 0;
+	i_revision++;
+}
+void TransactionTextIndex::addText(const QString &text, int entry) {
+	if(text.length() < 3) return;
+	QString str = text.toCaseFolded();
+	for(int i = 0; i + 2 < str.length(); i++) {
+		QVector<int> &v = postings[TRIGRAM(str, i)];
+		//entries are always added with the highest index, so only the last item needs to be checked for duplicates
+		if(v.isEmpty() || v.last() != entry) v << entry;
+	}
+}
+void TransactionTextIndex::updateTransaction(Transactions *transs) {
+	removeTransaction(transs);
+	if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SINGLE) {
+		Transaction *trans = (Transaction*) transs;
+		//descriptions generated from account or security names might change without notice; such transactions are left out and always treated as candidates
+		switch(trans->subtype()) {
+			case TRANSACTION_SUBTYPE_DEBT_FEE: {}
+			case TRANSACTION_SUBTYPE_DEBT_INTEREST: {}
+			case TRANSACTION_SUBTYPE_DEBT_REDUCTION: {}
+			case TRANSACTION_SUBTYPE_REINVESTED_DIVIDEND: {return;}
+			default: {}
+		}
+		if(trans->type() == TRANSACTION_TYPE_SECURITY_BUY || trans->type() == TRANSACTION_TYPE_SECURITY_SELL) return;
+		if(trans->type() == TRANSACTION_TYPE_INCOME && ((Income*) trans)->security()) return;
+	}
+	int entry = v_entries.count();
+	v_entries << transs;
+	entry_index[transs] = entry;
+	addText(transs->description(), entry);
+	addText(transs->comment(), entry);
+	for(int i = 0; i < transs->tagsCount(true); i++) addText(transs->getTag(i, true), entry);
+	if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SINGLE) {
+		Transaction *trans = (Transaction*) transs;
+		if(trans->type() == TRANSACTION_TYPE_EXPENSE) addText(((Expense*) trans)->payee(), entry);
+		else if(trans->type() == TRANSACTION_TYPE_INCOME) addText(((Income*) trans)->payer(), entry);
+	} else if(transs->generaltype() == GENERAL_TRANSACTION_TYPE_SPLIT) {
+		SplitTransaction *split = (SplitTransaction*) transs;
+		for(int i = 0; i < split->count(); i++) {
+			Transaction *trans = split->at(i);
+			if(trans->type() == TRANSACTION_TYPE_EXPENSE) addText(((Expense*) trans)->payee(), entry);
+			else if(trans->type() == TRANSACTION_TYPE_INCOME) addText(((Income*) trans)->payer(), entry);
+		}
+	}
+	i_revision++;
+}
+void TransactionTextIndex::removeTransaction(Transactions *transs) {
+	QHash<Transactions*, int>::iterator it = entry_index.find(transs);
+	if(it == entry_index.end()) return;
+	v_entries[it.value()] = NULL;
+	entry_index.erase(it);
+	i_removed++;
+	i_revision++;
+	if(i_removed > 1000 && i_removed > v_entries.count() / 2) compact();
+}
+void TransactionTextIndex::compact() {
+	//removed transactions might already be deleted, so entries are renumbered without reading any transaction
+	QVector<int> new_index(v_entries.count(), -1);
+	int n = 0;
+	for(int i = 0; i < v_entries.count(); i++) {
+		if(v_entries[i]) {
+			new_index[i] = n;
+			v_entries[n] = v_entries[i];
+			entry_index[v_entries[n]] = n;
+			n++;
+		}
+	}
+	v_entries.resize(n);
+	for(QHash<quint64, QVector<int> >::iterator it = postings.begin(); it != postings.end();) {
+		QVector<int> &v = it.value();
+		int n2 = 0;
+		for(int i = 0; i < v.count(); i++) {
+			if(new_index[v[i]] >= 0) v[n2++] = new_index[v[i]];
+		}
+		if(n2 == 0) {
+			it = postings.erase(it);
+		} else {
+			v.resize(n2);
+			++it;
+		}
+	}
+	i_removed = 0;
+}
+bool TransactionTextIndex::contains(Transactions *transs) const {
+	return entry_index.contains(transs);
+}
+bool TransactionTextIndex::findCandidates(const QString &text, QSet<Transactions*> &candidates) const {
+	if(text.length() < 3) return false;
+	QString str = text.toCaseFolded();
+	QVector<const QVector<int>*> lists;
+	for(int i = 0; i + 2 < str.length(); i++) {
+		QHash<quint64, QVector<int> >::const_iterator it = postings.constFind(TRIGRAM(str, i));
+		if(it == postings.constEnd()) return true;
+		lists << &it.value();
+	}
+	//intersect, starting with the shortest list
+	int shortest = 0;
+	for(int i = 1; i < lists.count(); i++) {
+		if(lists[i]->count() < lists[shortest]->count()) shortest = i;
+	}
+	for(int i = 0; i < lists[shortest]->count(); i++) {
+		int entry = lists[shortest]->at(i);
+		if(!v_entries[entry]) continue;
+		bool b = true;
+		for(int i2 = 0; i2 < lists.count(); i2++) {
+			if(i2 != shortest && !std::binary_search(lists[i2]->constBegin(), lists[i2]->constEnd(), entry)) {
+				b = false;
+				break;
+			}
+		}
+		if(b) candidates.insert(v_entries[entry]);
+	}
+	return true;
+}
+int TransactionTextIndex::revision() const {
+	return i_revision;
+}
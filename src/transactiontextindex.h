@@ -0,0 +1,63 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Hanna Knutsson                                  *
+ *   hanna.knutsson@protonmail.com                                         *
+ *                                                                         *
+ *   This file is part of Eqonomize!.                                      *
+ *                                                                         *
+ *   Eqonomize! is free software: you can redistribute it and/or modify    *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Eqonomize! is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Eqonomize!. If not, see <http://www.gnu.org/licenses/>.    *
+ ***************************************************************************/
+
+#ifndef TRANSACTION_TEXT_INDEX_H
+#define TRANSACTION_TEXT_INDEX_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+class Transactions;
+
+//trigram index over the case folded description, comment, payee/payer and tags of transactions
+class TransactionTextIndex {
+
+	public:
+
+		TransactionTextIndex();
+
+		void clear();
+		//adds the transaction, or reindexes it if already added
+		void updateTransaction(Transactions *transs);
+		void removeTransaction(Transactions *transs);
+		//transactions that are not indexed always match
+		bool contains(Transactions *transs) const;
+		//adds all indexed transactions with text that might contain str (case insensitive) to candidates; returns false if str is too short for the search to be narrowed down
+		bool findCandidates(const QString &str, QSet<Transactions*> &candidates) const;
+		//increased on every change
+		int revision() const;
+
+	protected:
+
+		//removed transactions are set to NULL and skipped until the index is compacted
+		QVector<Transactions*> v_entries;
+		QHash<Transactions*, int> entry_index;
+		//sorted entry indices for each trigram
+		QHash<quint64, QVector<int> > postings;
+		int i_removed, i_revision;
+
+		void addText(const QString &text, int entry);
+		void compact();
+
+};
+
+#endif
@@ -0,0 +1,10 @@
+TEMPLATE = app
+TARGET = testrecurrence
+INCLUDEPATH += ../../src
+CONFIG += qt console testcase
+CONFIG -= app_bundle
+QT -= gui
+QT += network testlib
+HEADERS += ../../src/recurrence.h
+SOURCES += ../../src/recurrence.cpp \
+	testrecurrence.cpp
@@ -0,0 +1,196 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by Hanna Knutsson                                  *
+ *   hanna.knutsson@protonmail.com                                         *
+ *                                                                         *
+ *   This file is part of Eqonomize!.                                      *
+ *                                                                         *
+ *   Eqonomize! is free software: you can redistribute it and/or modify    *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   Eqonomize! is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with Eqonomize!. If not, see <http://www.gnu.org/licenses/>.    *
+ ***************************************************************************/
+
+#include <QtTest>
+
+#include "recurrence.h"
+
+#include <algorithm>
+
+//first dates of the tested recurrences: before a leap day, at the end of a year with 53 weeks, and at the end of a month
+static const int start_dates[][3] = {{2019, 12, 30}, {2020, 2, 28}, {2020, 12, 27}, {2023, 1, 31}};
+#define START_DATES_COUNT 4
+//days after the start date of the first and last date of the counted range
+static const int range_starts[] = {-400, -3, -1, 0, 1, 2, 6, 13, 27, 29, 30, 31, 58, 59, 60, 89, 181, 364, 365, 366, 730, 1461};
+#define RANGE_STARTS_COUNT 22
+static const int range_lengths[] = {-1, 0, 1, 6, 27, 28, 29, 30, 31, 59, 89, 364, 365, 366, 1095, 3000};
+#define RANGE_LENGTHS_COUNT 16
+#define REFERENCE_DAYS 5000
+
+class TestRecurrence : public QObject {
+
+	Q_OBJECT
+
+	private:
+
+		bool compareCounts(const Recurrence *rec, QString &error);
+		bool checkCounts(const Recurrence *base, QString &error);
+
+	private slots:
+
+		void dailyCounts();
+		void weeklyCounts();
+		void monthlyCounts();
+		void yearlyCounts();
+
+};
+
+//countOccurrences() is compared with the occurrences found by stepping through the recurrence from the start date, as it was counted before
+bool TestRecurrence::compareCounts(const Recurrence *rec, QString &error) {
+	QVector<QDate> dates;
+	Recurrence *stepped = rec->copy();
+	stepped->setEndDate(QDate());
+	QDate last_date = rec->startDate().addDays(REFERENCE_DAYS);
+	if(!rec->endDate().isNull() && rec->endDate() < last_date) last_date = rec->endDate();
+	for(QDate date = stepped->startDate(); !date.isNull() && date <= last_date; date = stepped->nextOccurrence(date)) {
+		dates << date;
+	}
+	delete stepped;
+	for(int i = 0; i < RANGE_STARTS_COUNT; i++) {
+		QDate date1 = rec->startDate().addDays(range_starts[i]);
+		for(int i2 = 0; i2 < RANGE_LENGTHS_COUNT; i2++) {
+			QDate date2 = date1.addDays(range_lengths[i2]);
+			if(date2 > rec->startDate().addDays(REFERENCE_DAYS)) continue;
+			int n = 0;
+			if(date2 < rec->startDate() || (!rec->endDate().isNull() && date1 > rec->endDate())) n = 0;
+			else if(rec->fixedOccurrenceCount() > 0 && date1 <= rec->startDate() && date2 <= rec->endDate()) n = rec->fixedOccurrenceCount();
+			else n = std::upper_bound(dates.constBegin(), dates.constEnd(), date2) - std::lower_bound(dates.constBegin(), dates.constEnd(), date1);
+			int n_count = rec->countOccurrences(date1, date2);
+			if(n_count != n) {
+				error = QString("start %1, end %2, %3 exceptions: %4 occurrences from %5 to %6 (expected %7)").arg(rec->startDate().toString(Qt::ISODate)).arg(rec->endDate().toString(Qt::ISODate)).arg(rec->exceptions.count()).arg(n_count).arg(date1.toString(Qt::ISODate)).arg(date2.toString(Qt::ISODate)).arg(n);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+//checks the recurrence with and without exceptions, end date and fixed number of occurrences
+bool TestRecurrence::checkCounts(const Recurrence *base, QString &error) {
+	for(int end_type = 0; end_type < 3; end_type++) {
+		for(int exception_type = 0; exception_type < 2; exception_type++) {
+			Recurrence *rec = base->copy();
+			if(exception_type == 1) {
+				//every third of the first occurrences, including the first, and a date that might not be an occurrence
+				QDate date = rec->startDate();
+				for(int i = 0; i < 30 && !date.isNull(); i++) {
+					QDate next_date = rec->nextOccurrence(date);
+					if(i % 3 == 0) rec->addException(date);
+					date = next_date;
+				}
+				if(!rec->startDate().isNull()) rec->addException(rec->startDate().addDays(45));
+			}
+			if(!rec->startDate().isNull()) {
+				if(end_type == 1) rec->setEndDate(rec->startDate().addDays(500));
+				else if(end_type == 2) rec->setFixedOccurrenceCount(25);
+			}
+			bool b = rec->startDate().isNull() || compareCounts(rec, error);
+			delete rec;
+			if(!b) return false;
+		}
+	}
+	return true;
+}
+
+void TestRecurrence::dailyCounts() {
+	for(int i_date = 0; i_date < START_DATES_COUNT; i_date++) {
+		QDate startdate(start_dates[i_date][0], start_dates[i_date][1], start_dates[i_date][2]);
+		for(int frequency = 1; frequency <= 10; frequency++) {
+			DailyRecurrence rec((Budget*) NULL);
+			rec.set(startdate, QDate(), frequency);
+			QString error;
+			QVERIFY2(checkCounts(&rec, error), qPrintable(QString("daily, frequency %1: %2").arg(frequency).arg(error)));
+		}
+	}
+}
+void TestRecurrence::weeklyCounts() {
+	for(int i_date = 0; i_date < START_DATES_COUNT; i_date++) {
+		QDate startdate(start_dates[i_date][0], start_dates[i_date][1], start_dates[i_date][2]);
+		for(int frequency = 1; frequency <= 3; frequency++) {
+			for(int days = 1; days < 128; days++) {
+				WeeklyRecurrence rec((Budget*) NULL);
+				rec.set(startdate, QDate(), days & 1, days & 2, days & 4, days & 8, days & 16, days & 32, days & 64, frequency);
+				QString error;
+				QVERIFY2(checkCounts(&rec, error), qPrintable(QString("weekly, frequency %1, days %2: %3").arg(frequency).arg(days).arg(error)));
+			}
+		}
+	}
+}
+void TestRecurrence::monthlyCounts() {
+	static const int frequencies[] = {1, 2, 5};
+	for(int i_date = 0; i_date < START_DATES_COUNT; i_date++) {
+		QDate startdate(start_dates[i_date][0], start_dates[i_date][1], start_dates[i_date][2]);
+		for(int i_freq = 0; i_freq < 3; i_freq++) {
+			int frequency = frequencies[i_freq];
+			for(int day = -30; day <= 31; day++) {
+				for(int weekendhandling = WEEKEND_HANDLING_NONE; weekendhandling <= WEEKEND_HANDLING_NEAREST; weekendhandling++) {
+					MonthlyRecurrence rec((Budget*) NULL);
+					rec.setOnDay(startdate, QDate(), day, (WeekendHandling) weekendhandling, frequency);
+					QString error;
+					QVERIFY2(checkCounts(&rec, error), qPrintable(QString("monthly, frequency %1, day %2, weekend handling %3: %4").arg(frequency).arg(day).arg(weekendhandling).arg(error)));
+				}
+			}
+			for(int week = -4; week <= 5; week++) {
+				if(week == 0) continue;
+				for(int dayofweek = 1; dayofweek <= 7; dayofweek++) {
+					MonthlyRecurrence rec((Budget*) NULL);
+					rec.setOnDayOfWeek(startdate, QDate(), dayofweek, week, frequency);
+					QString error;
+					QVERIFY2(checkCounts(&rec, error), qPrintable(QString("monthly, frequency %1, week %2, day of week %3: %4").arg(frequency).arg(week).arg(dayofweek).arg(error)));
+				}
+			}
+		}
+	}
+}
+void TestRecurrence::yearlyCounts() {
+	for(int i_date = 0; i_date < START_DATES_COUNT; i_date++) {
+		QDate startdate(start_dates[i_date][0], start_dates[i_date][1], start_dates[i_date][2]);
+		for(int frequency = 1; frequency <= 3; frequency += 2) {
+			for(int month = 1; month <= 12; month++) {
+				QDate monthdate(2000, month, 1);
+				for(int day = 1; day <= monthdate.daysInMonth(); day++) {
+					YearlyRecurrence rec((Budget*) NULL);
+					rec.setOnDayOfMonth(startdate, QDate(), month, day, WEEKEND_HANDLING_NONE, frequency);
+					QString error;
+					QVERIFY2(checkCounts(&rec, error), qPrintable(QString("yearly, frequency %1, month %2, day %3: %4").arg(frequency).arg(month).arg(day).arg(error)));
+				}
+				for(int week = -4; week <= 5; week++) {
+					//a fifth week in February only exists in some leap years
+					if(week == 0 || (month == 2 && (week == 5 || week == -4))) continue;
+					for(int dayofweek = 1; dayofweek <= 7; dayofweek++) {
+						YearlyRecurrence rec((Budget*) NULL);
+						rec.setOnDayOfWeek(startdate, QDate(), month, dayofweek, week, frequency);
+						QString error;
+						QVERIFY2(checkCounts(&rec, error), qPrintable(QString("yearly, frequency %1, month %2, week %3, day of week %4: %5").arg(frequency).arg(month).arg(week).arg(dayofweek).arg(error)));
+					}
+				}
+			}
+			for(int day = 1; day <= 366; day++) {
+				YearlyRecurrence rec((Budget*) NULL);
+				rec.setOnDayOfYear(startdate, QDate(), day, WEEKEND_HANDLING_NONE, frequency);
+				QString error;
+				QVERIFY2(checkCounts(&rec, error), qPrintable(QString("yearly, frequency %1, day of year %2: %3").arg(frequency).arg(day).arg(error)));
+			}
+		}
+	}
+}
+
+QTEST_APPLESS_MAIN(TestRecurrence)
+
+#include "testrecurrence.moc"